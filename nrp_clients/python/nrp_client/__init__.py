@@ -17,6 +17,8 @@ from google.protobuf import descriptor_pool
 try:
     from nrp_protobuf.nrp_server_pb2 import ResetMessage, EmptyMessage, RunLoopMessage, JsonMessage
     from nrp_protobuf.nrp_server_pb2_grpc import NrpCoreStub
+    from nrp_protobuf.nrp_server_trajectory_pb2 import TrajectoryStreamRequest
+    from nrp_protobuf.nrp_server_trajectory_pb2_grpc import NrpCoreTrajectoryServiceStub
 except ImportError as e:
     raise ImportError(
         'NRP-Core protobuf Python bindings for client-server communication could not be found.') from e
@@ -105,6 +107,7 @@ class NrpCore:
         # Connect to server
         self._channel = grpc.insecure_channel(address)
         self._stub = NrpCoreStub(self._channel)
+        self._trajectory_stub = NrpCoreTrajectoryServiceStub(self._channel)
 
         # Wait for the server to start
         n = self._wait_until_server_ready(self._channel, self._launcher.is_alive_nrp_process)
@@ -250,7 +253,7 @@ class NrpCore:
         self._proto_datapack_out_buffer = []
 
 
-    def _read_trajectory(self, response) -> list:
+    def _read_trajectory(self, response, first_index=0) -> list:
         trajectory_data = []
         total_messages = len(response.jsonTrajectoryMessages) + len(response.protoTrajectoryMessages)
         json_message_index = 0
@@ -260,7 +263,7 @@ class NrpCore:
 
         for i in range(total_messages):
             if json_message_index < len(response.jsonTrajectoryMessages) and \
-               response.jsonTrajectoryMessages[json_message_index].dataIndex == i:
+               response.jsonTrajectoryMessages[json_message_index].dataIndex == first_index + i:
 
                 # Unpack the content of Any field into a proper protobuf message
                 proto_message = JsonMessage()
@@ -288,6 +291,33 @@ class NrpCore:
         return trajectory_data
 
 
+    def get_trajectory(self, chunk_size=0) -> list:
+        """
+        Calls the getTrajectory() streaming RPC of the NRP Core Server
+
+        To be used when "TrajectoryStreaming" is enabled in the simulation configuration. In this case, the
+        trajectory isn't included in the responses of the other RPCs, and it is returned by this method instead.
+        The trajectory of the last finished episode is returned, and removed from the server.
+
+        param int chunk_size: Maximum number of trajectory elements streamed in each chunk. When 0, the server default is used.
+        """
+        if not self._is_open:
+            raise ChildProcessError("This NRP Server is closed. Please delete this object and create a new one")
+
+        trajectory_data = []
+
+        try:
+            for chunk in self._trajectory_stub.getTrajectory(TrajectoryStreamRequest(chunkSize=chunk_size)):
+                trajectory_data.extend(self._read_trajectory(chunk, len(trajectory_data)))
+        except grpc.RpcError as rpc_error:
+            if rpc_error.code() == grpc.StatusCode.UNAVAILABLE:
+                raise ConnectionError(f"NRP Server is unavailable") from rpc_error
+            else:
+                raise
+
+        return trajectory_data
+
+
     def run_loop(self, num_iterations, run_async=False, response=None):
         """
         Calls the runLoop() RPC of the NRP Core Server
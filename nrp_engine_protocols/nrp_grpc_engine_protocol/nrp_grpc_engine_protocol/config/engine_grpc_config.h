@@ -22,6 +22,7 @@
 #ifndef ENGINE_GRPC_CONFIG_H
 #define ENGINE_GRPC_CONFIG_H
 
+#include <cstdint>
 #include <string_view>
 
 struct EngineGRPCConfigConst
@@ -55,6 +56,31 @@ struct EngineGRPCConfigConst
          * \brief JSON name under which the runLoopStep engine time is sent
          */
         static constexpr std::string_view EngineTimeName = "time";
+
+        /*!
+         * \brief Call metadata key under which clients request the compression codec of large datapacks
+         */
+        static constexpr std::string_view DataPackCompressionKey = "nrp-datapack-compression";
+
+        /*!
+         * \brief Call metadata key under which clients pass the minimum size of compressed datapacks
+         */
+        static constexpr std::string_view DataPackCompressionThresholdKey = "nrp-datapack-compression-threshold";
+};
+
+/*!
+ * \brief Ids of the calls of the EngineGrpcService and of its optional services made through the shared memory transport
+ */
+enum class EngineShmMethod : uint32_t
+{
+    Initialize,
+    Reset,
+    Shutdown,
+    RunLoopStep,
+    SetDataPacks,
+    GetDataPacks,
+    RunLoopStepAndExchange,
+    GetDataPacksSegmented
 };
 
 
@@ -23,21 +23,30 @@
 #define ENGINE_GRPC_CLIENT_H
 
 #include <future>
+#include <map>
 
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/support/time.h>
 #include <nlohmann/json.hpp>
 
 #include "nrp_grpc_engine_protocol/config/engine_grpc_config.h"
+#include "nrp_grpc_engine_protocol/engine_client/grpc_completion_queue_driver.h"
+#include "nrp_grpc_engine_protocol/shm_transport/shm_channel.h"
 #include "nrp_general_library/config/cmake_constants.h"
 #include "nrp_general_library/engine_interfaces/engine_client_interface.h"
 #include "nrp_general_library/utils/json_schema_utils.h"
 #include "nrp_protobuf/engine_grpc.grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_fused.grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_segments.grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_subscription.grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_unchanged.pb.h"
 #include "nrp_protobuf/config/cmake_constants.h"
 #include "nrp_general_library/datapack_interface/datapack.h"
 #include "nrp_general_library/utils/utils.h"
 #include <pistache/router.h>
 
+#include "nrp_protobuf/proto_ops/arena_pool.h"
+#include "nrp_protobuf/proto_ops/datapack_compression.h"
 #include "nrp_protobuf/proto_ops/protobuf_ops.h"
 #include "nrp_protobuf/proto_ops/proto_ops_manager.h"
 
@@ -58,6 +67,22 @@ class EngineGrpcClient
         {
             context->set_deadline(std::chrono::system_clock::now() + this->_rpcTimeout);
         }
+
+        addCompressionMetadata(context);
+    }
+
+    /*!
+     * \brief Requests the server to compress large datapacks, if DataPackCompression is enabled
+     */
+    void addCompressionMetadata(grpc::ClientContext * context)
+    {
+        if(this->_dataPackCompression == EngineGrpc::COMPRESSION_NONE)
+            return;
+
+        context->AddMetadata(EngineGRPCConfigConst::DataPackCompressionKey.data(),
+                             protobuf_ops::compressionCodecName(this->_dataPackCompression));
+        context->AddMetadata(EngineGRPCConfigConst::DataPackCompressionThresholdKey.data(),
+                             std::to_string(this->_dataPackCompressionThreshold));
     }
 
     public:
@@ -90,6 +115,38 @@ class EngineGrpcClient
             _channel = grpc::CreateChannel(_serverAddress, grpc::InsecureChannelCredentials());
             _stub    = EngineGrpc::EngineGrpcService::NewStub(_channel);
 
+            this->_useFusedStep = this->engineConfig().at("FusedStepExchange").template get<bool>();
+            if(this->_useFusedStep)
+                _fusedStub = EngineGrpc::EngineGrpcFusedService::NewStub(_channel);
+
+            this->_useSegmentedDataPacks = this->engineConfig().at("SegmentedDataPacks").template get<bool>();
+            if(this->_useSegmentedDataPacks)
+                _segmentedStub = EngineGrpc::EngineGrpcSegmentedService::NewStub(_channel);
+
+            this->_useDataPackSubscription = this->engineConfig().at("DataPackSubscription").template get<bool>();
+            if(this->_useDataPackSubscription)
+                _subscriptionStub = EngineGrpc::EngineGrpcSubscriptionService::NewStub(_channel);
+
+            this->_dataPackCompression          = protobuf_ops::compressionCodecFromName(this->engineConfig().at("DataPackCompression"));
+            this->_dataPackCompressionThreshold = this->engineConfig().at("DataPackCompressionThreshold").template get<size_t>();
+
+            // With the shared memory transport, calls to the engine server go through a channel created before the
+            // engine process is launched. The server attaches to it when it finds a segment matching its address
+            if(this->engineConfig().at("EngineTransport") == "shm")
+            {
+                this->_shmChannel = ShmChannel::create(ShmChannel::segmentName(this->_serverAddress),
+                                                       this->engineConfig().at("SharedMemoryCapacity").template get<size_t>());
+
+                if(this->_useDataPackSubscription)
+                {
+                    NRPLogger::info("Engine \"{}\" uses the shared memory transport, datapack subscriptions are disabled", this->engineName());
+                    this->_useDataPackSubscription = false;
+                }
+            }
+            // In async mode, calls are completed by the driver thread shared by all gRPC engine clients
+            else if(this->engineConfig().at("GrpcClientMode") == "async")
+                this->_cqDriver = GrpcCompletionQueueDriver::getInstance();
+
             ProtoOpsManager::getInstance().addPluginPath(this->engineConfig().at("ProtobufPluginsPath"));
             for(const auto& packageName : this->engineConfig().at("ProtobufPackages")) {
                 auto packageNameStr = packageName.template get<std::string>();
@@ -108,23 +165,43 @@ class EngineGrpcClient
                 _protoOpsStr.pop_back();
         }
 
-        virtual pid_t launchEngine() override
+        ~EngineGrpcClient() override
         {
-            NRP_LOGGER_TRACE("{} called", __FUNCTION__);
+            this->cancelSubscription();
 
-            // Launch engine process.
-            // enginePID == -1 means that the launcher hasn't launched a process
-            auto enginePID = this->EngineClientInterface::launchEngine();
+            // Pending steps notify their completion to this client, wait for them before destroying it
+            if(this->_pendingStep)
+            {
+                this->_pendingStep->context.TryCancel();
+                this->_pendingStep->wait();
+            }
 
-            this->connectToServer();
+            if(this->_pendingFusedStep)
+            {
+                this->_pendingFusedStep->context.TryCancel();
+                this->_pendingFusedStep->wait();
+            }
+        }
 
-            return enginePID;
+        virtual void connectToEngine() override
+        {
+            NRP_LOGGER_TRACE("{} called", __FUNCTION__);
+
+            this->connectToServer();
         }
 
         void connectToServer()
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
+            if(this->_shmChannel)
+            {
+                if(!this->_shmChannel->waitForServer(std::chrono::seconds(20)))
+                    throw NRPException::logCreate("Timeout while connecting to engine server (" + this->engineName() + ") through shared memory");
+
+                return;
+            }
+
             if(!_channel->WaitForConnected(gpr_time_add(
                 gpr_now(GPR_CLOCK_REALTIME), gpr_time_from_seconds(20, GPR_TIMESPAN))))
             {
@@ -144,8 +221,12 @@ class EngineGrpcClient
 
             request.set_json(data.dump());
 
+            this->sendPendingDataPacks();
+
             NRPLogger::debug("Sending init command to server [ {} ]", this->engineName());
-            grpc::Status status = _stub->initialize(&context, request, &reply);
+            grpc::Status status = this->unaryCall(EngineShmMethod::Initialize, request, &reply, [&] () {
+                return _stub->initialize(&context, request, &reply);
+            });
 
             if(!status.ok())
             {
@@ -163,8 +244,17 @@ class EngineGrpcClient
 
             prepareRpcContext(&context);
 
+            // DataPacks buffered for the fused step are set before the reset. Prefetched ones are stale after it, as
+            // well as received and subscribed ones
+            this->sendPendingDataPacks();
+            this->_hasPrefetchedDataPacks = false;
+            this->_receivedDataPacks.clear();
+            this->cancelSubscription();
+
             NRPLogger::debug("Sending reset command to server [ {} ]", this->engineName());
-            grpc::Status status = _stub->reset(&context, request, &reply);
+            grpc::Status status = this->unaryCall(EngineShmMethod::Reset, request, &reply, [&] () {
+                return _stub->reset(&context, request, &reply);
+            });
 
             if(!status.ok())
             {
@@ -187,8 +277,12 @@ class EngineGrpcClient
 
             request.set_json(data.dump());
 
+            this->sendPendingDataPacks();
+
             NRPLogger::debug("Sending shutdown command to server [ {} ]", this->engineName());
-            grpc::Status status = _stub->shutdown(&context, request, &reply);
+            grpc::Status status = this->unaryCall(EngineShmMethod::Shutdown, request, &reply, [&] () {
+                return _stub->shutdown(&context, request, &reply);
+            });
 
             if(!status.ok())
             {
@@ -201,6 +295,13 @@ class EngineGrpcClient
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
+            if(this->_useFusedStep)
+            {
+                SimulationTime engineTime;
+                if(this->runLoopStepAndExchange(timeStep, engineTime))
+                    return engineTime;
+            }
+
             EngineGrpc::RunLoopStepRequest request;
             EngineGrpc::RunLoopStepReply   reply;
             grpc::ClientContext            context;
@@ -209,58 +310,142 @@ class EngineGrpcClient
 
             request.set_timestep(timeStep.count());
 
-            grpc::Status status = _stub->runLoopStep(&context, request, &reply);
+            grpc::Status status = this->unaryCall(EngineShmMethod::RunLoopStep, request, &reply, [&] () {
+                return _stub->runLoopStep(&context, request, &reply);
+            });
 
-            if(!status.ok())
+            return this->processRunLoopStepReply(status, reply);
+        }
+
+        /*!
+         * \brief Starts a single loop step
+         *
+         * In async mode, the step request is started in the completion queue of the shared driver and no thread is
+         * blocked while the step is running. Otherwise, EngineClient::runLoopStepAsync() is used.
+         *
+         * \param[in] timeStep Requested duration of the simulation loop step.
+         */
+        void runLoopStepAsync(SimulationTime timeStep) override
+        {
+            if(!this->_cqDriver)
             {
-               const auto errMsg = "Engine server runLoopStep failed: " + status.error_message() + " (" + std::to_string(status.error_code()) + ")";
-               throw std::runtime_error(errMsg);
+                EngineClient<ENGINE, SCHEMA>::runLoopStepAsync(timeStep);
+                return;
             }
 
-            const SimulationTime engineTime(reply.enginetime());
+            if(this->_pendingStep || this->_pendingFusedStep)
+            {
+                throw NRPException::logCreate("Engine \"" + this->engineName() + "\" runLoopStepAsync has overrun");
+            }
 
-            if(engineTime < SimulationTime::zero())
+            auto *completionQueue = this->_cqDriver->completionQueue();
+            auto notifyCompletion = [this] () { this->notifyStepCompletion(); };
+
+            this->_pendingTimeStep = timeStep;
+
+            if(this->_useFusedStep)
             {
-               const auto errMsg = "Invalid engine time (should be greater than 0): " + std::to_string(engineTime.count());
-               throw std::runtime_error(errMsg);
+                this->prepareFusedStepRequest(timeStep, &this->_fusedStepRequest);
+
+                this->_pendingFusedStep = std::make_shared<GrpcAsyncCall<EngineGrpc::RunLoopStepAndExchangeReply>>();
+                prepareRpcContext(&this->_pendingFusedStep->context);
+                this->_pendingFusedStep->start([this, completionQueue] (grpc::ClientContext * context) {
+                    return this->_fusedStub->PrepareAsyncrunLoopStepAndExchange(context, this->_fusedStepRequest, completionQueue);
+                }, notifyCompletion);
+            }
+            else
+            {
+                EngineGrpc::RunLoopStepRequest request;
+                request.set_timestep(timeStep.count());
+
+                this->_pendingStep = std::make_shared<GrpcAsyncCall<EngineGrpc::RunLoopStepReply>>();
+                prepareRpcContext(&this->_pendingStep->context);
+                this->_pendingStep->start([this, &request, completionQueue] (grpc::ClientContext * context) {
+                    return this->_stub->PrepareAsyncrunLoopStep(context, request, completionQueue);
+                }, notifyCompletion);
             }
+        }
 
-            if(engineTime < this->_prevEngineTime)
+        /*!
+         * \brief Waits and gets the results of the loop step started by EngineGrpcClient::runLoopStepAsync()
+         *
+         * \param timeOut Timeout of the loop step. If it's less or equal to 0, the function will wait indefinitely.
+         * \throw NRPException On timeout
+         */
+        void runLoopStepAsyncGet(SimulationTime timeOut) override
+        {
+            NRP_LOGGER_TRACE("{} called", __FUNCTION__);
+
+            if(!this->_cqDriver)
             {
-                const auto errMsg = "Invalid engine time (should be greater than previous time): "
-                                  + std::to_string(engineTime.count())
-                                  + ", previous: "
-                                  + std::to_string(this->_prevEngineTime.count());
+                EngineClient<ENGINE, SCHEMA>::runLoopStepAsyncGet(timeOut);
+                return;
+            }
 
-                throw std::runtime_error(errMsg);
+            if(this->_pendingFusedStep)
+            {
+                if(!this->_pendingFusedStep->wait(timeOut))
+                    throw NRPException::logCreate("Engine \"" + this->engineName() + "\" loop is taking too long to complete");
+
+                const auto call = std::move(this->_pendingFusedStep);
+
+                SimulationTime engineTime;
+                if(!this->processFusedStepReply(call->status, this->_fusedStepRequest, call->reply, engineTime))
+                    engineTime = this->runLoopStepCallback(this->_pendingTimeStep);
+
+                this->setEngineTime(engineTime);
             }
+            else if(this->_pendingStep)
+            {
+                if(!this->_pendingStep->wait(timeOut))
+                    throw NRPException::logCreate("Engine \"" + this->engineName() + "\" loop is taking too long to complete");
 
-            this->_prevEngineTime = engineTime;
+                const auto call = std::move(this->_pendingStep);
 
-            return engineTime;
+                this->setEngineTime(this->processRunLoopStepReply(call->status, call->reply));
+            }
         }
 
     virtual datapacks_vector_t getDataPacksFromEngine(const datapack_identifiers_set_t &requestedDataPackIds) override
     {
         NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
+        if(this->_useFusedStep)
+        {
+            // DataPacks fetched together with the last step can be used if the same ids are requested
+            if(this->_hasPrefetchedDataPacks && this->_prefetchedDataPackIds == requestedDataPackIds)
+            {
+                this->_hasPrefetchedDataPacks = false;
+                return this->dataPacksFromReply(this->_prefetchedDataPacks);
+            }
+
+            // Otherwise, fetch them with a separate call and request the same ids with the next step
+            this->discardPrefetchedDataPacks();
+            this->_prefetchedDataPackIds  = requestedDataPackIds;
+
+            this->sendPendingDataPacks();
+        }
+
         EngineGrpc::GetDataPacksRequest request;
         EngineGrpc::GetDataPacksReply   reply;
         grpc::ClientContext             context;
 
-        for(const auto & requestedId: requestedDataPackIds)
-        {
-            if(this->engineName().compare(requestedId.EngineName) == 0)
-            {
-                auto dataPackId = request.add_datapackids();
+        datapacks_vector_t dataPacks;
+        if(this->_useDataPackSubscription && !this->_useFusedStep && this->getSubscribedDataPacks(requestedDataPackIds, dataPacks))
+            return dataPacks;
 
-                dataPackId->set_datapackname(requestedId.Name);
-                dataPackId->set_datapacktype(requestedId.Type);
-                dataPackId->set_enginename(requestedId.EngineName);
-            }
-        }
+        this->fillGetDataPacksRequest(requestedDataPackIds, &request);
+
+        if(this->_useSegmentedDataPacks && this->getSegmentedDataPacks(request, dataPacks))
+            return dataPacks;
 
-        grpc::Status status = _stub->getDataPacks(&context, request, &reply);
+        grpc::Status status = this->_cqDriver ?
+            this->asyncCall([this, &request] (grpc::ClientContext * asyncContext) {
+                return this->_stub->PrepareAsyncgetDataPacks(asyncContext, request, this->_cqDriver->completionQueue());
+            }, &reply) :
+            this->unaryCall(EngineShmMethod::GetDataPacks, request, &reply, [&] () {
+                return _stub->getDataPacks(&context, request, &reply);
+            });
 
         if(!status.ok())
         {
@@ -268,75 +453,24 @@ class EngineGrpcClient
             throw std::runtime_error(errMsg);
         }
 
-        datapacks_vector_t interfaces;
-        for(int i = 0; i < reply.datapacks_size(); i++) {
-            auto datapackData = reply.datapacks(i);
-            DataPackInterfaceConstSharedPtr datapack;
-
-            for(auto& mod : _protoOps) {
-                datapack = mod->getDataPackInterfaceFromMessage(this->engineName(), datapackData);
-
-                if(datapack != nullptr)
-                    break;
-            }
-
-            if(datapack)
-                interfaces.push_back(datapack);
-            else
-                throw NRPException::logCreate("In Engine \"" + this->engineName() + "\", unable to deserialize datapack \"" +
-                                                      datapackData.datapackid().datapackname() + "\" using any of the NRP-Core Protobuf plugins specified in the"
-                                                      " engine configuration: [" + _protoOpsStr + "]. Ensure that the parameter "
-                                                      "\"ProtobufPackages\" is properly set in the Engine configuration");
-        }
-
-        return interfaces;
+        return this->dataPacksFromReply(reply);
     }
 
         virtual void sendDataPacksToEngine(const datapacks_set_t &dataPacks) override
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
-            EngineGrpc::SetDataPacksRequest request;
-            EngineGrpc::SetDataPacksReply   reply;
-            grpc::ClientContext             context;
-
-            prepareRpcContext(&context);
-
-            for(const auto &datapack : dataPacks)
+            // With the fused step, datapacks are sent to the engine together with the next step request
+            if(this->_useFusedStep)
             {
-                assert(datapack->engineName() == this->engineName());
-
-                if(datapack->isEmpty())
-                    throw NRPException::logCreate("Attempt to send empty datapack " + datapack->name() + " to Engine " + this->engineName());
-                else {
-                    auto protoDataPack = request.add_datapacks();
-
-                    bool isSet = false;
-                    for(auto& mod : _protoOps) {
-                        try {
-                            mod->setDataPackMessageFromInterface(*datapack, protoDataPack);
-                            isSet = true;
-                        }
-                        catch (NRPException &) {
-                            // this just means that the module couldn't process the request, try with the next one
-                        }
-                    }
-
-                    if(!isSet)
-                        throw NRPException::logCreate("In Engine \"" + this->engineName() + "\", unable to serialize datapack \"" +
-                                                      datapack->name() + "\" using any of the NRP-Core Protobuf plugins specified in the"
-                                                      " engine configuration: [" + _protoOpsStr + "]. Ensure that the parameter "
-                                                      "\"ProtobufPackages\" is properly set in the Engine configuration");
-                }
+                this->fillSetDataPacksRequest(dataPacks, &this->_pendingSetRequest);
+                return;
             }
 
-            grpc::Status status = _stub->setDataPacks(&context, request, &reply);
+            EngineGrpc::SetDataPacksRequest request;
 
-            if(!status.ok())
-            {
-                const auto errMsg = "In Engine \"" + this->engineName() + "\", sendDataPacksToEngine failed: " + status.error_message() + " (" + std::to_string(status.error_code()) + ")";
-                throw std::runtime_error(errMsg);
-            }
+            this->fillSetDataPacksRequest(dataPacks, &request);
+            this->sendSetDataPacksRequest(request);
         }
 
         virtual const std::vector<std::string> engineProcStartParams() const override
@@ -419,15 +553,654 @@ class EngineGrpcClient
 
     private:
 
+        /*!
+         * \brief Sends buffered datapacks, runs a loop step and prefetches datapacks in a single call
+         *
+         * \param[in]  timeStep   Time step by which the simulation should be advanced
+         * \param[out] engineTime Engine time after running the step
+         *
+         * \return False if the server doesn't implement the fused call. In that case buffered datapacks are sent
+         *         with a separate call, the fused call is disabled and the step must be run with runLoopStep
+         */
+        bool runLoopStepAndExchange(const SimulationTime timeStep, SimulationTime &engineTime)
+        {
+            EngineGrpc::RunLoopStepAndExchangeRequest request;
+            EngineGrpc::RunLoopStepAndExchangeReply   reply;
+            grpc::ClientContext                       context;
+
+            prepareRpcContext(&context);
+
+            this->prepareFusedStepRequest(timeStep, &request);
+
+            grpc::Status status = this->unaryCall(EngineShmMethod::RunLoopStepAndExchange, request, &reply, [&] () {
+                return _fusedStub->runLoopStepAndExchange(&context, request, &reply);
+            });
+
+            return this->processFusedStepReply(status, request, reply, engineTime);
+        }
+
+        /*!
+         * \brief Fetches datapacks from the engine server using the segmented datapack service
+         *
+         * \param[in]  request   Ids of the requested datapacks
+         * \param[out] dataPacks Datapacks received from the engine
+         *
+         * \return False if the server doesn't implement the segmented datapack service. In that case it is disabled and
+         *         datapacks must be fetched with a regular getDataPacks call
+         */
+        bool getSegmentedDataPacks(const EngineGrpc::GetDataPacksRequest & request, datapacks_vector_t & dataPacks)
+        {
+            EngineGrpc::SegmentedGetDataPacksReply reply;
+            grpc::ClientContext                    context;
+
+            grpc::Status status = this->_cqDriver ?
+                this->asyncCall([this, &request] (grpc::ClientContext * asyncContext) {
+                    return this->_segmentedStub->PrepareAsyncgetDataPacks(asyncContext, request, this->_cqDriver->completionQueue());
+                }, &reply) :
+                this->unaryCall(EngineShmMethod::GetDataPacksSegmented, request, &reply, [&] () {
+                    return _segmentedStub->getDataPacks(&context, request, &reply);
+                });
+
+            if(status.error_code() == grpc::StatusCode::UNIMPLEMENTED)
+            {
+                NRPLogger::info("Engine server \"{}\" doesn't support segmented datapacks. Using regular datapack messages instead", this->engineName());
+
+                this->_useSegmentedDataPacks = false;
+                return false;
+            }
+
+            if(!status.ok())
+            {
+                const auto errMsg = "In Engine \"" + this->engineName() + "\", getDataPacksFromEngine failed: " + status.error_message() + " (" + std::to_string(status.error_code()) + ")";
+                throw std::runtime_error(errMsg);
+            }
+
+            dataPacks = this->dataPacksFromSegmentedReply(reply);
+            return true;
+        }
+
+        /*!
+         * \brief Gets datapacks from the updates pushed by the engine server with the datapack subscription service
+         *
+         * The client subscribes to the requested datapacks if they aren't the subscribed ones. Updates are read until
+         * the one sent after the last loop step, datapacks from later updates replacing those from earlier ones.
+         * Requested datapacks without new data are returned empty.
+         *
+         * \param[in]  requestedDataPackIds Ids of the requested datapacks
+         * \param[out] dataPacks            Datapacks received from the engine
+         *
+         * \return False if the server doesn't implement the subscription service. In that case it is disabled and
+         *         datapacks must be fetched with a regular getDataPacks call
+         */
+        bool getSubscribedDataPacks(const datapack_identifiers_set_t & requestedDataPackIds, datapacks_vector_t & dataPacks)
+        {
+            std::map<std::string, DataPackInterfaceConstSharedPtr> updatedDataPacks;
+
+            if(!this->_subscriptionReader || this->_subscribedDataPackIds != requestedDataPackIds)
+            {
+                // Updates not read yet may contain data for which "unchanged" markers are sent afterwards
+                if(this->_subscriptionReader && !this->readDataPackUpdates(updatedDataPacks))
+                    return false;
+
+                updatedDataPacks.clear();
+                this->cancelSubscription();
+
+                EngineGrpc::GetDataPacksRequest request;
+                this->fillGetDataPacksRequest(requestedDataPackIds, &request);
+
+                // No deadline is set, the call lasts as long as the subscription
+                this->_subscriptionContext = std::make_unique<grpc::ClientContext>();
+                this->addCompressionMetadata(this->_subscriptionContext.get());
+                this->_subscriptionReader  = this->_subscriptionStub->subscribeDataPacks(this->_subscriptionContext.get(), request);
+
+                this->_subscribedDataPackIds    = requestedDataPackIds;
+                this->_subscriptionStep         = 0;
+                this->_receivedSubscriptionStep = -1;
+            }
+
+            if(!this->readDataPackUpdates(updatedDataPacks))
+                return false;
+
+            dataPacks.clear();
+            for(const auto & requestedId : requestedDataPackIds)
+            {
+                if(this->engineName().compare(requestedId.EngineName) != 0)
+                    continue;
+
+                const auto updatedDataPack = updatedDataPacks.find(requestedId.Name);
+                if(updatedDataPack != updatedDataPacks.end())
+                    dataPacks.push_back(updatedDataPack->second);
+                else
+                    dataPacks.push_back(DataPackInterfaceConstSharedPtr(new DataPackInterface(requestedId.Name, requestedId.EngineName, requestedId.Type)));
+            }
+
+            return true;
+        }
+
+        /*!
+         * \brief Reads the updates of the datapack subscription until the one sent after the last loop step
+         *
+         * \param[in,out] updatedDataPacks Datapacks contained in the updates, by name. Later updates replace earlier ones
+         *
+         * \return False if the server doesn't implement the subscription service. See readDataPackUpdate()
+         */
+        bool readDataPackUpdates(std::map<std::string, DataPackInterfaceConstSharedPtr> & updatedDataPacks)
+        {
+            EngineGrpc::DataPackUpdate update;
+
+            while(this->_receivedSubscriptionStep < static_cast<int64_t>(this->_subscriptionStep))
+            {
+                if(!this->readDataPackUpdate(update))
+                    return false;
+
+                this->_receivedSubscriptionStep = static_cast<int64_t>(update.step());
+
+                for(auto & dataPack : this->dataPacksFromReply(update.datapacks()))
+                    updatedDataPacks[dataPack->name()] = std::move(dataPack);
+            }
+
+            return true;
+        }
+
+        /*!
+         * \brief Reads the next update from the datapack subscription
+         *
+         * \return False if the server doesn't implement the subscription service. In that case it is disabled
+         */
+        bool readDataPackUpdate(EngineGrpc::DataPackUpdate & update)
+        {
+            if(this->_subscriptionReader->Read(&update))
+                return true;
+
+            const grpc::Status status = this->_subscriptionReader->Finish();
+            this->_subscriptionReader.reset();
+            this->_subscriptionContext.reset();
+
+            if(status.error_code() == grpc::StatusCode::UNIMPLEMENTED)
+            {
+                NRPLogger::info("Engine server \"{}\" doesn't support datapack subscriptions. Using getDataPacks calls instead", this->engineName());
+
+                this->_useDataPackSubscription = false;
+                return false;
+            }
+
+            const auto errMsg = "In Engine \"" + this->engineName() + "\", datapack subscription was closed by the engine server: " + status.error_message() + " (" + std::to_string(status.error_code()) + ")";
+            throw std::runtime_error(errMsg);
+        }
+
+        /*!
+         * \brief Cancels the datapack subscription, if there is any
+         */
+        void cancelSubscription()
+        {
+            if(!this->_subscriptionReader)
+                return;
+
+            this->_subscriptionContext->TryCancel();
+            this->_subscriptionReader->Finish();
+
+            this->_subscriptionReader.reset();
+            this->_subscriptionContext.reset();
+        }
+
+        /*!
+         * \brief Fills a fused step request with the buffered datapacks, the time step and the prefetched datapack ids
+         */
+        void prepareFusedStepRequest(const SimulationTime timeStep, EngineGrpc::RunLoopStepAndExchangeRequest * request)
+        {
+            request->Clear();
+            request->mutable_setrequest()->Swap(&this->_pendingSetRequest);
+            request->set_timestep(timeStep.count());
+            this->fillGetDataPacksRequest(this->_prefetchedDataPackIds, request->mutable_getrequest());
+
+            this->discardPrefetchedDataPacks();
+        }
+
+        /*!
+         * \brief Processes the result of a fused step call
+         *
+         * \param[in]  status     Status of the call
+         * \param[in]  request    Request sent with the call
+         * \param[in]  reply      Reply received from the server. Its datapacks are moved into the prefetched datapacks
+         * \param[out] engineTime Engine time after running the step
+         *
+         * \return False if the server doesn't implement the fused call. See runLoopStepAndExchange()
+         */
+        bool processFusedStepReply(const grpc::Status &status, const EngineGrpc::RunLoopStepAndExchangeRequest &request,
+                                   EngineGrpc::RunLoopStepAndExchangeReply &reply, SimulationTime &engineTime)
+        {
+            if(status.error_code() == grpc::StatusCode::UNIMPLEMENTED)
+            {
+                NRPLogger::info("Engine server \"{}\" doesn't support fused step-and-exchange calls. Using separate calls instead", this->engineName());
+
+                this->_useFusedStep = false;
+                this->sendSetDataPacksRequest(request.setrequest());
+
+                return false;
+            }
+
+            if(!status.ok())
+            {
+               const auto errMsg = "Engine server runLoopStepAndExchange failed: " + status.error_message() + " (" + std::to_string(status.error_code()) + ")";
+               throw std::runtime_error(errMsg);
+            }
+
+            engineTime = this->validateEngineTime(SimulationTime(reply.enginetime()));
+
+            this->_prefetchedDataPacks.Swap(reply.mutable_getreply());
+            this->_hasPrefetchedDataPacks = true;
+
+            return true;
+        }
+
+        /*!
+         * \brief Processes the result of a runLoopStep call
+         * \return Engine time after running the step
+         */
+        SimulationTime processRunLoopStepReply(const grpc::Status &status, const EngineGrpc::RunLoopStepReply &reply)
+        {
+            if(!status.ok())
+            {
+               const auto errMsg = "Engine server runLoopStep failed: " + status.error_message() + " (" + std::to_string(status.error_code()) + ")";
+               throw std::runtime_error(errMsg);
+            }
+
+            ++this->_subscriptionStep;
+
+            return this->validateEngineTime(SimulationTime(reply.enginetime()));
+        }
+
+        /*!
+         * \brief Performs a unary call through the completion queue driver and waits for its completion
+         *
+         * \param[in]  prepareCall Function returning the reader of the call, e.g. a call to Stub::PrepareAsync<method>
+         * \param[out] reply       Reply received from the server
+         *
+         * \return Status of the call
+         */
+        template<class REPLY, class PREPARE_FCN>
+        grpc::Status asyncCall(PREPARE_FCN &&prepareCall, REPLY * reply)
+        {
+            auto call = std::make_shared<GrpcAsyncCall<REPLY>>();
+
+            prepareRpcContext(&call->context);
+            call->start(std::forward<PREPARE_FCN>(prepareCall));
+            call->wait();
+
+            reply->Swap(&call->reply);
+
+            return call->status;
+        }
+
+        /*!
+         * \brief Performs a unary call through the shared memory channel, or with the given gRPC call if there isn't any
+         *
+         * With the shared memory transport, the request is serialized into the request ring of the channel and the
+         * reply is read from its reply ring. The reply is preceded by the status code of the call, and contains the
+         * error message if the call failed. If the call times out, its late reply is discarded by the next call, see
+         * ShmChannel::call().
+         *
+         * \param[in]  method   Id of the call in the shared memory transport
+         * \param[in]  request  Request sent to the server
+         * \param[out] reply    Reply received from the server
+         * \param[in]  grpcCall Function performing the call with gRPC
+         *
+         * \return Status of the call
+         */
+        template<class REQUEST, class REPLY, class GRPC_CALL>
+        grpc::Status unaryCall(EngineShmMethod method, const REQUEST &request, REPLY * reply, GRPC_CALL &&grpcCall)
+        {
+            if(!this->_shmChannel)
+                return grpcCall();
+
+            uint32_t    replyCode;
+            std::string replyPayload;
+            if(!this->_shmChannel->call(static_cast<uint32_t>(method), request.SerializeAsString(), replyCode, replyPayload, this->_rpcTimeout))
+                return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline Exceeded");
+
+            if(replyCode != static_cast<uint32_t>(grpc::StatusCode::OK))
+                return grpc::Status(static_cast<grpc::StatusCode>(replyCode), replyPayload);
+
+            if(!reply->ParseFromString(replyPayload))
+                return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to parse the reply received through shared memory");
+
+            return grpc::Status::OK;
+        }
+
+        /*!
+         * \brief Checks that the engine time returned by the server is valid and stores it
+         */
+        SimulationTime validateEngineTime(const SimulationTime engineTime)
+        {
+            if(engineTime < SimulationTime::zero())
+            {
+               const auto errMsg = "Invalid engine time (should be greater than 0): " + std::to_string(engineTime.count());
+               throw std::runtime_error(errMsg);
+            }
+
+            if(engineTime < this->_prevEngineTime)
+            {
+                const auto errMsg = "Invalid engine time (should be greater than previous time): "
+                                  + std::to_string(engineTime.count())
+                                  + ", previous: "
+                                  + std::to_string(this->_prevEngineTime.count());
+
+                throw std::runtime_error(errMsg);
+            }
+
+            this->_prevEngineTime = engineTime;
+
+            return engineTime;
+        }
+
+        /*!
+         * \brief Adds the ids of the requested datapacks belonging to this engine to a GetDataPacksRequest
+         */
+        void fillGetDataPacksRequest(const datapack_identifiers_set_t &requestedDataPackIds, EngineGrpc::GetDataPacksRequest * request)
+        {
+            for(const auto & requestedId: requestedDataPackIds)
+            {
+                if(this->engineName().compare(requestedId.EngineName) == 0)
+                {
+                    auto dataPackId = request->add_datapackids();
+
+                    dataPackId->set_datapackname(requestedId.Name);
+                    dataPackId->set_datapacktype(requestedId.Type);
+                    dataPackId->set_enginename(requestedId.EngineName);
+                }
+            }
+        }
+
+        /*!
+         * \brief Deserializes the datapacks contained in a GetDataPacksReply
+         *
+         * The data of the datapacks is allocated in an arena from _arenaPool, which is released when all of them are.
+         * Datapacks compressed by the server are decompressed first
+         */
+        datapacks_vector_t dataPacksFromReply(const EngineGrpc::GetDataPacksReply & reply)
+        {
+            const auto arena = this->_arenaPool.acquire();
+
+            datapacks_vector_t interfaces;
+            for(int i = 0; i < reply.datapacks_size(); i++) {
+                EngineGrpc::DataPackMessage decompressedData;
+                const auto & datapackData = protobuf_ops::decompressDataPackMessage(reply.datapacks(i), &decompressedData) ?
+                        decompressedData : reply.datapacks(i);
+                DataPackInterfaceConstSharedPtr datapack;
+
+                if(datapackData.data().Is<EngineGrpc::DataPackUnchanged>()) {
+                    interfaces.push_back(this->unchangedDataPack(datapackData.datapackid().datapackname()));
+                    continue;
+                }
+
+                for(auto& mod : _protoOps) {
+                    datapack = mod->getDataPackInterfaceFromMessage(this->engineName(), datapackData, arena);
+
+                    if(datapack != nullptr)
+                        break;
+                }
+
+                if(datapack) {
+                    this->storeReceivedDataPack(datapack);
+                    interfaces.push_back(datapack);
+                }
+                else
+                    throw NRPException::logCreate("In Engine \"" + this->engineName() + "\", unable to deserialize datapack \"" +
+                                                          datapackData.datapackid().datapackname() + "\" using any of the NRP-Core Protobuf plugins specified in the"
+                                                          " engine configuration: [" + _protoOpsStr + "]. Ensure that the parameter "
+                                                          "\"ProtobufPackages\" is properly set in the Engine configuration");
+            }
+
+            return interfaces;
+        }
+
+        /*!
+         * \brief Deserializes the datapacks contained in a SegmentedGetDataPacksReply
+         *
+         * The segments of the reply are moved into the datapacks data, which is allocated as in dataPacksFromReply()
+         */
+        datapacks_vector_t dataPacksFromSegmentedReply(EngineGrpc::SegmentedGetDataPacksReply & reply)
+        {
+            const auto arena = this->_arenaPool.acquire();
+
+            datapacks_vector_t interfaces;
+            for(auto & datapackData : *reply.mutable_datapacks()) {
+                DataPackInterfaceConstSharedPtr datapack;
+
+                if(datapackData.datatype() == EngineGrpc::DataPackUnchanged::descriptor()->full_name()) {
+                    interfaces.push_back(this->unchangedDataPack(datapackData.datapackid().datapackname()));
+                    continue;
+                }
+
+                for(auto& mod : _protoOps) {
+                    datapack = mod->getDataPackInterfaceFromSegmentedMessage(this->engineName(), datapackData, arena);
+
+                    if(datapack != nullptr)
+                        break;
+                }
+
+                if(datapack) {
+                    this->storeReceivedDataPack(datapack);
+                    interfaces.push_back(datapack);
+                }
+                else
+                    throw NRPException::logCreate("In Engine \"" + this->engineName() + "\", unable to deserialize datapack \"" +
+                                                          datapackData.datapackid().datapackname() + "\" using any of the NRP-Core Protobuf plugins specified in the"
+                                                          " engine configuration: [" + _protoOpsStr + "]. Ensure that the parameter "
+                                                          "\"ProtobufPackages\" is properly set in the Engine configuration");
+            }
+
+            return interfaces;
+        }
+
+        /*!
+         * \brief Stores a copy of a received datapack, which is returned again if the engine reports it as unchanged
+         *
+         * The copy shares the data of the datapack. Empty datapacks are not stored
+         */
+        void storeReceivedDataPack(const DataPackInterfaceConstSharedPtr & dataPack)
+        {
+            if(!dataPack->isEmpty())
+                this->_receivedDataPacks[dataPack->name()] = DataPackInterfaceConstSharedPtr(dataPack->clone());
+        }
+
+        /*!
+         * \brief Returns a copy of the last received datapack with the given name, for which an "unchanged" marker was received
+         */
+        DataPackInterfaceConstSharedPtr unchangedDataPack(const std::string & name) const
+        {
+            const auto receivedDataPack = this->_receivedDataPacks.find(name);
+            if(receivedDataPack == this->_receivedDataPacks.end())
+                throw NRPException::logCreate("In Engine \"" + this->engineName() + "\", datapack \"" + name +
+                                              "\" was reported as unchanged, but it wasn't received before");
+
+            return DataPackInterfaceConstSharedPtr(receivedDataPack->second->clone());
+        }
+
+        /*!
+         * \brief Drops the datapacks prefetched with the last fused step
+         *
+         * They are deserialized anyway, since the engine reports them as unchanged afterwards if their data doesn't change
+         */
+        void discardPrefetchedDataPacks()
+        {
+            if(this->_hasPrefetchedDataPacks)
+                this->dataPacksFromReply(this->_prefetchedDataPacks);
+
+            this->_hasPrefetchedDataPacks = false;
+        }
+
+        /*!
+         * \brief Serializes datapacks into a SetDataPacksRequest
+         */
+        void fillSetDataPacksRequest(const datapacks_set_t &dataPacks, EngineGrpc::SetDataPacksRequest * request)
+        {
+            for(const auto &datapack : dataPacks)
+            {
+                assert(datapack->engineName() == this->engineName());
+
+                if(datapack->isEmpty())
+                    throw NRPException::logCreate("Attempt to send empty datapack " + datapack->name() + " to Engine " + this->engineName());
+                else {
+                    auto protoDataPack = request->add_datapacks();
+
+                    bool isSet = false;
+                    for(auto& mod : _protoOps) {
+                        if(mod->trySetDataPackMessageFromInterface(*datapack, protoDataPack)) {
+                            isSet = true;
+                            break;
+                        }
+                    }
+
+                    if(!isSet)
+                        throw NRPException::logCreate("In Engine \"" + this->engineName() + "\", unable to serialize datapack \"" +
+                                                      datapack->name() + "\" using any of the NRP-Core Protobuf plugins specified in the"
+                                                      " engine configuration: [" + _protoOpsStr + "]. Ensure that the parameter "
+                                                      "\"ProtobufPackages\" is properly set in the Engine configuration");
+                }
+            }
+        }
+
+        /*!
+         * \brief Sends the datapacks buffered for the next fused step, if there are any
+         *
+         * Called before any call which isn't a step, so that the engine receives the datapacks in the same order as
+         * with separate calls, and none are lost at shutdown
+         */
+        void sendPendingDataPacks()
+        {
+            if(this->_pendingSetRequest.datapacks_size() == 0)
+                return;
+
+            EngineGrpc::SetDataPacksRequest request;
+            request.Swap(&this->_pendingSetRequest);
+
+            this->sendSetDataPacksRequest(request);
+        }
+
+        /*!
+         * \brief Sends a SetDataPacksRequest to the engine server
+         */
+        void sendSetDataPacksRequest(const EngineGrpc::SetDataPacksRequest & request)
+        {
+            EngineGrpc::SetDataPacksReply   reply;
+            grpc::ClientContext             context;
+
+            prepareRpcContext(&context);
+
+            grpc::Status status = this->_cqDriver ?
+                this->asyncCall([this, &request] (grpc::ClientContext * asyncContext) {
+                    return this->_stub->PrepareAsyncsetDataPacks(asyncContext, request, this->_cqDriver->completionQueue());
+                }, &reply) :
+                this->unaryCall(EngineShmMethod::SetDataPacks, request, &reply, [&] () {
+                    return _stub->setDataPacks(&context, request, &reply);
+                });
+
+            if(!status.ok())
+            {
+                const auto errMsg = "In Engine \"" + this->engineName() + "\", sendDataPacksToEngine failed: " + status.error_message() + " (" + std::to_string(status.error_code()) + ")";
+                throw std::runtime_error(errMsg);
+            }
+        }
+
         std::shared_ptr<grpc::Channel>                       _channel;
         std::unique_ptr<EngineGrpc::EngineGrpcService::Stub> _stub;
         std::string _serverAddress;
 
+        /*!
+         * \brief Stub of the optional fused step-and-exchange service. Only created if FusedStepExchange is enabled
+         */
+        std::unique_ptr<EngineGrpc::EngineGrpcFusedService::Stub> _fusedStub;
+
+        /*!
+         * \brief Whether the fused step-and-exchange call is used. Disabled on the fly if the server doesn't support it
+         */
+        bool _useFusedStep = false;
+
+        /*!
+         * \brief Stub of the optional segmented datapack service. Only created if SegmentedDataPacks is enabled
+         */
+        std::unique_ptr<EngineGrpc::EngineGrpcSegmentedService::Stub> _segmentedStub;
+
+        /*!
+         * \brief Whether datapacks are fetched as segmented messages. Disabled on the fly if the server doesn't support it
+         */
+        bool _useSegmentedDataPacks = false;
+
+        /*!
+         * \brief Stub of the optional datapack subscription service. Only created if DataPackSubscription is enabled
+         */
+        std::unique_ptr<EngineGrpc::EngineGrpcSubscriptionService::Stub> _subscriptionStub;
+
+        /*!
+         * \brief Whether datapacks are received through a subscription. Disabled on the fly if the server doesn't support it
+         */
+        bool _useDataPackSubscription = false;
+
+        /*!
+         * \brief Compression codec requested for large datapacks, and minimum size of the compressed datapacks
+         */
+        EngineGrpc::CompressionCodec _dataPackCompression          = EngineGrpc::COMPRESSION_NONE;
+        size_t                       _dataPackCompressionThreshold = protobuf_ops::DEFAULT_MIN_COMPRESSED_SIZE;
+
+        /*!
+         * \brief Subscription call and the ids of the datapacks subscribed with it
+         */
+        std::unique_ptr<grpc::ClientContext>                            _subscriptionContext;
+        std::unique_ptr<grpc::ClientReader<EngineGrpc::DataPackUpdate>> _subscriptionReader;
+        datapack_identifiers_set_t                                      _subscribedDataPackIds;
+
+        /*!
+         * \brief Loop steps completed since the subscription, and step of the last update read from it
+         */
+        uint64_t _subscriptionStep         = 0;
+        int64_t  _receivedSubscriptionStep = -1;
+
+        /*!
+         * \brief DataPacks waiting to be sent with the next fused step
+         */
+        EngineGrpc::SetDataPacksRequest _pendingSetRequest;
+
+        /*!
+         * \brief DataPacks requested with the fused step, and the reply received from the engine
+         */
+        datapack_identifiers_set_t     _prefetchedDataPackIds;
+        EngineGrpc::GetDataPacksReply  _prefetchedDataPacks;
+        bool                           _hasPrefetchedDataPacks = false;
+
+        /*!
+         * \brief Copies of the last received datapacks, by name. Returned when the engine reports a datapack as unchanged
+         */
+        std::map<std::string, DataPackInterfaceConstSharedPtr> _receivedDataPacks;
+
+        /*!
+         * \brief Shared memory channel to the engine server, used instead of gRPC if EngineTransport is "shm"
+         */
+        ShmChannelUniquePtr _shmChannel;
+
+        /*!
+         * \brief Completion queue driver used in async mode. Null in sync mode
+         */
+        GrpcCompletionQueueDriverSharedPtr _cqDriver;
+
+        /*!
+         * \brief Steps started by runLoopStepAsync() in async mode and not retrieved yet
+         */
+        std::shared_ptr<GrpcAsyncCall<EngineGrpc::RunLoopStepReply>>             _pendingStep;
+        std::shared_ptr<GrpcAsyncCall<EngineGrpc::RunLoopStepAndExchangeReply>>  _pendingFusedStep;
+        EngineGrpc::RunLoopStepAndExchangeRequest                                _fusedStepRequest;
+        SimulationTime                                                           _pendingTimeStep = SimulationTime::zero();
+
         SimulationTime _prevEngineTime = SimulationTime::zero();
         SimulationTime _rpcTimeout     = SimulationTime::zero();
 
     std::vector<std::unique_ptr<protobuf_ops::NRPProtobufOpsIface>> _protoOps;
     std::string _protoOpsStr = "";
+
+    /*!
+     * \brief Arenas in which the datapacks received from the engine are allocated, one per step
+     */
+    ArenaPool _arenaPool;
 };
 
 
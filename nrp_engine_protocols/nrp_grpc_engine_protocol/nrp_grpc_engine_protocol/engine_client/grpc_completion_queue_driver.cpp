@@ -0,0 +1,69 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_grpc_engine_protocol/engine_client/grpc_completion_queue_driver.h"
+
+std::mutex GrpcCompletionQueueDriver::_instanceLock;
+std::weak_ptr<GrpcCompletionQueueDriver> GrpcCompletionQueueDriver::_instance;
+
+GrpcCompletionQueueDriver::shared_ptr GrpcCompletionQueueDriver::getInstance()
+{
+    std::scoped_lock lock(GrpcCompletionQueueDriver::_instanceLock);
+
+    auto instance = GrpcCompletionQueueDriver::_instance.lock();
+    if(!instance)
+    {
+        instance.reset(new GrpcCompletionQueueDriver());
+        GrpcCompletionQueueDriver::_instance = instance;
+    }
+
+    return instance;
+}
+
+GrpcCompletionQueueDriver::GrpcCompletionQueueDriver()
+    : _thread([this] () { this->run(); })
+{}
+
+GrpcCompletionQueueDriver::~GrpcCompletionQueueDriver()
+{
+    this->_completionQueue.Shutdown();
+
+    if(this->_thread.joinable())
+        this->_thread.join();
+}
+
+grpc::CompletionQueue *GrpcCompletionQueueDriver::completionQueue()
+{
+    return &this->_completionQueue;
+}
+
+void GrpcCompletionQueueDriver::run()
+{
+    void *tag = nullptr;
+    bool ok = false;
+
+    // Next() returns false once the queue has been shut down and drained
+    while(this->_completionQueue.Next(&tag, &ok))
+        static_cast<GrpcAsyncCallBase*>(tag)->onComplete(ok);
+}
+
+// EOF
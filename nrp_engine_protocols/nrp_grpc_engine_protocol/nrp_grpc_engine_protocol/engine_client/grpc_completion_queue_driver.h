@@ -0,0 +1,195 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#ifndef GRPC_COMPLETION_QUEUE_DRIVER_H
+#define GRPC_COMPLETION_QUEUE_DRIVER_H
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <grpcpp/grpcpp.h>
+
+#include "nrp_general_library/utils/ptr_templates.h"
+
+/*!
+ * \brief Base class of asynchronous gRPC calls processed by GrpcCompletionQueueDriver
+ */
+class GrpcAsyncCallBase
+{
+    public:
+
+        virtual ~GrpcAsyncCallBase() = default;
+
+        /*!
+         * \brief Invoked by the driver thread when the call has finished
+         * \param ok Whether the completion queue operation succeeded
+         */
+        virtual void onComplete(bool ok) = 0;
+};
+
+/*!
+ * \brief Asynchronous unary gRPC call
+ *
+ * The call object keeps itself alive until it has completed, so that it can be safely released by its owner
+ * at any moment.
+ *
+ * \tparam REPLY Type of the reply message
+ */
+template<class REPLY>
+class GrpcAsyncCall
+        : public GrpcAsyncCallBase,
+          public std::enable_shared_from_this<GrpcAsyncCall<REPLY>>
+{
+    public:
+
+        using reader_t = grpc::ClientAsyncResponseReader<REPLY>;
+
+        /*!
+         * \brief Context of the call. Must be set up before calling start()
+         */
+        grpc::ClientContext context;
+
+        /*!
+         * \brief Reply received from the server. Valid once the call has completed
+         */
+        REPLY reply;
+
+        /*!
+         * \brief Status of the call. Valid once the call has completed
+         */
+        grpc::Status status;
+
+        /*!
+         * \brief Starts the call
+         * \param prepareCall Function returning the reader of the call, e.g. a call to Stub::PrepareAsync<method>
+         * \param onDone Function invoked from the driver thread once the call has completed. Can be empty
+         */
+        void start(std::function<std::unique_ptr<reader_t>(grpc::ClientContext *)> prepareCall, std::function<void()> onDone = {})
+        {
+            this->_onDone = std::move(onDone);
+            this->_self   = this->shared_from_this();
+
+            this->_reader = prepareCall(&this->context);
+            this->_reader->StartCall();
+            this->_reader->Finish(&this->reply, &this->status, static_cast<GrpcAsyncCallBase*>(this));
+        }
+
+        /*!
+         * \brief Waits until the call has completed
+         * \param timeout Maximum time to wait. If it's less or equal to 0, the function will wait indefinitely
+         * \return Returns false on timeout, true otherwise
+         */
+        template<class DURATION>
+        bool wait(DURATION timeout)
+        {
+            if(timeout <= DURATION::zero())
+            {
+                this->_done.wait();
+                return true;
+            }
+
+            return this->_done.wait_for(timeout) == std::future_status::ready;
+        }
+
+        /*!
+         * \brief Waits until the call has completed
+         */
+        void wait()
+        {
+            this->_done.wait();
+        }
+
+        void onComplete(bool /*ok*/) override
+        {
+            // Keep the call alive until this function returns
+            const auto self = std::move(this->_self);
+
+            if(this->_onDone)
+                this->_onDone();
+
+            this->_donePromise.set_value();
+        }
+
+    private:
+
+        std::unique_ptr<reader_t> _reader;
+        std::function<void()> _onDone;
+
+        std::promise<void> _donePromise;
+        std::shared_future<void> _done = _donePromise.get_future().share();
+
+        std::shared_ptr<GrpcAsyncCall<REPLY>> _self;
+};
+
+/*!
+ * \brief Drives the asynchronous gRPC calls of all engine clients running in async mode
+ *
+ * A single thread waits on a grpc::CompletionQueue shared by all clients and completes their calls,
+ * so that in-flight calls don't need a blocked thread each.
+ */
+class GrpcCompletionQueueDriver
+        : public PtrTemplates<GrpcCompletionQueueDriver>
+{
+    public:
+
+        /*!
+         * \brief Returns the driver shared by all clients. It is created on first use and destroyed with its last user
+         */
+        static GrpcCompletionQueueDriver::shared_ptr getInstance();
+
+        GrpcCompletionQueueDriver();
+
+        /*!
+         * \brief Destructor. Shuts down the completion queue and joins the driver thread
+         */
+        ~GrpcCompletionQueueDriver();
+
+        GrpcCompletionQueueDriver(const GrpcCompletionQueueDriver &) = delete;
+        GrpcCompletionQueueDriver &operator=(const GrpcCompletionQueueDriver &) = delete;
+
+        /*!
+         * \brief Returns the completion queue in which calls must be started
+         */
+        grpc::CompletionQueue *completionQueue();
+
+    private:
+
+        /*!
+         * \brief Driver thread main function
+         */
+        void run();
+
+        grpc::CompletionQueue _completionQueue;
+        std::thread _thread;
+
+        static std::mutex _instanceLock;
+        static std::weak_ptr<GrpcCompletionQueueDriver> _instance;
+};
+
+using GrpcCompletionQueueDriverSharedPtr = GrpcCompletionQueueDriver::shared_ptr;
+
+#endif // GRPC_COMPLETION_QUEUE_DRIVER_H
+
+// EOF
@@ -22,8 +22,14 @@
 #ifndef ENGINE_GRPC_SERVER_H
 #define ENGINE_GRPC_SERVER_H
 
+#include <algorithm>
+#include <condition_variable>
+#include <list>
 #include <string>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include <type_traits>
 
 #include <grpcpp/grpcpp.h>
@@ -31,14 +37,20 @@
 #include <nlohmann/json.hpp>
 
 #include "nrp_protobuf/engine_grpc.grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_fused.grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_segments.grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_subscription.grpc.pb.h"
 #include "nrp_general_library/engine_interfaces/datapack_controller.h"
 #include "nrp_general_library/utils/time_utils.h"
 #include "nrp_protobuf/config/cmake_constants.h"
 #include "nrp_protobuf/proto_python_bindings/proto_field_ops.h"
+#include "nrp_protobuf/proto_ops/datapack_compression.h"
 #include "nrp_protobuf/proto_ops/protobuf_ops.h"
 #include "nrp_protobuf/proto_ops/proto_ops_manager.h"
 
+#include "nrp_grpc_engine_protocol/config/engine_grpc_config.h"
 #include "nrp_grpc_engine_protocol/engine_server/engine_proto_wrapper.h"
+#include "nrp_grpc_engine_protocol/shm_transport/shm_channel.h"
 
 
 using EngineGrpc::EngineGrpcService;
@@ -49,14 +61,22 @@ using EngineGrpc::EngineGrpcService;
  * The class provides an Engine server with gRPC
  * as middleware. All RPC services are implemented. EngineProtoWrapper is used to perform
  * the actual simulation initialization, shutdown, reset, data exchange and run step operations.
+ *
+ * If the client created a shared memory segment for the server address, ie. if it uses the shared memory transport,
+ * the same calls are also served through a ShmChannel by a dedicated thread.
+ *
+ * Clients can also subscribe to datapacks with the EngineGrpcSubscriptionService. Subscribed datapacks are fetched
+ * right after each loop step and pushed to the client on a server-streaming call. This service isn't available
+ * through the shared memory transport.
  */
 
 class EngineGrpcServer : public EngineGrpcService::Service
 {
     public:
 
-        using mutex_t = std::timed_mutex;
-        using lock_t  = std::unique_lock<EngineGrpcServer::mutex_t>;
+        using mutex_t       = std::shared_timed_mutex;
+        using lock_t        = std::unique_lock<EngineGrpcServer::mutex_t>;
+        using shared_lock_t = std::shared_lock<EngineGrpcServer::mutex_t>;
 
         /*!
          * \brief No dummy servers, only those with name and url
@@ -70,7 +90,10 @@ class EngineGrpcServer : public EngineGrpcService::Service
          * \param[in] engineWrapper Class processing requests to the Engine
          */
         EngineGrpcServer(const std::string serverAddress, EngineProtoWrapper* engineWrapper)
-                :  _engineWrapper(engineWrapper)
+                :  _engineWrapper(engineWrapper),
+                   _fusedService(this),
+                   _segmentedService(this),
+                   _subscriptionService(this)
         {
             this->_serverAddress   = serverAddress;
             this->_isServerRunning = false;
@@ -96,9 +119,21 @@ class EngineGrpcServer : public EngineGrpcService::Service
                 grpc::ServerBuilder builder;
                 builder.AddListeningPort(_serverAddress, grpc::InsecureServerCredentials());
                 builder.RegisterService(this);
+                builder.RegisterService(&this->_fusedService);
+                builder.RegisterService(&this->_segmentedService);
+                builder.RegisterService(&this->_subscriptionService);
                 NRPLogger::debug("Using server address: "+ this->_serverAddress);
 
+                this->_subscriptionsClosed = false;
                 this->_server = builder.BuildAndStart();
+
+                this->_shmChannel = ShmChannel::open(ShmChannel::segmentName(this->_serverAddress));
+                if(this->_shmChannel)
+                {
+                    NRPLogger::debug("Serving requests through shared memory segment: " + ShmChannel::segmentName(this->_serverAddress));
+                    this->_shmThread = std::thread(&EngineGrpcServer::serveShmChannel, this);
+                }
+
                 // TODO Should we use a memory barrier here?
                 this->_isServerRunning = true;
             }
@@ -119,7 +154,17 @@ class EngineGrpcServer : public EngineGrpcService::Service
         {
             if(this->_isServerRunning)
             {
+                // Subscription calls only return when they are closed, the server would wait for them indefinitely
+                this->closeSubscriptions();
                 this->_server->Shutdown();
+
+                if(this->_shmThread.joinable())
+                {
+                    this->_shmChannel->interrupt();
+                    this->_shmThread.join();
+                }
+                this->_shmChannel.reset();
+
                 // TODO Should we use a memory barrier here?
                 this->_isServerRunning = false;
             }
@@ -153,6 +198,212 @@ class EngineGrpcServer : public EngineGrpcService::Service
 
     private:
 
+        friend class EngineGrpc_ConcurrentGetDataPacks_Test;
+
+        /*!
+         * \brief Implementation of the optional EngineGrpcFusedService
+         *
+         * gRPC services can't be combined in a single class, so the fused service is registered as a separate
+         * object forwarding its calls to the owning EngineGrpcServer
+         */
+        class FusedService : public EngineGrpc::EngineGrpcFusedService::Service
+        {
+            public:
+
+                explicit FusedService(EngineGrpcServer * server)
+                    : _server(server)
+                {}
+
+                grpc::Status runLoopStepAndExchange(      grpc::ServerContext                       * context,
+                                                    const EngineGrpc::RunLoopStepAndExchangeRequest * request,
+                                                          EngineGrpc::RunLoopStepAndExchangeReply   * reply) override
+                {
+                    return this->_server->runLoopStepAndExchange(context, request, reply);
+                }
+
+            private:
+
+                EngineGrpcServer * _server;
+        };
+
+        /*!
+         * \brief Implementation of the optional EngineGrpcSegmentedService. See FusedService
+         */
+        class SegmentedService : public EngineGrpc::EngineGrpcSegmentedService::Service
+        {
+            public:
+
+                explicit SegmentedService(EngineGrpcServer * server)
+                    : _server(server)
+                {}
+
+                grpc::Status getDataPacks(      grpc::ServerContext                    * context,
+                                          const EngineGrpc::GetDataPacksRequest        * request,
+                                                EngineGrpc::SegmentedGetDataPacksReply * reply) override
+                {
+                    return this->_server->getDataPacksSegmented(context, request, reply);
+                }
+
+            private:
+
+                EngineGrpcServer * _server;
+        };
+
+        /*!
+         * \brief Implementation of the optional EngineGrpcSubscriptionService. See FusedService
+         */
+        class SubscriptionService : public EngineGrpc::EngineGrpcSubscriptionService::Service
+        {
+            public:
+
+                explicit SubscriptionService(EngineGrpcServer * server)
+                    : _server(server)
+                {}
+
+                grpc::Status subscribeDataPacks(      grpc::ServerContext                          * context,
+                                                const EngineGrpc::GetDataPacksRequest              * request,
+                                                      grpc::ServerWriter<EngineGrpc::DataPackUpdate> * writer) override
+                {
+                    return this->_server->subscribeDataPacks(context, request, writer);
+                }
+
+            private:
+
+                EngineGrpcServer * _server;
+        };
+
+        /*!
+         * \brief Compression of the datapacks sent to a client, as requested in the metadata of its calls
+         */
+        struct DataPackCompression
+        {
+            EngineGrpc::CompressionCodec codec             = EngineGrpc::COMPRESSION_NONE;
+            size_t                       minCompressedSize = protobuf_ops::DEFAULT_MIN_COMPRESSED_SIZE;
+        };
+
+        /*!
+         * \brief Datapacks subscribed by a client, and the update waiting to be sent to it
+         *
+         * Updates are pushed by the thread running loop steps and sent by the thread serving the subscription call.
+         * If an update is pushed before the previous one was sent, both are merged.
+         */
+        struct DataPackSubscription
+        {
+            EngineGrpc::GetDataPacksRequest request;
+            DataPackCompression             compression;
+            uint64_t                        firstStep = 0;
+            EngineGrpc::DataPackUpdate      pendingUpdate;
+            bool                            hasPendingUpdate = false;
+            bool                            closed           = false;
+            std::string                     error;
+            std::mutex                      lock;
+            std::condition_variable         updated;
+
+            /*!
+             * \brief Stores an update until it is sent. Datapacks of the pending update are replaced by the new ones
+             *
+             * Pending datapacks are kept if the new ones are "unchanged" markers, their data wasn't received yet
+             */
+            void push(EngineGrpc::DataPackUpdate & update)
+            {
+                std::lock_guard<std::mutex> subscriptionLock(this->lock);
+
+                if(!this->hasPendingUpdate)
+                    this->pendingUpdate.Swap(&update);
+                else
+                {
+                    this->pendingUpdate.set_step(update.step());
+
+                    auto * pendingDataPacks = this->pendingUpdate.mutable_datapacks()->mutable_datapacks();
+                    for(auto & dataPack : *update.mutable_datapacks()->mutable_datapacks())
+                    {
+                        auto pendingDataPack = std::find_if(pendingDataPacks->begin(), pendingDataPacks->end(), [&dataPack] (const EngineGrpc::DataPackMessage & pending) {
+                            return pending.datapackid().datapackname() == dataPack.datapackid().datapackname();
+                        });
+
+                        if(pendingDataPack != pendingDataPacks->end())
+                        {
+                            if(!dataPack.data().Is<EngineGrpc::DataPackUnchanged>())
+                                pendingDataPack->Swap(&dataPack);
+                        }
+                        else
+                            pendingDataPacks->Add()->Swap(&dataPack);
+                    }
+                }
+
+                this->hasPendingUpdate = true;
+                this->updated.notify_one();
+            }
+
+            /*!
+             * \brief Waits for an update to be pushed
+             *
+             * \param[out] update  Update to be sent
+             * \param[in]  context Context of the subscription call, used to detect if the client cancelled it
+             *
+             * \return False if the subscription was closed or cancelled
+             */
+            bool pop(EngineGrpc::DataPackUpdate & update, grpc::ServerContext * context)
+            {
+                std::unique_lock<std::mutex> subscriptionLock(this->lock);
+
+                while(!this->hasPendingUpdate && !this->closed)
+                {
+                    if(context->IsCancelled())
+                        return false;
+
+                    this->updated.wait_for(subscriptionLock, std::chrono::milliseconds(100));
+                }
+
+                if(this->closed)
+                    return false;
+
+                update.Clear();
+                update.Swap(&this->pendingUpdate);
+                this->hasPendingUpdate = false;
+
+                return true;
+            }
+
+            /*!
+             * \brief Closes the subscription, waking up the thread waiting for updates
+             *
+             * \param[in] errorMessage Error which caused the subscription to be closed, if any
+             */
+            void close(const std::string & errorMessage = "")
+            {
+                std::lock_guard<std::mutex> subscriptionLock(this->lock);
+
+                this->closed = true;
+                this->error  = errorMessage;
+                this->updated.notify_one();
+            }
+        };
+
+        /*!
+         * \brief Lock held by calls which only read datapacks
+         *
+         * The engine call lock is taken in shared mode if the engine allows concurrent datapack reads (see
+         * EngineProtoWrapper::allowsConcurrentDataPackReads), and exclusively otherwise
+         */
+        struct DataPackReadLock
+        {
+            DataPackReadLock(mutex_t & engineCallLock, bool concurrentReads)
+            {
+                if(concurrentReads)
+                    this->sharedLock = shared_lock_t(engineCallLock);
+                else
+                    this->lock = lock_t(engineCallLock);
+            }
+
+            shared_lock_t sharedLock;
+            lock_t lock;
+        };
+
+        /*!
+         * \brief Serializes calls to the engine. Calls which only read datapacks hold it in shared mode if the engine
+         * allows it, so that they can run in parallel with each other. See DataPackReadLock
+         */
         mutex_t _engineCallLock;
 
         /*!
@@ -175,6 +426,118 @@ class EngineGrpcServer : public EngineGrpcService::Service
          */
         std::unique_ptr<EngineProtoWrapper> _engineWrapper;
 
+        /*!
+         * \brief Fused step-and-exchange service, registered together with this server
+         */
+        FusedService _fusedService;
+
+        /*!
+         * \brief Segmented datapack service, registered together with this server
+         */
+        SegmentedService _segmentedService;
+
+        /*!
+         * \brief Datapack subscription service, registered together with this server
+         */
+        SubscriptionService _subscriptionService;
+
+        /*!
+         * \brief Number of loop steps run by the engine. Guarded by _engineCallLock
+         */
+        uint64_t _stepCount = 0;
+
+        /*!
+         * \brief Active datapack subscriptions. New subscriptions are refused once they have been closed on shutdown
+         */
+        std::list<std::shared_ptr<DataPackSubscription>> _subscriptions;
+        bool                                              _subscriptionsClosed = false;
+        std::mutex                                        _subscriptionsLock;
+
+        /*!
+         * \brief Shared memory channel to the client. Null if the client doesn't use the shared memory transport
+         */
+        ShmChannelUniquePtr _shmChannel;
+
+        /*!
+         * \brief Thread serving the requests received through the shared memory channel
+         */
+        std::thread _shmThread;
+
+        /*!
+         * \brief Serves the requests received through the shared memory channel until it is interrupted
+         *
+         * Requests are dispatched to the same functions serving gRPC requests. Replies are sent with the status code
+         * of the call as tag and the call id of the request, and contain the serialized reply message or the error
+         * message.
+         */
+        void serveShmChannel()
+        {
+            uint32_t    method;
+            uint32_t    callId;
+            std::string request;
+
+            try
+            {
+                while(this->_shmChannel->receive(method, request, ShmChannel::duration_t::zero(), &callId))
+                {
+                    switch(static_cast<EngineShmMethod>(method))
+                    {
+                        case EngineShmMethod::Initialize:
+                            this->serveShmCall<EngineGrpc::InitializeRequest, EngineGrpc::InitializeReply>(request, callId, &EngineGrpcServer::initialize);
+                            break;
+                        case EngineShmMethod::Reset:
+                            this->serveShmCall<EngineGrpc::ResetRequest, EngineGrpc::ResetReply>(request, callId, &EngineGrpcServer::reset);
+                            break;
+                        case EngineShmMethod::Shutdown:
+                            this->serveShmCall<EngineGrpc::ShutdownRequest, EngineGrpc::ShutdownReply>(request, callId, &EngineGrpcServer::shutdown);
+                            break;
+                        case EngineShmMethod::RunLoopStep:
+                            this->serveShmCall<EngineGrpc::RunLoopStepRequest, EngineGrpc::RunLoopStepReply>(request, callId, &EngineGrpcServer::runLoopStep);
+                            break;
+                        case EngineShmMethod::SetDataPacks:
+                            this->serveShmCall<EngineGrpc::SetDataPacksRequest, EngineGrpc::SetDataPacksReply>(request, callId, &EngineGrpcServer::setDataPacks);
+                            break;
+                        case EngineShmMethod::GetDataPacks:
+                            this->serveShmCall<EngineGrpc::GetDataPacksRequest, EngineGrpc::GetDataPacksReply>(request, callId, &EngineGrpcServer::getDataPacks);
+                            break;
+                        case EngineShmMethod::RunLoopStepAndExchange:
+                            this->serveShmCall<EngineGrpc::RunLoopStepAndExchangeRequest, EngineGrpc::RunLoopStepAndExchangeReply>(request, callId, &EngineGrpcServer::runLoopStepAndExchange);
+                            break;
+                        case EngineShmMethod::GetDataPacksSegmented:
+                            this->serveShmCall<EngineGrpc::GetDataPacksRequest, EngineGrpc::SegmentedGetDataPacksReply>(request, callId, &EngineGrpcServer::getDataPacksSegmented);
+                            break;
+                        default:
+                            this->_shmChannel->send(grpc::StatusCode::UNIMPLEMENTED, "Unknown method id: " + std::to_string(method), callId);
+                    }
+                }
+            }
+            catch(const std::exception &e)
+            {
+                NRPLogger::error("Shared memory channel of engine server {} stopped: {}", this->_serverAddress, e.what());
+            }
+        }
+
+        /*!
+         * \brief Serves a single request received through the shared memory channel
+         *
+         * \param request Serialized request message
+         * \param callId  Id of the call, sent back with the reply
+         * \param call    Function serving the corresponding gRPC call
+         */
+        template<class REQUEST, class REPLY>
+        void serveShmCall(const std::string &request, uint32_t callId,
+                          grpc::Status (EngineGrpcServer::*call)(grpc::ServerContext *, const REQUEST *, REPLY *))
+        {
+            REQUEST requestMsg;
+            REPLY   replyMsg;
+
+            const grpc::Status status = requestMsg.ParseFromString(request) ?
+                    (this->*call)(nullptr, &requestMsg, &replyMsg) :
+                    grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Failed to parse the request received through shared memory");
+
+            this->_shmChannel->send(status.error_code(), status.ok() ? replyMsg.SerializeAsString() : status.error_message(), callId);
+        }
+
         /*!
          * \brief Initializes the simulation
          *
@@ -235,6 +598,9 @@ class EngineGrpcServer : public EngineGrpcService::Service
 
                 // Run engine-specific reset function
                 this->_engineWrapper->reset();
+
+                // The client drops the datapacks it received before the reset
+                this->_engineWrapper->resetDataPackSequences();
             }
             catch(const std::exception &e)
             {
@@ -307,6 +673,8 @@ class EngineGrpcServer : public EngineGrpcService::Service
                 int64_t engineTime = (this->_engineWrapper->runLoopStep(SimulationTime(request->timestep()))).count();
 
                 reply->set_enginetime(engineTime);
+
+                this->pushDataPackUpdates();
             }
             catch(const std::exception &e)
             {
@@ -360,15 +728,19 @@ class EngineGrpcServer : public EngineGrpcService::Service
          *
          * \return gRPC request status
          */
-        grpc::Status getDataPacks(      grpc::ServerContext             * /*context*/,
+        grpc::Status getDataPacks(      grpc::ServerContext             * context,
                                   const EngineGrpc::GetDataPacksRequest * request,
                                         EngineGrpc::GetDataPacksReply   * reply) override
         {
             try
             {
-                EngineGrpcServer::lock_t lock(this->_engineCallLock);
+                {
+                    DataPackReadLock lock(this->_engineCallLock, this->_engineWrapper->allowsConcurrentDataPackReads());
+
+                    this->_engineWrapper->getDataPacks(*request, reply);
+                }
 
-                this->_engineWrapper->getDataPacks(*request, reply);
+                compressDataPacks(requestedCompression(context), reply);
             }
             catch(const std::exception &e)
             {
@@ -378,6 +750,226 @@ class EngineGrpcServer : public EngineGrpcService::Service
             return grpc::Status::OK;
         }
 
+        /*!
+         * \brief Gets data from requested datapacks as segmented datapack messages
+         *
+         * The function implements the getDataPacks method of the EngineGrpcSegmentedService.
+         * It acts as a wrapper around EngineProtoWrapper::getDataPacksSegmented.
+         * On error, it will return a status object with error message and grpc::StatusCode::CANCELLED error code.
+         *
+         * \param      context Pointer to gRPC server context structure
+         * \param[in]  request Pointer to protobuf request message. Contains metadata of requested datapacks.
+         * \param[out] reply   Pointer to protobuf reply message. Contains datapack data and metadata.
+         *
+         * \return gRPC request status
+         */
+        grpc::Status getDataPacksSegmented(      grpc::ServerContext                    * /*context*/,
+                                           const EngineGrpc::GetDataPacksRequest        * request,
+                                                 EngineGrpc::SegmentedGetDataPacksReply * reply)
+        {
+            try
+            {
+                DataPackReadLock lock(this->_engineCallLock, this->_engineWrapper->allowsConcurrentDataPackReads());
+
+                this->_engineWrapper->getDataPacksSegmented(*request, reply);
+            }
+            catch(const std::exception &e)
+            {
+                return handleGrpcError("Error while executing getDataPacksSegmented", e.what());
+            }
+
+            return grpc::Status::OK;
+        }
+
+        /*!
+         * \brief Sets datapacks, runs a single loop step and gets datapacks in a single call
+         *
+         * The function implements the runLoopStepAndExchange method of the EngineGrpcFusedService.
+         * It acts as a wrapper around EngineProtoWrapper::runLoopStepAndExchange.
+         * On error, it will return a status object with error message and grpc::StatusCode::CANCELLED error code.
+         *
+         * \param      context Pointer to gRPC server context structure
+         * \param[in]  request Pointer to protobuf request message. Contains datapacks to set, simulation time step
+         *                     and metadata of requested datapacks.
+         * \param[out] reply   Pointer to protobuf reply message. Contains engine time and requested datapacks.
+         *
+         * \return gRPC request status
+         */
+        grpc::Status runLoopStepAndExchange(      grpc::ServerContext                       * context,
+                                            const EngineGrpc::RunLoopStepAndExchangeRequest * request,
+                                                  EngineGrpc::RunLoopStepAndExchangeReply   * reply)
+        {
+            try
+            {
+                {
+                    EngineGrpcServer::lock_t lock(this->_engineCallLock);
+
+                    this->_engineWrapper->runLoopStepAndExchange(*request, reply);
+
+                    this->pushDataPackUpdates();
+                }
+
+                compressDataPacks(requestedCompression(context), reply->mutable_getreply());
+            }
+            catch(const std::exception &e)
+            {
+                return handleGrpcError("Error while executing runLoopStepAndExchange", e.what());
+            }
+
+            return grpc::Status::OK;
+        }
+
+        /*!
+         * \brief Subscribes the client to the requested datapacks
+         *
+         * The function implements the subscribeDataPacks method of the EngineGrpcSubscriptionService.
+         * The requested datapacks are sent right away as the update of step 0. Afterwards, they are fetched after each
+         * loop step and sent to the client, tagged with the number of steps run since the subscription. Datapacks without new data are left out of the updates.
+         * The call returns when the client cancels it or the server is shut down.
+         *
+         * \param      context Pointer to gRPC server context structure
+         * \param[in]  request Pointer to protobuf request message. Contains metadata of subscribed datapacks.
+         * \param[out] writer  Stream to which datapack updates are written
+         *
+         * \return gRPC request status
+         */
+        grpc::Status subscribeDataPacks(      grpc::ServerContext                          * context,
+                                        const EngineGrpc::GetDataPacksRequest              * request,
+                                              grpc::ServerWriter<EngineGrpc::DataPackUpdate> * writer)
+        {
+            auto subscription = std::make_shared<DataPackSubscription>();
+            subscription->request = *request;
+
+            try
+            {
+                subscription->compression = requestedCompression(context);
+
+                // Steps can't run between fetching the initial datapacks and registering the subscription
+                DataPackReadLock lock(this->_engineCallLock, this->_engineWrapper->allowsConcurrentDataPackReads());
+
+                subscription->firstStep = this->_stepCount;
+
+                EngineGrpc::DataPackUpdate update;
+                update.set_step(0);
+                this->_engineWrapper->getUpdatedDataPacks(*request, update.mutable_datapacks());
+                subscription->push(update);
+
+                std::lock_guard<std::mutex> subscriptionsLock(this->_subscriptionsLock);
+                if(this->_subscriptionsClosed)
+                    return grpc::Status(grpc::StatusCode::UNAVAILABLE, "Engine server is shutting down");
+
+                this->_subscriptions.push_back(subscription);
+            }
+            catch(const std::exception &e)
+            {
+                return handleGrpcError("Error while executing subscribeDataPacks", e.what());
+            }
+
+            EngineGrpc::DataPackUpdate update;
+            while(subscription->pop(update, context))
+            {
+                compressDataPacks(subscription->compression, update.mutable_datapacks());
+
+                if(!writer->Write(update))
+                    break;
+            }
+
+            std::lock_guard<std::mutex> subscriptionsLock(this->_subscriptionsLock);
+            this->_subscriptions.remove(subscription);
+
+            std::lock_guard<std::mutex> subscriptionLock(subscription->lock);
+            if(!subscription->error.empty())
+                return handleGrpcError("Error while fetching subscribed datapacks", subscription->error);
+
+            return grpc::Status::OK;
+        }
+
+        /*!
+         * \brief Counts a completed loop step and pushes the subscribed datapacks to their clients
+         *
+         * Errors while fetching the datapacks of a subscription don't affect the step. The subscription is closed
+         * instead, and the error is returned to its client.
+         *
+         * Must be called while holding _engineCallLock exclusively
+         */
+        void pushDataPackUpdates()
+        {
+            ++this->_stepCount;
+
+            std::lock_guard<std::mutex> subscriptionsLock(this->_subscriptionsLock);
+            auto subscription = this->_subscriptions.begin();
+            while(subscription != this->_subscriptions.end())
+            {
+                try
+                {
+                    EngineGrpc::DataPackUpdate update;
+                    update.set_step(this->_stepCount - (*subscription)->firstStep);
+                    this->_engineWrapper->getUpdatedDataPacks((*subscription)->request, update.mutable_datapacks());
+                    (*subscription)->push(update);
+
+                    ++subscription;
+                }
+                catch(const std::exception &e)
+                {
+                    (*subscription)->close(e.what());
+                    subscription = this->_subscriptions.erase(subscription);
+                }
+            }
+        }
+
+        /*!
+         * \brief Closes all datapack subscriptions and refuses new ones
+         */
+        void closeSubscriptions()
+        {
+            std::lock_guard<std::mutex> subscriptionsLock(this->_subscriptionsLock);
+
+            this->_subscriptionsClosed = true;
+            for(auto & subscription : this->_subscriptions)
+                subscription->close();
+        }
+
+        /*!
+         * \brief Reads the datapack compression requested by the client in the metadata of a call
+         *
+         * \param[in] context Pointer to gRPC server context structure. Null for calls made through shared memory,
+         *                    whose datapacks are never compressed
+         *
+         * \return Requested compression. No compression if the client didn't request any
+         */
+        static DataPackCompression requestedCompression(const grpc::ServerContext * context)
+        {
+            DataPackCompression compression;
+            if(context == nullptr)
+                return compression;
+
+            const auto & metadata = context->client_metadata();
+
+            const auto codec = metadata.find(EngineGRPCConfigConst::DataPackCompressionKey.data());
+            if(codec != metadata.end())
+                compression.codec = protobuf_ops::compressionCodecFromName(std::string(codec->second.data(), codec->second.size()));
+
+            const auto threshold = metadata.find(EngineGRPCConfigConst::DataPackCompressionThresholdKey.data());
+            if(threshold != metadata.end())
+                compression.minCompressedSize = std::stoull(std::string(threshold->second.data(), threshold->second.size()));
+
+            return compression;
+        }
+
+        /*!
+         * \brief Compresses the datapacks of a reply. Datapacks smaller than the compression threshold are left as they are
+         *
+         * It runs after the engine call lock is released, so that compressing large datapacks doesn't delay other calls
+         */
+        static void compressDataPacks(const DataPackCompression & compression, EngineGrpc::GetDataPacksReply * reply)
+        {
+            if(compression.codec == EngineGrpc::COMPRESSION_NONE)
+                return;
+
+            for(auto & dataPack : *reply->mutable_datapacks())
+                protobuf_ops::compressDataPackMessage(&dataPack, compression.codec, compression.minCompressedSize);
+        }
+
         /*!
          * \brief Helper function for handling errors inside Remote Procedure Calls (RPCs)
          *
@@ -24,26 +24,38 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include <type_traits>
 
 #include <nlohmann/json.hpp>
 
 #include "nrp_protobuf/engine_grpc.pb.h"
-#include "nrp_general_library/engine_interfaces/datapack_controller.h"
+#include "nrp_protobuf/engine_grpc_fused.pb.h"
+#include "nrp_protobuf/engine_grpc_segments.pb.h"
+#include "nrp_protobuf/engine_grpc_unchanged.pb.h"
 #include "nrp_general_library/utils/time_utils.h"
 #include "nrp_protobuf/config/cmake_constants.h"
 #include "nrp_protobuf/proto_python_bindings/proto_field_ops.h"
+#include "nrp_protobuf/proto_ops/arena_datapack_controller.h"
+#include "nrp_protobuf/proto_ops/arena_pool.h"
 #include "nrp_protobuf/proto_ops/protobuf_ops.h"
 #include "nrp_protobuf/proto_ops/proto_ops_manager.h"
+#include "nrp_protobuf/proto_ops/segmented_message.h"
 
 
-using ProtoDataPackController = DataPackController<google::protobuf::Message>;
-
 /*!
  * \brief Abstract class defining an interface to interact with an Engine with data exchange via protobuf messages
  *
  * Derived classes are responsible
  * for implementing simulation initialization, shutdown and run step methods.
+ *
+ * Calls to each datapack controller are serialized. If the engine allows it (see allowsConcurrentDataPackReads()),
+ * datapacks handled by different controllers can also be fetched concurrently, e.g. by getDataPacks calls served in
+ * parallel. Registering datapacks must not happen concurrently with any other call.
+ *
+ * For controllers reporting a sequence number (see DataPackController::getDataPackSequence()), the sequence number of
+ * the data last sent is stored. As long as it doesn't change, an EngineGrpc::DataPackUnchanged marker is sent instead
+ * of the data. This assumes that all fetched datapacks are received by a single client.
  */
 class EngineProtoWrapper
 {
@@ -101,7 +113,16 @@ class EngineProtoWrapper
          */
         void registerDataPack(const std::string & datapackName, ProtoDataPackController *interface)
         {
-            this->_datapacksControllers.emplace(datapackName, interface);
+            auto registeredController = std::make_unique<RegisteredController>();
+            registeredController->controller = interface;
+
+            if(auto * arenaController = dynamic_cast<ArenaDataPackController *>(interface))
+            {
+                registeredController->arena = ArenaPool::createArena(64*1024);
+                arenaController->setArena(registeredController->arena.get());
+            }
+
+            this->_datapacksControllers.emplace(datapackName, std::move(registeredController));
         }
 
         // TODO used only in tests, try to remove it?
@@ -126,6 +147,15 @@ class EngineProtoWrapper
          */
         const std::string &getEngineName() { return _engineName; }
 
+        /*!
+         * \brief Indicates if datapacks handled by different controllers can be fetched concurrently
+         *
+         * Returns false by default, in which case servers don't run calls reading datapacks in parallel. Engines can
+         * override it to return true if none of their controllers share data without synchronization
+         */
+        virtual bool allowsConcurrentDataPackReads() const
+        { return false; }
+
 
     /*!
      * \brief Indicates if the simulation was initialized and is running
@@ -178,12 +208,14 @@ class EngineProtoWrapper
         const auto &devInterface = this->_datapacksControllers.find(name);
 
         if(devInterface != _datapacksControllers.end()) {
+            std::lock_guard<std::mutex> controllerLock(devInterface->second->lock);
+
             if(_handleDataPackMessage)
-                devInterface->second->handleDataPackData(dataPack);
+                devInterface->second->controller->handleDataPackData(dataPack);
             else {
                 auto protoMsg = unpackFromAny(dataPack.data());
                 if(protoMsg)
-                    devInterface->second->handleDataPackData(*protoMsg);
+                    devInterface->second->controller->handleDataPackData(*protoMsg);
                 else
                     throw NRPException::logCreate("In Engine \"" + this->getEngineName() + "\", unable to deserialize datapack \"" +
                                                   dataPack.datapackid().datapackname() + "\" using any of the NRP-Core Protobuf plugins" +
@@ -220,40 +252,126 @@ class EngineProtoWrapper
         }
     }
 
-    bool getDataPack(const std::string& name, EngineGrpc::DataPackMessage* dpMsg)
+    /*!
+     * \brief Gets the requested datapacks which have new data
+     *
+     * Same as getDataPacks, but datapacks without new data are left out of the reply instead of being sent empty
+     */
+    void getUpdatedDataPacks(const EngineGrpc::GetDataPacksRequest & request, EngineGrpc::GetDataPacksReply * reply)
+    {
+        getDataPacks(request, reply);
+
+        auto * dataPacks = reply->mutable_datapacks();
+        int numUpdated = 0;
+        for(int i = 0; i < dataPacks->size(); i++)
+        {
+            if(dataPacks->Get(i).has_data())
+                dataPacks->SwapElements(i, numUpdated++);
+        }
+
+        dataPacks->DeleteSubrange(numUpdated, dataPacks->size() - numUpdated);
+    }
+
+    /*!
+     * \brief Sets incoming datapacks, runs a single simulation loop step and gets the requested datapacks
+     *
+     * Server side of the fused step-and-exchange call. It is equivalent to calling setDataPacks, runLoopStep and
+     * getDataPacks in sequence, but requires a single request from the client.
+     *
+     * \param[in]  request Request containing the datapacks to set, the time step and the requested datapack ids
+     * \param[out] reply   Reply filled with the engine time after the step and the requested datapacks
+     */
+    void runLoopStepAndExchange(const EngineGrpc::RunLoopStepAndExchangeRequest & request,
+                                EngineGrpc::RunLoopStepAndExchangeReply * reply)
+    {
+        setDataPacks(request.setrequest());
+
+        reply->set_enginetime(runLoopStep(SimulationTime(request.timestep())).count());
+
+        getDataPacks(request.getrequest(), reply->mutable_getreply());
+    }
+
+    /*!
+     * \brief Gets the requested datapacks as segmented datapack messages
+     *
+     * Same as getDataPacks, but large fields of the datapack messages are sent as separate segments instead of being
+     * serialized into a google.protobuf.Any. See protobuf_ops::moveToSegmentedMessage
+     */
+    void getDataPacksSegmented(const EngineGrpc::GetDataPacksRequest & request, EngineGrpc::SegmentedGetDataPacksReply * reply)
+    {
+        const auto numDataPacks = request.datapackids_size();
+
+        for(int i = 0; i < numDataPacks; i++)
+        {
+            auto * protoDataPack = reply->add_datapacks();
+            getSegmentedDataPack(request.datapackids(i).datapackname(), protoDataPack);
+        }
+    }
+
+    /*!
+     * \brief Gets a datapack as a datapack message. The data is left empty if there is no new data
+     *
+     * \param[in]  name           Name of the datapack
+     * \param[out] dpMsg          Message filled with the datapack
+     * \param[in]  allowUnchanged If true and the data didn't change since it was last sent, the message contains an
+     *                            EngineGrpc::DataPackUnchanged marker. Must be false when the message isn't sent to the
+     *                            client which received the previous data, e.g. when it is published to several
+     *                            subscribers
+     *
+     * \return True if there was new or unchanged data, false otherwise
+     */
+    bool getDataPack(const std::string& name, EngineGrpc::DataPackMessage* dpMsg, bool allowUnchanged = true)
     {
         dpMsg->mutable_datapackid()->set_datapackname(name);
         dpMsg->mutable_datapackid()->set_enginename(this->_engineName);
 
-        // ask controller to fetch datapack data. nullptr means there is no new data available
-        const auto &devInterface = this->_datapacksControllers.find(name);
-        gpb::Message* data;
-        if(devInterface != _datapacksControllers.end())
-            data = devInterface->second->getDataPackInformation();
-        else {
-            const auto errorMessage = "DataPack " + name + " is not registered in engine " + this->_engineName;
-            throw std::invalid_argument(errorMessage);
-        }
         // set DataPackMessage data
-        if(data) {
-            setDataPackMessageData(data, dpMsg);
-            return true;
-        }
-        else
-            return false;
+        return fetchDataPackData(name, [&](gpb::Message & data) {
+            setDataPackMessageData(&data, dpMsg);
+        }, [&](const EngineGrpc::DataPackUnchanged & unchanged) {
+            dpMsg->mutable_data()->PackFrom(unchanged);
+        }, allowUnchanged);
+    }
+
+    /*!
+     * \brief Gets a datapack as a segmented datapack message. The data type is left empty if there is no new data
+     *
+     * If the data didn't change since it was last sent, the message contains an EngineGrpc::DataPackUnchanged marker
+     */
+    bool getSegmentedDataPack(const std::string& name, EngineGrpc::SegmentedDataPackMessage* dpMsg)
+    {
+        dpMsg->mutable_datapackid()->set_datapackname(name);
+        dpMsg->mutable_datapackid()->set_enginename(this->_engineName);
+
+        // The message is discarded afterwards, so its large fields can be moved into the reply
+        return fetchDataPackData(name, [&](gpb::Message & data) {
+            protobuf_ops::moveToSegmentedMessage(data, dpMsg);
+        }, [&](const EngineGrpc::DataPackUnchanged & unchanged) {
+            dpMsg->set_datatype(EngineGrpc::DataPackUnchanged::descriptor()->full_name());
+            unchanged.SerializeToString(dpMsg->mutable_data());
+        });
     }
 
 
+    /*!
+     * \brief Forgets the sequence numbers of the data last sent, e.g. after a reset. All datapacks are sent again
+     */
+    void resetDataPackSequences()
+    {
+        for(auto & registeredController : this->_datapacksControllers)
+        {
+            std::lock_guard<std::mutex> controllerLock(registeredController.second->lock);
+            registeredController.second->sentSequence = ProtoDataPackController::NoSequence;
+        }
+    }
+
     void setDataPackMessageData(gpb::Message* data, EngineGrpc::DataPackMessage* dpMsg)
     {
         bool isSet = false;
         for (auto &mod: _protoOps) {
-            try {
-                mod->setDataPackMessageData(*data, dpMsg);
+            if(mod->trySetDataPackMessageData(*data, dpMsg)) {
                 isSet = true;
-            }
-            catch (NRPException &) {
-                // this just means that the module couldn't process the request, try with the next one
+                break;
             }
         }
 
@@ -268,6 +386,63 @@ class EngineProtoWrapper
 
     protected:
 
+        /*!
+         * \brief Asks the controller of a datapack to fetch its data and processes it
+         *
+         * The controller is locked until the data has been processed, so that processData can use messages allocated
+         * in the controller's arena. If the sequence number reported by the controller is the one of the data last
+         * processed, the data isn't fetched and processUnchanged is called instead.
+         *
+         * \param[in] name             Name of the datapack
+         * \param[in] processData      Function called with the datapack data. It is not called if there is no new data
+         * \param[in] processUnchanged Function called with an EngineGrpc::DataPackUnchanged marker if the data didn't change
+         * \param[in] allowUnchanged   If false, the data is always fetched and the sequence number of the data last sent
+         *                             is left as is
+         *
+         * \return True if there was new or unchanged data, false otherwise
+         */
+        template<class FUNCTION, class UNCHANGED_FUNCTION>
+        bool fetchDataPackData(const std::string & name, FUNCTION && processData, UNCHANGED_FUNCTION && processUnchanged,
+                               bool allowUnchanged = true)
+        {
+            const auto &devInterface = this->_datapacksControllers.find(name);
+            if(devInterface == _datapacksControllers.end()) {
+                const auto errorMessage = "DataPack " + name + " is not registered in engine " + this->_engineName;
+                throw std::invalid_argument(errorMessage);
+            }
+
+            auto & registeredController = *(devInterface->second);
+            std::lock_guard<std::mutex> controllerLock(registeredController.lock);
+
+            const auto sequence = allowUnchanged ? registeredController.controller->getDataPackSequence() :
+                                  ProtoDataPackController::NoSequence;
+            if(sequence != ProtoDataPackController::NoSequence && sequence == registeredController.sentSequence)
+            {
+                EngineGrpc::DataPackUnchanged unchanged;
+                unchanged.set_sequence(sequence);
+
+                processUnchanged(unchanged);
+                return true;
+            }
+
+            // Messages allocated in the arena by previous calls have already been processed
+            if(registeredController.arena)
+                registeredController.arena->Reset();
+
+            auto * data = registeredController.controller->getDataPackInformation();
+            if(data == nullptr)
+                return false;
+
+            // Messages not allocated in an arena are owned by the caller of getDataPackInformation()
+            std::unique_ptr<gpb::Message> heapData(data->GetArena() == nullptr ? data : nullptr);
+
+            processData(*data);
+            if(allowUnchanged)
+                registeredController.sentSequence = sequence;
+
+            return true;
+        }
+
         void clearRegisteredDataPacks()
         {
             this->_datapacksControllers.clear();
@@ -278,7 +453,7 @@ class EngineProtoWrapper
         */
         ProtoDataPackController* getDataPackController(const std::string & datapackName)
         {
-            return this->_datapacksControllers.find(datapackName)->second;
+            return this->_datapacksControllers.find(datapackName)->second->controller;
         }
 
 
@@ -303,10 +478,33 @@ class EngineProtoWrapper
         std::string _engineName;
 
 
+        /*!
+         * \brief Datapack controller registered in the engine
+         */
+        struct RegisteredController
+        {
+            ProtoDataPackController * controller = nullptr;
+
+            /*!
+             * \brief Serializes calls to the controller
+             */
+            std::mutex lock;
+
+            /*!
+             * \brief Arena in which ArenaDataPackControllers allocate the messages returned by getDataPackInformation()
+             */
+            std::shared_ptr<google::protobuf::Arena> arena;
+
+            /*!
+             * \brief Sequence number of the data last sent, see DataPackController::getDataPackSequence()
+             */
+            uint64_t sentSequence = ProtoDataPackController::NoSequence;
+        };
+
         /*!
          * \brief Map of datapack names and datapack controllers used by the engine
          */
-         std::map<std::string, ProtoDataPackController*> _datapacksControllers;
+         std::map<std::string, std::unique_ptr<RegisteredController>> _datapacksControllers;
 
     protected:
         std::vector<std::unique_ptr<protobuf_ops::NRPProtobufOpsIface>> _protoOps;
@@ -0,0 +1,447 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_grpc_engine_protocol/shm_transport/shm_channel.h"
+#include "nrp_general_library/utils/nrp_exceptions.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+/*! \brief Identifies segments created by ShmChannel */
+static constexpr uint64_t SHM_CHANNEL_MAGIC = 0x3148434d53505254;
+
+/*! \brief Number of polls of a futex word before going to sleep on it */
+static constexpr int SHM_CHANNEL_SPIN_COUNT = 2000;
+
+/*! \brief Maximum sleep on a futex word before checking that the other process is alive */
+static constexpr std::chrono::milliseconds SHM_CHANNEL_PEER_CHECK_PERIOD(100);
+
+/*!
+ * \brief Ring buffer control block. Positions are the total number of bytes written and read
+ */
+struct ShmChannel::Ring
+{
+    alignas(64) std::atomic<uint64_t> writePos;
+    std::atomic<uint32_t> dataSeq;   // Incremented by the writer after every write
+    alignas(64) std::atomic<uint64_t> readPos;
+    std::atomic<uint32_t> spaceSeq;  // Incremented by the reader after every read
+};
+
+/*!
+ * \brief Header of the shared memory segment. The data of the two rings follows it
+ */
+struct ShmChannel::Segment
+{
+    uint64_t magic;
+    uint64_t capacity;
+    std::atomic<int32_t>  clientPid;
+    std::atomic<int32_t>  serverPid;
+    std::atomic<uint32_t> serverSeq;  // Incremented when the server attaches
+    Ring rings[2];                    // Requests from client to server, and replies from server to client
+};
+
+/*!
+ * \brief Header of the messages sent through the channel
+ */
+struct ShmMessageHeader
+{
+    uint32_t tag;
+    uint32_t callId;
+    uint64_t size;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "ShmChannel requires address-free atomics");
+
+
+static void futexWait(std::atomic<uint32_t> &word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    const timespec ts { static_cast<time_t>(seconds.count()), static_cast<long>((timeout - seconds).count()) };
+
+    // Not FUTEX_PRIVATE_FLAG, the word is shared with another process
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+}
+
+
+static void futexWake(std::atomic<uint32_t> &word)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+
+ShmChannel::ShmChannel(const std::string &name, int fd, size_t segmentSize, bool isCreator)
+    : _name(name),
+      _fd(fd),
+      _segmentSize(segmentSize),
+      _isCreator(isCreator)
+{
+    void *map = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(map == MAP_FAILED)
+    {
+        close(fd);
+        if(isCreator)
+            shm_unlink(name.c_str());
+
+        throw NRPException::logCreate("Failed to map shared memory segment \"" + name + "\": " + std::strerror(errno));
+    }
+
+    // A new segment is zero-filled, constructing the header only initializes the atomics
+    this->_segment = isCreator ? new (map) Segment() : static_cast<Segment *>(map);
+
+    const size_t dataOffset = (sizeof(Segment) + 63) & ~size_t(63);
+    char *data = static_cast<char *>(map) + dataOffset;
+
+    // The client writes requests into the first ring and reads replies from the second one, the server does the opposite
+    const int outIndex = isCreator ? 0 : 1;
+    this->_outRing = &this->_segment->rings[outIndex];
+    this->_inRing  = &this->_segment->rings[1 - outIndex];
+
+    if(isCreator)
+    {
+        const size_t capacity = (segmentSize - dataOffset) / 2;
+        this->_segment->capacity = capacity;
+        this->_segment->clientPid.store(getpid());
+        this->_segment->magic = SHM_CHANNEL_MAGIC;
+    }
+
+    this->_outData = data + outIndex * this->_segment->capacity;
+    this->_inData  = data + (1 - outIndex) * this->_segment->capacity;
+}
+
+
+ShmChannel::~ShmChannel()
+{
+    munmap(this->_segment, this->_segmentSize);
+    close(this->_fd);
+
+    if(this->_isCreator)
+        shm_unlink(this->_name.c_str());
+}
+
+
+std::string ShmChannel::segmentName(const std::string &serverAddress)
+{
+    std::string name = "/nrp_grpc_" + serverAddress;
+    std::replace_if(name.begin() + 1, name.end(), [] (char c) { return !std::isalnum(static_cast<unsigned char>(c)); }, '_');
+
+    return name;
+}
+
+
+ShmChannel::unique_ptr ShmChannel::create(const std::string &name, size_t capacity)
+{
+    // Remove the segment possibly left by a client which didn't exit cleanly
+    shm_unlink(name.c_str());
+
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if(fd < 0)
+        throw NRPException::logCreate("Failed to create shared memory segment \"" + name + "\": " + std::strerror(errno));
+
+    const size_t dataOffset  = (sizeof(Segment) + 63) & ~size_t(63);
+    const size_t segmentSize = dataOffset + 2 * capacity;
+
+    if(ftruncate(fd, static_cast<off_t>(segmentSize)) != 0)
+    {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw NRPException::logCreate("Failed to allocate shared memory segment \"" + name + "\": " + std::strerror(errno));
+    }
+
+    return ShmChannel::unique_ptr(new ShmChannel(name, fd, segmentSize, true));
+}
+
+
+ShmChannel::unique_ptr ShmChannel::open(const std::string &name)
+{
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if(fd < 0)
+    {
+        if(errno == ENOENT)
+            return nullptr;
+
+        throw NRPException::logCreate("Failed to open shared memory segment \"" + name + "\": " + std::strerror(errno));
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Segment))
+    {
+        close(fd);
+        throw NRPException::logCreate("Shared memory segment \"" + name + "\" is invalid");
+    }
+
+    ShmChannel::unique_ptr channel(new ShmChannel(name, fd, static_cast<size_t>(st.st_size), false));
+    if(channel->_segment->magic != SHM_CHANNEL_MAGIC)
+        throw NRPException::logCreate("Shared memory segment \"" + name + "\" wasn't created by an NRP engine client");
+
+    channel->_segment->serverPid.store(getpid());
+    channel->_segment->serverSeq.fetch_add(1);
+    futexWake(channel->_segment->serverSeq);
+
+    return channel;
+}
+
+
+bool ShmChannel::waitForServer(duration_t timeout) const
+{
+    const auto deadline = clock_t::now() + timeout;
+
+    while(this->_segment->serverPid.load() == 0)
+    {
+        const uint32_t seq = this->_segment->serverSeq.load();
+        if(this->_segment->serverPid.load() != 0)
+            break;
+
+        const auto remaining = deadline - clock_t::now();
+        if(remaining <= duration_t::zero())
+            return false;
+
+        futexWait(this->_segment->serverSeq, seq, std::min<duration_t>(remaining, SHM_CHANNEL_PEER_CHECK_PERIOD));
+    }
+
+    return true;
+}
+
+
+void ShmChannel::send(uint32_t tag, const std::string &payload, uint32_t callId)
+{
+    const ShmMessageHeader header { tag, callId, payload.size() };
+
+    this->write(&header, sizeof(header));
+    this->write(payload.data(), payload.size());
+}
+
+
+bool ShmChannel::receive(uint32_t &tag, std::string &payload, duration_t timeout, uint32_t *callId)
+{
+    const auto deadline = clock_t::now() + timeout;
+
+    ShmMessageHeader header;
+    if(!this->read(&header, sizeof(header), timeout > duration_t::zero() ? &deadline : nullptr))
+        return false;
+
+    tag = header.tag;
+    if(callId != nullptr)
+        *callId = header.callId;
+
+    payload.resize(header.size);
+    this->read(payload.data(), header.size, nullptr);
+
+    return true;
+}
+
+
+bool ShmChannel::call(uint32_t requestTag, const std::string &request, uint32_t &replyTag, std::string &reply,
+                      duration_t timeout)
+{
+    std::lock_guard<std::mutex> lock(this->_callMutex);
+
+    const uint32_t callId = ++this->_lastCallId;
+    this->send(requestTag, request, callId);
+
+    const auto deadline = clock_t::now() + timeout;
+    uint32_t replyId;
+    do
+    {
+        duration_t remaining = duration_t::zero();
+        if(timeout > duration_t::zero())
+        {
+            remaining = deadline - clock_t::now();
+            if(remaining <= duration_t::zero())
+                return false;
+        }
+
+        if(!this->receive(replyTag, reply, remaining, &replyId))
+            return false;
+    }
+    // Late replies to previous calls which timed out are discarded
+    while(replyId != callId);
+
+    return true;
+}
+
+
+void ShmChannel::interrupt()
+{
+    this->_isInterrupted = true;
+
+    futexWake(this->_inRing->dataSeq);
+    futexWake(this->_outRing->spaceSeq);
+}
+
+
+void ShmChannel::write(const void *data, size_t size)
+{
+    const char *src = static_cast<const char *>(data);
+    const size_t capacity = this->_segment->capacity;
+
+    while(size > 0)
+    {
+        const uint32_t seq = this->_outRing->spaceSeq.load(std::memory_order_acquire);
+        const uint64_t writePos = this->_outRing->writePos.load(std::memory_order_relaxed);
+        const uint64_t readPos  = this->_outRing->readPos.load(std::memory_order_acquire);
+
+        const size_t freeSpace = capacity - static_cast<size_t>(writePos - readPos);
+        if(freeSpace == 0)
+        {
+            if(this->_isInterrupted)
+                throw NRPException::logCreate("Shared memory channel \"" + this->_name + "\" was interrupted while sending");
+
+            this->wait(this->_outRing->spaceSeq, seq, nullptr);
+            continue;
+        }
+
+        const size_t count  = std::min(freeSpace, size);
+        const size_t offset = static_cast<size_t>(writePos % capacity);
+        const size_t first  = std::min(count, capacity - offset);
+
+        std::memcpy(this->_outData + offset, src, first);
+        std::memcpy(this->_outData, src + first, count - first);
+
+        this->_outRing->writePos.store(writePos + count, std::memory_order_release);
+        this->_outRing->dataSeq.fetch_add(1, std::memory_order_release);
+        futexWake(this->_outRing->dataSeq);
+
+        src  += count;
+        size -= count;
+    }
+}
+
+
+bool ShmChannel::read(void *data, size_t size, const clock_t::time_point *deadline)
+{
+    char *dst = static_cast<char *>(data);
+    const size_t capacity = this->_segment->capacity;
+    bool hasStarted = false;
+
+    while(size > 0)
+    {
+        const uint32_t seq = this->_inRing->dataSeq.load(std::memory_order_acquire);
+        const uint64_t readPos  = this->_inRing->readPos.load(std::memory_order_relaxed);
+        const uint64_t writePos = this->_inRing->writePos.load(std::memory_order_acquire);
+
+        const size_t available = static_cast<size_t>(writePos - readPos);
+        if(available == 0)
+        {
+            if(!hasStarted && (this->_isInterrupted || (deadline != nullptr && clock_t::now() >= *deadline)))
+                return false;
+
+            if(this->_isInterrupted)
+                throw NRPException::logCreate("Shared memory channel \"" + this->_name + "\" was interrupted while receiving");
+
+            this->wait(this->_inRing->dataSeq, seq, hasStarted ? nullptr : deadline);
+            continue;
+        }
+
+        const size_t count  = std::min(available, size);
+        const size_t offset = static_cast<size_t>(readPos % capacity);
+        const size_t first  = std::min(count, capacity - offset);
+
+        std::memcpy(dst, this->_inData + offset, first);
+        std::memcpy(dst + first, this->_inData, count - first);
+
+        this->_inRing->readPos.store(readPos + count, std::memory_order_release);
+        this->_inRing->spaceSeq.fetch_add(1, std::memory_order_release);
+        futexWake(this->_inRing->spaceSeq);
+
+        dst  += count;
+        size -= count;
+        hasStarted = true;
+    }
+
+    return true;
+}
+
+
+void ShmChannel::wait(std::atomic<uint32_t> &word, uint32_t expected, const clock_t::time_point *deadline) const
+{
+    for(int i = 0; i < SHM_CHANNEL_SPIN_COUNT; ++i)
+    {
+        if(word.load(std::memory_order_acquire) != expected)
+            return;
+    }
+
+    while(word.load(std::memory_order_acquire) == expected && !this->_isInterrupted)
+    {
+        duration_t sleep = SHM_CHANNEL_PEER_CHECK_PERIOD;
+        if(deadline != nullptr)
+        {
+            const auto remaining = *deadline - clock_t::now();
+            if(remaining <= duration_t::zero())
+                return;
+
+            sleep = std::min<duration_t>(sleep, remaining);
+        }
+
+        futexWait(word, expected, sleep);
+        this->checkPeer(word, expected);
+    }
+}
+
+
+/*!
+ * \brief Checks whether a process has exited, including processes which haven't been reaped by their parent yet
+ */
+static bool processHasExited(pid_t pid)
+{
+    if(kill(pid, 0) != 0)
+        return errno == ESRCH;
+
+    // kill() succeeds on zombies, e.g. an engine server which crashed and hasn't been reaped by its launcher yet
+    std::ifstream statFile("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    if(!std::getline(statFile, stat))
+        return false;
+
+    // The state follows the command name, which is enclosed in parentheses and can contain any character
+    const auto commandEnd = stat.rfind(')');
+    if(commandEnd == std::string::npos || commandEnd + 2 >= stat.size())
+        return false;
+
+    const char state = stat[commandEnd + 2];
+    return state == 'Z' || state == 'X';
+}
+
+
+void ShmChannel::checkPeer(const std::atomic<uint32_t> &word, uint32_t expected) const
+{
+    const pid_t peer = this->_isCreator ? this->_segment->serverPid.load() : this->_segment->clientPid.load();
+
+    // The word is checked after the process, which may have written to the channel right before exiting
+    if(peer != 0 && processHasExited(peer) && word.load(std::memory_order_acquire) == expected)
+        throw NRPException::logCreate("Process on the other side of shared memory channel \"" + this->_name + "\" has exited");
+}
+
+// EOF
@@ -0,0 +1,190 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "nrp_general_library/utils/ptr_templates.h"
+
+/*!
+ * \brief Bidirectional message channel between two processes on the same host, based on POSIX shared memory
+ *
+ * The channel consists of two single-producer single-consumer byte ring buffers stored in a shared memory segment,
+ * one for requests (client to server) and one for replies (server to client). Messages are framed as a tag and a
+ * payload. Messages larger than the ring capacity are streamed through it, as long as the other side reads
+ * concurrently.
+ *
+ * Waiting sides spin briefly and then sleep on a futex stored in the segment, which is woken up by the other side
+ * after every write or read.
+ *
+ * The segment is created by the client, which also removes it when the channel is destroyed. The server opens the
+ * existing segment and announces itself by writing its process id into it.
+ */
+class ShmChannel
+        : public PtrTemplates<ShmChannel>
+{
+    public:
+
+        using clock_t    = std::chrono::steady_clock;
+        using duration_t = std::chrono::nanoseconds;
+
+        ~ShmChannel();
+
+        ShmChannel(const ShmChannel &) = delete;
+        ShmChannel &operator=(const ShmChannel &) = delete;
+
+        /*!
+         * \brief Returns the name of the shared memory segment used by the engine server with the given address
+         */
+        static std::string segmentName(const std::string &serverAddress);
+
+        /*!
+         * \brief Creates a new segment, replacing any stale segment with the same name. Used by the client
+         *
+         * \param name     Name of the shared memory segment
+         * \param capacity Capacity in bytes of each ring buffer
+         */
+        static ShmChannel::unique_ptr create(const std::string &name, size_t capacity);
+
+        /*!
+         * \brief Opens an existing segment and marks the server as attached. Used by the server
+         *
+         * \return The channel, or nullptr if no segment with the given name exists
+         */
+        static ShmChannel::unique_ptr open(const std::string &name);
+
+        /*!
+         * \brief Waits until a server has attached to the channel
+         *
+         * \return False on timeout
+         */
+        bool waitForServer(duration_t timeout) const;
+
+        /*!
+         * \brief Sends a message to the other side of the channel
+         *
+         * \param tag     Tag of the message, e.g. a method id or a status code
+         * \param payload Message payload
+         * \param callId  Id of the call the message belongs to. Replies carry the id of their request
+         */
+        void send(uint32_t tag, const std::string &payload, uint32_t callId = 0);
+
+        /*!
+         * \brief Receives a message from the other side of the channel
+         *
+         * Timeouts only apply while waiting for the beginning of a message. Once a message has started, it is always
+         * received completely, unless the other process exits.
+         *
+         * \param[out] tag     Tag of the message
+         * \param[out] payload Message payload
+         * \param[in]  timeout Maximum time to wait for a message. If zero or negative, waits indefinitely
+         * \param[out] callId  If not null, set to the id of the call the message belongs to
+         *
+         * \return False on timeout or if interrupt() was called
+         */
+        bool receive(uint32_t &tag, std::string &payload, duration_t timeout = duration_t::zero(),
+                     uint32_t *callId = nullptr);
+
+        /*!
+         * \brief Sends a request and waits for its reply. Thread-safe, used by the client
+         *
+         * Every call is sent with a new call id. Replies with other ids, i.e. replies to earlier calls which timed out,
+         * are discarded. The channel thus stays usable after a timeout, as long as the server replies with the id of
+         * each request
+         *
+         * \return False if the reply wasn't received in time
+         */
+        bool call(uint32_t requestTag, const std::string &request, uint32_t &replyTag, std::string &reply,
+                  duration_t timeout = duration_t::zero());
+
+        /*!
+         * \brief Wakes up and aborts a pending receive() call of this process
+         */
+        void interrupt();
+
+    private:
+
+        struct Segment;
+        struct Ring;
+
+        ShmChannel(const std::string &name, int fd, size_t segmentSize, bool isCreator);
+
+        /*!
+         * \brief Copies bytes into the outgoing ring buffer, waiting for free space as needed
+         */
+        void write(const void *data, size_t size);
+
+        /*!
+         * \brief Copies bytes from the incoming ring buffer, waiting for data as needed
+         *
+         * \return False if the deadline was reached before any byte was read
+         */
+        bool read(void *data, size_t size, const clock_t::time_point *deadline);
+
+        /*!
+         * \brief Waits until the futex word differs from expected, the deadline is reached or the channel is interrupted
+         *
+         * Throws if the process on the other side of the channel has exited
+         */
+        void wait(std::atomic<uint32_t> &word, uint32_t expected, const clock_t::time_point *deadline) const;
+
+        /*!
+         * \brief Throws if the process on the other side of the channel has exited, even if it hasn't been reaped yet,
+         * and the futex word still has the expected value
+         */
+        void checkPeer(const std::atomic<uint32_t> &word, uint32_t expected) const;
+
+        std::string _name;
+        int         _fd;
+        size_t      _segmentSize;
+        bool        _isCreator;
+        Segment    *_segment;
+
+        Ring *_outRing;
+        Ring *_inRing;
+        char *_outData;
+        char *_inData;
+
+        std::atomic<bool> _isInterrupted = false;
+
+        /*!
+         * \brief Serializes calls made by different client threads
+         */
+        std::mutex _callMutex;
+
+        /*!
+         * \brief Id of the last call made by the client. Guarded by _callMutex
+         */
+        uint32_t _lastCallId = 0;
+};
+
+using ShmChannelUniquePtr = ShmChannel::unique_ptr;
+
+#endif // SHM_CHANNEL_H
+
+// EOF
@@ -0,0 +1,144 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "nrp_protobuf/engine_grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_segments.pb.h"
+#include "nrp_protobuf/gazebo.pb.h"
+#include "nrp_protobuf/proto_ops/segmented_message.h"
+
+using namespace std::chrono;
+
+namespace
+{
+    constexpr unsigned IMAGE_WIDTH  = 1920;
+    constexpr unsigned IMAGE_HEIGHT = 1080;
+    constexpr unsigned IMAGE_DEPTH  = 3;
+    constexpr int      ITERATIONS   = 50;
+
+    /*!
+     * \brief Creates a camera message as returned by a datapack controller
+     */
+    std::unique_ptr<Gazebo::Camera> createCamera(const std::string &image)
+    {
+        auto camera = std::make_unique<Gazebo::Camera>();
+        camera->set_imagewidth(IMAGE_WIDTH);
+        camera->set_imageheight(IMAGE_HEIGHT);
+        camera->set_imagedepth(IMAGE_DEPTH);
+        camera->set_imagedata(image);
+
+        return camera;
+    }
+
+    /*!
+     * \brief Server to client transfer of a camera datapack using DataPackMessage
+     */
+    std::unique_ptr<Gazebo::Camera> transferAny(std::unique_ptr<Gazebo::Camera> camera, std::string &wire)
+    {
+        EngineGrpc::GetDataPacksReply serverReply;
+        serverReply.add_datapacks()->mutable_data()->PackFrom(*camera);
+        serverReply.SerializeToString(&wire);
+
+        EngineGrpc::GetDataPacksReply clientReply;
+        clientReply.ParseFromString(wire);
+
+        auto received = std::make_unique<Gazebo::Camera>();
+        clientReply.datapacks(0).data().UnpackTo(received.get());
+
+        return received;
+    }
+
+    /*!
+     * \brief Server to client transfer of a camera datapack using SegmentedDataPackMessage
+     */
+    std::unique_ptr<Gazebo::Camera> transferSegmented(std::unique_ptr<Gazebo::Camera> camera, std::string &wire)
+    {
+        EngineGrpc::SegmentedGetDataPacksReply serverReply;
+        protobuf_ops::moveToSegmentedMessage(*camera, serverReply.add_datapacks());
+        serverReply.SerializeToString(&wire);
+
+        EngineGrpc::SegmentedGetDataPacksReply clientReply;
+        clientReply.ParseFromString(wire);
+
+        auto received = std::make_unique<Gazebo::Camera>();
+        protobuf_ops::moveFromSegmentedMessage(*clientReply.mutable_datapacks(0), received.get());
+
+        return received;
+    }
+
+    template<class TRANSFER>
+    double benchmark(const std::string &image, TRANSFER &&transfer)
+    {
+        std::string wire;
+        duration<double, std::milli> total(0);
+
+        for(int i = 0; i < ITERATIONS; ++i)
+        {
+            // Creating the controller message isn't part of the transfer
+            auto camera = createCamera(image);
+
+            const auto start = steady_clock::now();
+            const auto received = transfer(std::move(camera), wire);
+            total += steady_clock::now() - start;
+
+            if(received->imagewidth() != IMAGE_WIDTH || received->imagedata().size() != image.size())
+                std::abort();
+        }
+
+        return total.count() / ITERATIONS;
+    }
+}
+
+/*!
+ * \brief Compares the serialization and parsing of a 1080p camera datapack with both datapack envelopes
+ *
+ * The time reported for each envelope includes the serialization of the reply in the server and its parsing in
+ * the client, excluding the gRPC transport. The benchmark isn't part of the test suite, it must be run manually.
+ */
+int main()
+{
+    std::string image(IMAGE_WIDTH*IMAGE_HEIGHT*IMAGE_DEPTH, 0);
+    for(size_t i = 0; i < image.size(); ++i)
+        image[i] = static_cast<char>(i*31);
+
+    // The segmented envelope must deliver the same data
+    std::string wire;
+    if(transferSegmented(createCamera(image), wire)->imagedata() != image)
+    {
+        std::cerr << "SegmentedDataPackMessage didn't deliver the camera image\n";
+        return EXIT_FAILURE;
+    }
+
+    const double anyTime       = benchmark(image, transferAny);
+    const double segmentedTime = benchmark(image, transferSegmented);
+
+    std::cout << "1080p camera datapack (" << image.size() << " bytes), mean of " << ITERATIONS << " transfers:\n"
+              << "  DataPackMessage:          " << anyTime << " ms\n"
+              << "  SegmentedDataPackMessage: " << segmentedTime << " ms\n";
+
+    return EXIT_SUCCESS;
+}
+
+// EOF
@@ -20,6 +20,7 @@
 // Agreement No. 945539 (Human Brain Project SGA3).
 //
 
+#include <atomic>
 #include <iostream>
 
 #include <gtest/gtest.h>
@@ -30,6 +31,8 @@
 #include "nrp_grpc_engine_protocol/engine_client/engine_grpc_client.h"
 #include "nrp_protobuf/engine_grpc.grpc.pb.h"
 #include "nrp_protobuf/enginetest.pb.h"
+#include "nrp_protobuf/gazebo.pb.h"
+#include "nrp_protobuf/proto_ops/segmented_message.h"
 
 
 
@@ -78,6 +81,128 @@ class TestGrpcDataPackController
         bool _returnEmptyDataPack = false;
 };
 
+class TestArenaDataPackController
+        : public ArenaDataPackController
+{
+    public:
+
+        void handleDataPackData(const google::protobuf::Message &) override
+        {}
+
+        google::protobuf::Message *getDataPackInformation() override
+        {
+            if(this->_doThrow)
+            {
+                this->_doThrow = false;
+                throw std::runtime_error("Fetch failed");
+            }
+
+            auto data = this->createMessage<EngineTest::TestPayload>();
+            data->set_integer(++this->_counter);
+
+            return data;
+        }
+
+        void throwOnNextFetch()
+        {
+            this->_doThrow = true;
+        }
+
+    private:
+
+        int _counter = 0;
+        bool _doThrow = false;
+};
+
+class TestSequenceDataPackController
+        : public ProtoDataPackController
+{
+    public:
+
+        void handleDataPackData(const google::protobuf::Message &) override
+        {}
+
+        google::protobuf::Message *getDataPackInformation() override
+        {
+            ++this->fetchCount;
+
+            auto data = new EngineTest::TestPayload();
+            data->set_integer(this->value);
+
+            return data;
+        }
+
+        uint64_t getDataPackSequence() override
+        {
+            return this->sequence;
+        }
+
+        int      value      = 1;
+        uint64_t sequence   = 1;
+        int      fetchCount = 0;
+};
+
+class TestCameraDataPackController
+        : public ArenaDataPackController
+{
+    public:
+
+        void handleDataPackData(const google::protobuf::Message &) override
+        {}
+
+        google::protobuf::Message *getDataPackInformation() override
+        {
+            auto data = this->createMessage<Gazebo::Camera>();
+            data->set_imagewidth(320);
+            data->set_imageheight(240);
+            data->set_imagedepth(3);
+            data->set_imagedata(std::string(320*240*3, static_cast<char>(++this->_counter)));
+
+            return data;
+        }
+
+    private:
+
+        int _counter = 0;
+};
+
+/*!
+ * \brief Controller which takes some time to fetch its data, recording how many controllers are called concurrently
+ */
+class TestSlowDataPackController
+        : public DataPackController<google::protobuf::Message>
+{
+    public:
+
+        TestSlowDataPackController(std::atomic<int> &activeCalls, std::atomic<int> &maxActiveCalls)
+            : _activeCalls(activeCalls),
+              _maxActiveCalls(maxActiveCalls)
+        { }
+
+        void handleDataPackData(const google::protobuf::Message &) override
+        {}
+
+        google::protobuf::Message *getDataPackInformation() override
+        {
+            const int active = ++this->_activeCalls;
+            int maxActive = this->_maxActiveCalls;
+            while(active > maxActive && !this->_maxActiveCalls.compare_exchange_weak(maxActive, active));
+
+            testSleep(200);
+            --this->_activeCalls;
+
+            auto data = new EngineTest::TestPayload();
+            data->set_integer(active);
+
+            return data;
+        }
+
+    private:
+
+        std::atomic<int> &_activeCalls;
+        std::atomic<int> &_maxActiveCalls;
+};
+
 struct TestEngineGRPCConfigConst
 {
     static constexpr char EngineType[] = "test_engine";
@@ -185,6 +310,13 @@ class TestEngine
 
         virtual bool shutdownFlag() const override { return false; }
 
+        bool allowsConcurrentDataPackReads() const override { return this->_concurrentReads; }
+
+        void setConcurrentDataPackReads(bool concurrentReads)
+        {
+            this->_concurrentReads = concurrentReads;
+        }
+
     private:
 
         void specialBehaviour()
@@ -199,6 +331,49 @@ class TestEngine
         SimulationTime _time = SimulationTime::zero();
         int            _sleepTimeMs = 0;
         bool _doThrow = false;
+        bool _concurrentReads = false;
+};
+
+/*!
+ * \brief Controller whose data changes when the engine steps or when data is written to it, like the Gazebo controllers
+ */
+class TestStepSequenceDataPackController
+        : public ProtoDataPackController
+{
+    public:
+
+        explicit TestStepSequenceDataPackController(TestEngine &engine)
+            : _engine(engine)
+        {}
+
+        void handleDataPackData(const google::protobuf::Message &data) override
+        {
+            this->_value = dynamic_cast<const EngineTest::TestPayload &>(data).integer();
+            this->_sequence.modified();
+        }
+
+        google::protobuf::Message *getDataPackInformation() override
+        {
+            ++this->fetchCount;
+
+            auto data = new EngineTest::TestPayload();
+            data->set_integer(this->_value);
+
+            return data;
+        }
+
+        uint64_t getDataPackSequence() override
+        {
+            return this->_sequence.update(static_cast<uint64_t>(this->_engine.getEngineTime().count()));
+        }
+
+        int fetchCount = 0;
+
+    private:
+
+        TestEngine &_engine;
+        int _value = 1;
+        DataPackStepSequence _sequence;
 };
 
 TEST(EngineGrpc, Connection)
@@ -701,4 +876,682 @@ TEST(EngineGrpc, GetDataPackData2)
     }*/
 }
 
+TEST(EngineGrpc, RunLoopStepAndExchange)
+{
+    const std::string datapackName = "a";
+    const std::string datapackType = "b";
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest"});
+    config["FusedStepExchange"] = true;
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    std::shared_ptr<TestGrpcDataPackController> datapackController(new TestGrpcDataPackController()); // Server side
+    engineWrapper->registerDataPack(datapackName, datapackController.get());
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier(datapackName, engineName, datapackType));
+
+    server.startServer();
+    testSleep(1500);
+
+    // The first request of datapacks is done with a separate call
+
+    auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+    ASSERT_EQ(output.size(), 1);
+
+    // Sent datapacks are buffered in the client until the next step
+
+    auto d = new EngineTest::TestPayload();
+    d->set_integer(111);
+    datapacks_set_t input_datapacks;
+    input_datapacks.insert(generateDataPack(datapackName, engineName, d));
+
+    client.sendDataPacksToEngine(input_datapacks);
+
+    d = dynamic_cast<EngineTest::TestPayload *>(datapackController->getDataPackInformation());
+    ASSERT_EQ(d->integer(), 0);
+
+    // The step sets the buffered datapacks and fetches the datapacks requested previously
+
+    SimulationTime timeStep = floatToSimulationTime(1.0f);
+    ASSERT_EQ(client.runLoopStepCallback(timeStep), timeStep);
+
+    d = dynamic_cast<EngineTest::TestPayload *>(datapackController->getDataPackInformation());
+    ASSERT_EQ(d->integer(), 111);
+
+    // Fetched datapacks contain the data set before running the step
+
+    output = client.getDataPacksFromEngine(datapackIdentifiers);
+
+    ASSERT_EQ(output.size(), 1);
+    ASSERT_EQ(output.begin()->get()->name(),       datapackName);
+    ASSERT_EQ(output.begin()->get()->engineName(), engineName);
+    ASSERT_EQ(output.begin()->get()->isEmpty(),    false);
+    ASSERT_EQ(dynamic_cast<const DataPack<EngineTest::TestPayload> *>(output.begin()->get())->getData().integer(), 111);
+
+    // Engine time is validated as with runLoopStep
+
+    timeStep = floatToSimulationTime(-2.0f);
+    ASSERT_THROW(client.runLoopStepCallback(timeStep), std::runtime_error);
+
+    // Datapacks still buffered are sent before any call which isn't a step
+
+    d = new EngineTest::TestPayload();
+    d->set_integer(222);
+    input_datapacks.clear();
+    input_datapacks.insert(generateDataPack(datapackName, engineName, d));
+
+    client.sendDataPacksToEngine(input_datapacks);
+    client.reset();
+
+    d = dynamic_cast<EngineTest::TestPayload *>(datapackController->getDataPackInformation());
+    ASSERT_EQ(d->integer(), 222);
+
+    d = new EngineTest::TestPayload();
+    d->set_integer(333);
+    input_datapacks.clear();
+    input_datapacks.insert(generateDataPack(datapackName, engineName, d));
+
+    client.sendDataPacksToEngine(input_datapacks);
+    client.shutdown();
+
+    d = dynamic_cast<EngineTest::TestPayload *>(datapackController->getDataPackInformation());
+    ASSERT_EQ(d->integer(), 333);
+}
+
+TEST(EngineGrpc, AsyncClientMode)
+{
+    const std::string datapackName = "a";
+    const std::string datapackType = "b";
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest"});
+    config["GrpcClientMode"] = "async";
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    std::shared_ptr<TestGrpcDataPackController> datapackController(new TestGrpcDataPackController()); // Server side
+    engineWrapper->registerDataPack(datapackName, datapackController.get());
+
+    server.startServer();
+    testSleep(1500);
+
+    // Steps are completed by the driver thread, which notifies their completion
+
+    std::atomic<int> numCompletedSteps = 0;
+    client.setStepCompletionCallback([&numCompletedSteps] (const EngineClientInterface *) { ++numCompletedSteps; });
+
+    const SimulationTime timeStep = floatToSimulationTime(1.0f);
+    client.runLoopStepAsync(timeStep);
+    ASSERT_THROW(client.runLoopStepAsync(timeStep), NRPException);
+    ASSERT_NO_THROW(client.runLoopStepAsyncGet(SimulationTime::zero()));
+
+    ASSERT_EQ(client.getEngineTime(), timeStep);
+    ASSERT_EQ(numCompletedSteps, 1);
+
+    // Delayed step times out
+
+    engineWrapper->timeoutOnNextCommand(1500);
+    client.runLoopStepAsync(timeStep);
+    ASSERT_THROW(client.runLoopStepAsyncGet(floatToSimulationTime(0.5f)), NRPException);
+    ASSERT_NO_THROW(client.runLoopStepAsyncGet(SimulationTime::zero()));
+    ASSERT_EQ(client.getEngineTime(), timeStep + timeStep);
+
+    // Datapacks are exchanged through the driver as well
+
+    auto d = new EngineTest::TestPayload();
+    d->set_integer(111);
+    datapacks_set_t input_datapacks;
+    input_datapacks.insert(generateDataPack(datapackName, engineName, d));
+
+    client.sendDataPacksToEngine(input_datapacks);
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier(datapackName, engineName, datapackType));
+
+    const auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+
+    ASSERT_EQ(output.size(), 1);
+    ASSERT_EQ(dynamic_cast<const DataPack<EngineTest::TestPayload> *>(output.begin()->get())->getData().integer(), 111);
+}
+
+TEST(EngineGrpc, ArenaAllocation)
+{
+    // Arenas are only reused once all their messages are released
+
+    ArenaPool pool(1024, 2);
+
+    auto arena1 = pool.acquire();
+    auto message = std::shared_ptr<EngineTest::TestPayload>(arena1, google::protobuf::Arena::CreateMessage<EngineTest::TestPayload>(arena1.get()));
+    auto arena1Ptr = arena1.get();
+    arena1.reset();
+
+    auto arena2 = pool.acquire();
+    ASSERT_NE(arena2.get(), arena1Ptr);
+    ASSERT_EQ(pool.size(), 2);
+    arena2.reset();
+
+    message.reset();
+    ASSERT_EQ(pool.acquire().get(), arena1Ptr);
+
+    // Datapacks received by the client keep their arena alive
+
+    const std::string datapackName = "a";
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest"});
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    // Server side messages are allocated in the wrapper arena
+    TestArenaDataPackController datapackController;
+    engineWrapper->registerDataPack(datapackName, &datapackController);
+
+    server.startServer();
+    testSleep(1500);
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier(datapackName, engineName, "b"));
+
+    const auto output1 = client.getDataPacksFromEngine(datapackIdentifiers);
+    const auto output2 = client.getDataPacksFromEngine(datapackIdentifiers);
+    const auto output3 = client.getDataPacksFromEngine(datapackIdentifiers);
+
+    const auto getInteger = [](const datapacks_vector_t & output)
+    { return dynamic_cast<const DataPack<EngineTest::TestPayload> *>(output.begin()->get())->getData().integer(); };
+
+    ASSERT_EQ(getInteger(output1), 1);
+    ASSERT_EQ(getInteger(output2), 2);
+    ASSERT_EQ(getInteger(output3), 3);
+}
+
+TEST(EngineGrpc, ConcurrentGetDataPacks)
+{
+    std::atomic<int> activeCalls(0);
+    std::atomic<int> maxActiveCalls(0);
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    EngineGrpcServer server("localhost:9004", engineWrapper);
+
+    TestSlowDataPackController controllerA(activeCalls, maxActiveCalls);
+    TestSlowDataPackController controllerB(activeCalls, maxActiveCalls);
+    engineWrapper->registerDataPack("a", &controllerA);
+    engineWrapper->registerDataPack("b", &controllerB);
+
+    const auto getDataPack = [&server](const std::string &datapackName)
+    {
+        EngineGrpc::GetDataPacksRequest request;
+        request.add_datapackids()->set_datapackname(datapackName);
+
+        EngineGrpc::GetDataPacksReply reply;
+        ASSERT_TRUE(server.getDataPacks(nullptr, &request, &reply).ok());
+    };
+
+    const auto getConcurrently = [&](const std::string &datapackName1, const std::string &datapackName2)
+    {
+        maxActiveCalls = 0;
+
+        std::thread get1(getDataPack, datapackName1);
+        std::thread get2(getDataPack, datapackName2);
+        get1.join();
+        get2.join();
+
+        return maxActiveCalls.load();
+    };
+
+    // By default, datapacks are not fetched concurrently
+
+    ASSERT_EQ(getConcurrently("a", "b"), 1);
+
+    // If the engine allows it, datapacks from different controllers are fetched concurrently
+
+    engineWrapper->setConcurrentDataPackReads(true);
+
+    ASSERT_EQ(getConcurrently("a", "b"), 2);
+
+    // Calls to the same controller are still serialized
+
+    ASSERT_EQ(getConcurrently("a", "a"), 1);
+}
+
+TEST(EngineGrpc, SegmentedDataPacks)
+{
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest", "Gazebo"});
+    config["SegmentedDataPacks"] = true;
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    TestCameraDataPackController cameraController;
+    TestGrpcDataPackController   payloadController;
+    engineWrapper->registerDataPack("camera", &cameraController);
+    engineWrapper->registerDataPack("payload", &payloadController);
+
+    server.startServer();
+    testSleep(1500);
+
+    // The image data is sent as a segment, small datapacks are sent in the data field
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier("camera", engineName, DataPack<Gazebo::Camera>::getType()));
+    datapackIdentifiers.insert(DataPackIdentifier("payload", engineName, DataPack<EngineTest::TestPayload>::getType()));
+
+    for(int step = 1; step <= 2; ++step)
+    {
+        const auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+        ASSERT_EQ(output.size(), 2);
+
+        for(const auto & dataPack : output)
+        {
+            if(dataPack->name() == "camera")
+            {
+                const auto & camera = dynamic_cast<const DataPack<Gazebo::Camera> *>(dataPack.get())->getData();
+                ASSERT_EQ(camera.imagewidth(), 320);
+                ASSERT_EQ(camera.imagedepth(), 3);
+                ASSERT_EQ(camera.imagedata(), std::string(320*240*3, static_cast<char>(step)));
+            }
+            else
+                ASSERT_NE(dynamic_cast<const DataPack<EngineTest::TestPayload> *>(dataPack.get()), nullptr);
+        }
+    }
+
+    // Empty datapacks are still returned as such
+
+    payloadController.triggerEmptyDataPackReturn(true);
+
+    datapackIdentifiers.erase(DataPackIdentifier("camera", engineName, DataPack<Gazebo::Camera>::getType()));
+    const auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+
+    ASSERT_EQ(output.size(), 1);
+    ASSERT_TRUE(output.begin()->get()->isEmpty());
+}
+
+TEST(EngineGrpc, SegmentedMessage)
+{
+    const std::string image(64*48*3, 'i');
+
+    Gazebo::Camera camera;
+    camera.set_imagewidth(64);
+    camera.set_imagedata(image);
+
+    // Fields smaller than the segment size stay in the serialized message
+
+    EngineGrpc::SegmentedDataPackMessage message;
+    protobuf_ops::moveToSegmentedMessage(camera, &message, image.size() + 1);
+
+    ASSERT_EQ(message.datatype(), Gazebo::Camera::descriptor()->full_name());
+    ASSERT_EQ(message.segments_size(), 0);
+    ASSERT_EQ(camera.imagedata(), image);
+
+    // Larger fields are moved, not copied, into the sent message and restored in the received one
+
+    const char * imageBuffer = camera.imagedata().data();
+
+    message.Clear();
+    protobuf_ops::moveToSegmentedMessage(camera, &message, image.size());
+
+    ASSERT_EQ(message.segments_size(), 1);
+    ASSERT_EQ(message.segments(0).data().data(), imageBuffer);
+    ASSERT_TRUE(camera.imagedata().empty());
+
+    Gazebo::Camera received;
+    ASSERT_TRUE(protobuf_ops::moveFromSegmentedMessage(message, &received));
+    ASSERT_EQ(received.imagewidth(), 64);
+    ASSERT_EQ(received.imagedata(), image);
+}
+
+TEST(EngineGrpc, DataPackSubscription)
+{
+    const std::string datapackName = "a";
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest"});
+    config["DataPackSubscription"] = true;
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    // Every fetch of the datapack returns new data
+    TestArenaDataPackController datapackController;
+    engineWrapper->registerDataPack(datapackName, &datapackController);
+
+    server.startServer();
+    testSleep(1500);
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier(datapackName, engineName, "b"));
+
+    const auto getInteger = [](const datapacks_vector_t & output)
+    { return dynamic_cast<const DataPack<EngineTest::TestPayload> *>(output.begin()->get())->getData().integer(); };
+
+    // The datapacks are pushed when subscribing and after each step
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 1);
+
+    const SimulationTime timeStep = floatToSimulationTime(1.0f);
+    ASSERT_EQ(client.runLoopStepCallback(timeStep), timeStep);
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 2);
+
+    // Only the datapacks from the last step are returned
+
+    client.runLoopStepCallback(timeStep);
+    client.runLoopStepCallback(timeStep);
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 4);
+
+    // Without a new step there is no new data
+
+    const auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+
+    ASSERT_EQ(output.size(), 1);
+    ASSERT_EQ(output.begin()->get()->name(), datapackName);
+    ASSERT_TRUE(output.begin()->get()->isEmpty());
+
+    // Errors fetching the subscribed datapacks don't fail the step, they are returned with the subscription
+
+    datapackController.throwOnNextFetch();
+    ASSERT_NO_THROW(client.runLoopStepCallback(timeStep));
+    ASSERT_THROW(client.getDataPacksFromEngine(datapackIdentifiers), std::runtime_error);
+
+    // The client subscribes again afterwards
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 5);
+
+    // Resetting the engine cancels the subscription, the datapacks are pushed again when subscribing
+
+    client.reset();
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 6);
+}
+
+TEST(EngineGrpc, DataPackCompression)
+{
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest", "Gazebo"});
+    config["DataPackCompression"] = "lz4";
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    TestCameraDataPackController cameraController;
+    TestGrpcDataPackController   payloadController;
+    engineWrapper->registerDataPack("camera", &cameraController);
+    engineWrapper->registerDataPack("payload", &payloadController);
+
+    server.startServer();
+    testSleep(1500);
+
+    // Datapacks are decompressed transparently by the client
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier("camera", engineName, DataPack<Gazebo::Camera>::getType()));
+    datapackIdentifiers.insert(DataPackIdentifier("payload", engineName, DataPack<EngineTest::TestPayload>::getType()));
+
+    const auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+    ASSERT_EQ(output.size(), 2);
+
+    for(const auto & dataPack : output)
+    {
+        if(dataPack->name() == "camera")
+        {
+            const auto & camera = dynamic_cast<const DataPack<Gazebo::Camera> *>(dataPack.get())->getData();
+            ASSERT_EQ(camera.imagewidth(), 320);
+            ASSERT_EQ(camera.imagedata(), std::string(320*240*3, static_cast<char>(1)));
+        }
+        else
+            ASSERT_NE(dynamic_cast<const DataPack<EngineTest::TestPayload> *>(dataPack.get()), nullptr);
+    }
+
+    // Only datapacks above the threshold are compressed, and only if the client requests it
+
+    auto stub = EngineGrpc::EngineGrpcService::NewStub(grpc::CreateChannel(client.serverAddress(), grpc::InsecureChannelCredentials()));
+
+    EngineGrpc::GetDataPacksRequest request;
+    for(const auto & name : {"camera", "payload"})
+        request.add_datapackids()->set_datapackname(name);
+
+    for(const auto & codec : {"zstd", "none"})
+    {
+        grpc::ClientContext context;
+        context.AddMetadata(EngineGRPCConfigConst::DataPackCompressionKey.data(), codec);
+
+        EngineGrpc::GetDataPacksReply reply;
+        ASSERT_TRUE(stub->getDataPacks(&context, request, &reply).ok());
+        ASSERT_EQ(reply.datapacks_size(), 2);
+
+        ASSERT_EQ(reply.datapacks(0).data().Is<EngineGrpc::CompressedData>(), std::string(codec) == "zstd");
+        ASSERT_FALSE(reply.datapacks(1).data().Is<EngineGrpc::CompressedData>());
+
+        if(std::string(codec) == "zstd")
+        {
+            EngineGrpc::DataPackMessage decompressed;
+            ASSERT_TRUE(protobuf_ops::decompressDataPackMessage(reply.datapacks(0), &decompressed));
+            ASSERT_TRUE(decompressed.data().Is<Gazebo::Camera>());
+        }
+    }
+}
+
+TEST(EngineGrpc, UnchangedDataPacks)
+{
+    const std::string datapackName = "a";
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest"});
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    TestSequenceDataPackController datapackController;
+    engineWrapper->registerDataPack(datapackName, &datapackController);
+
+    server.startServer();
+    testSleep(1500);
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier(datapackName, engineName, "b"));
+
+    const auto getInteger = [](const datapacks_vector_t & output)
+    { return dynamic_cast<const DataPack<EngineTest::TestPayload> *>(output.begin()->get())->getData().integer(); };
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 1);
+    ASSERT_EQ(datapackController.fetchCount, 1);
+
+    // While the sequence number doesn't change, the data isn't fetched and the client reuses the datapack received last
+
+    auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+    ASSERT_EQ(getInteger(output), 1);
+    ASSERT_TRUE(output.begin()->get()->isUpdated());
+    ASSERT_EQ(datapackController.fetchCount, 1);
+
+    datapackController.value    = 2;
+    datapackController.sequence = 2;
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 2);
+    ASSERT_EQ(datapackController.fetchCount, 2);
+
+    // After a reset, the data is sent again
+
+    client.sendResetCommand();
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 2);
+    ASSERT_EQ(datapackController.fetchCount, 3);
+}
+
+TEST(EngineGrpc, StepSequenceDataPacks)
+{
+    const std::string datapackName = "a";
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest"});
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    TestStepSequenceDataPackController datapackController(*engineWrapper);
+    engineWrapper->registerDataPack(datapackName, &datapackController);
+
+    server.startServer();
+    testSleep(1500);
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier(datapackName, engineName, "b"));
+
+    const auto getInteger = [](const datapacks_vector_t & output)
+    { return dynamic_cast<const DataPack<EngineTest::TestPayload> *>(output.begin()->get())->getData().integer(); };
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 1);
+    ASSERT_EQ(datapackController.fetchCount, 1);
+
+    // Without an engine step, the data is not fetched again
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 1);
+    ASSERT_EQ(datapackController.fetchCount, 1);
+
+    // Running a step changes the sequence number
+
+    client.runLoopStepCallback(floatToSimulationTime(1.0f));
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 1);
+    ASSERT_EQ(datapackController.fetchCount, 2);
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 1);
+    ASSERT_EQ(datapackController.fetchCount, 2);
+
+    // So does writing data to the controller
+
+    auto d = new EngineTest::TestPayload();
+    d->set_integer(5);
+    datapacks_set_t inputDataPacks;
+    inputDataPacks.insert(generateDataPack(datapackName, engineName, d));
+    client.sendDataPacksToEngine(inputDataPacks);
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 5);
+    ASSERT_EQ(datapackController.fetchCount, 3);
+
+    // Datapacks fetched for other receivers, e.g. published by an event loop engine, always contain the data, and
+    // don't change what was sent to the client
+
+    EngineGrpc::DataPackMessage dpMsg;
+    ASSERT_TRUE(engineWrapper->getDataPack(datapackName, &dpMsg, false));
+    ASSERT_TRUE(dpMsg.data().Is<EngineTest::TestPayload>());
+    ASSERT_EQ(datapackController.fetchCount, 4);
+
+    ASSERT_EQ(getInteger(client.getDataPacksFromEngine(datapackIdentifiers)), 5);
+    ASSERT_EQ(datapackController.fetchCount, 4);
+}
+
+TEST(EngineGrpc, SharedMemoryTransport)
+{
+    const std::string datapackName = "a";
+    const std::string datapackType = "b";
+    const std::string engineName = "c";
+
+    nlohmann::json config;
+    config["EngineName"] = engineName;
+    config["EngineType"] = "test_engine_grpc";
+    config["ProtobufPluginsPath"] = NRP_PLUGIN_INSTALL_DIR;
+    config["ProtobufPackages"] = json::array({"EngineTest"});
+    config["EngineTransport"] = "shm";
+    config["SharedMemoryCapacity"] = 16;
+
+    // No need to be concerned about deleting this pointer, EngineGrpcServer takes care of that
+    auto engineWrapper = new TestEngine();
+    TestEngineGrpcClient client(config, ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic()));
+    EngineGrpcServer server(client.serverAddress(), engineWrapper);
+
+    std::shared_ptr<TestGrpcDataPackController> datapackController(new TestGrpcDataPackController()); // Server side
+    engineWrapper->registerDataPack(datapackName, datapackController.get());
+
+    // The server attaches to the segment created by the client
+
+    server.startServer();
+    ASSERT_NO_THROW(client.connectToEngine());
+
+    // Calls and their errors go through the shared memory channel
+
+    nlohmann::json jsonMessage;
+    jsonMessage["init"] = true;
+    ASSERT_NO_THROW(client.sendInitializeCommand(jsonMessage));
+
+    engineWrapper->throwOnNextCommand();
+    ASSERT_THROW(client.sendInitializeCommand(jsonMessage), std::runtime_error);
+
+    const SimulationTime timeStep = floatToSimulationTime(1.0f);
+    ASSERT_EQ(client.runLoopStepCallback(timeStep), timeStep);
+    ASSERT_THROW(client.runLoopStepCallback(floatToSimulationTime(-2.0f)), std::runtime_error);
+
+    // Messages larger than the ring buffers are streamed through them
+
+    auto d = new EngineTest::TestPayload();
+    d->set_integer(111);
+    datapacks_set_t input_datapacks;
+    input_datapacks.insert(generateDataPack(datapackName, engineName, d));
+
+    client.sendDataPacksToEngine(input_datapacks);
+
+    datapack_identifiers_set_t datapackIdentifiers;
+    datapackIdentifiers.insert(DataPackIdentifier(datapackName, engineName, datapackType));
+
+    const auto output = client.getDataPacksFromEngine(datapackIdentifiers);
+
+    ASSERT_EQ(output.size(), 1);
+    ASSERT_EQ(dynamic_cast<const DataPack<EngineTest::TestPayload> *>(output.begin()->get())->getData().integer(), 111);
+
+    nlohmann::json shutdownMessage;
+    shutdownMessage["shutdown"] = true;
+    ASSERT_NO_THROW(client.sendShutdownCommand(shutdownMessage));
+}
+
 // EOF
@@ -0,0 +1,124 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include <chrono>
+#include <thread>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "nrp_general_library/utils/nrp_exceptions.h"
+#include "nrp_grpc_engine_protocol/shm_transport/shm_channel.h"
+
+using namespace std::chrono_literals;
+
+/*!
+ * \brief Forks a process running 'serve' with the server side of the channel. The process exits with 0 on success
+ */
+template<class FUNCTION>
+static pid_t forkServer(const std::string &name, FUNCTION &&serve)
+{
+    const pid_t pid = fork();
+    if(pid == 0)
+    {
+        // Exit without running destructors, the client side of the channel belongs to the parent process
+        try
+        {
+            auto server = ShmChannel::open(name);
+            serve(*server);
+        }
+        catch(...)
+        {
+            _exit(1);
+        }
+
+        _exit(0);
+    }
+
+    return pid;
+}
+
+TEST(ShmChannel, LateReplyIsDiscarded)
+{
+    const auto name = ShmChannel::segmentName("test_shm_late_reply_" + std::to_string(getpid()));
+    auto client = ShmChannel::create(name, 4096);
+
+    const pid_t serverPid = forkServer(name, [] (ShmChannel &server) {
+        uint32_t    tag;
+        uint32_t    callId;
+        std::string request;
+
+        // The first reply is sent after the client stopped waiting for it
+        server.receive(tag, request, ShmChannel::duration_t::zero(), &callId);
+        std::this_thread::sleep_for(500ms);
+        server.send(1, "late reply", callId);
+
+        server.receive(tag, request, ShmChannel::duration_t::zero(), &callId);
+        server.send(2, request, callId);
+    });
+
+    ASSERT_TRUE(client->waitForServer(5s));
+
+    uint32_t    replyTag;
+    std::string reply;
+    ASSERT_FALSE(client->call(0, "first", replyTag, reply, 100ms));
+
+    // The late reply to the first call must not be taken as the reply to the second one
+    ASSERT_TRUE(client->call(0, "second", replyTag, reply, 5s));
+    ASSERT_EQ(replyTag, 2u);
+    ASSERT_EQ(reply, "second");
+
+    int status;
+    ASSERT_EQ(waitpid(serverPid, &status, 0), serverPid);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(ShmChannel, ServerExitsDuringCall)
+{
+    const auto name = ShmChannel::segmentName("test_shm_server_exit_" + std::to_string(getpid()));
+    auto client = ShmChannel::create(name, 4096);
+
+    const pid_t serverPid = forkServer(name, [] (ShmChannel &server) {
+        uint32_t    tag;
+        std::string request;
+
+        // Crash while serving the request
+        server.receive(tag, request);
+        kill(getpid(), SIGKILL);
+    });
+
+    ASSERT_TRUE(client->waitForServer(5s));
+
+    // The server is a child of this process and isn't reaped until the call returns, i.e. it stays a zombie. The
+    // call must detect it instead of waiting indefinitely
+    uint32_t    replyTag;
+    std::string reply;
+    ASSERT_THROW(client->call(0, "request", replyTag, reply), NRPException);
+
+    int status;
+    ASSERT_EQ(waitpid(serverPid, &status, 0), serverPid);
+    ASSERT_TRUE(WIFSIGNALED(status));
+}
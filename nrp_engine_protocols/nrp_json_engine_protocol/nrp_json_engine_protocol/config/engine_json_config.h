@@ -86,10 +86,25 @@ struct EngineJSONConfigConst
          */
         static constexpr std::string_view EngineTimeName = "time";
 
+        /*!
+         * \brief JSON name under which the sequence number of a datapack reported as unchanged is sent, instead of its data
+         */
+        static constexpr std::string_view DataPackUnchangedName = "unchanged";
+
         /*!
          * \brief Content Type passed between server and client
          */
         static constexpr std::string_view EngineServerContentType = "application/json";
+
+        /*!
+         * \brief Content Type of CBOR encoded requests and responses
+         */
+        static constexpr std::string_view EngineServerCBORContentType = "application/cbor";
+
+        /*!
+         * \brief Content Type of MessagePack encoded requests and responses
+         */
+        static constexpr std::string_view EngineServerMessagePackContentType = "application/msgpack";
 };
 
 #endif // ENGINE_JSON_CONFIG_H
@@ -170,6 +170,7 @@ void EngineJSONServer::clearRegisteredDataPacks()
     //EngineJSONServer::lock_t lock(this->_datapackLock);
 
     this->_datapacksControllers.clear();
+    this->_sentDataPackSequences.clear();
 }
 
 nlohmann::json EngineJSONServer::getDataPackData(const nlohmann::json &reqData)
@@ -186,6 +187,19 @@ nlohmann::json EngineJSONServer::getDataPackData(const nlohmann::json &reqData)
 
         if(devInterface != this->_datapacksControllers.end())
         {
+            // Datapacks whose data didn't change since it was last sent are replaced by a marker
+            const auto sequence = devInterface->second->getDataPackSequence();
+            auto &sentSequence = this->_sentDataPackSequences[devName];
+
+            if(sequence != JsonDataPackController::NoSequence && sequence == sentSequence)
+            {
+                auto unchangedDataPack = devInterface->second->getEmptyDataPack();
+                unchangedDataPack.begin().value()[EngineJSONConfigConst::DataPackUnchangedName.data()] = sequence;
+
+                jres.update(unchangedDataPack);
+                continue;
+            }
+
             auto dev = devInterface->second->getDataPackInformation();
 
             if(dev == nullptr)
@@ -195,6 +209,7 @@ nlohmann::json EngineJSONServer::getDataPackData(const nlohmann::json &reqData)
             else
             {
                 jres.update(*dev);
+                sentSequence = sequence;
             }
         }
         else
@@ -250,12 +265,21 @@ Pistache::Rest::Router EngineJSONServer::setRoutes(EngineJSONServer *server)
     return router;
 }
 
-nlohmann::json EngineJSONServer::parseRequest(const Pistache::Rest::Request &req, Pistache::Http::ResponseWriter &res)
+JSONWireFormat EngineJSONServer::requestWireFormat(const Pistache::Rest::Request &req)
+{
+    const auto contentType = req.headers().tryGet<Pistache::Http::Header::ContentType>();
+    if(contentType == nullptr)
+        return JSONWireFormat::JSON;
+
+    return json_wire_format::fromContentType(contentType->mime().toString());
+}
+
+nlohmann::json EngineJSONServer::parseRequest(const Pistache::Rest::Request &req, JSONWireFormat format, Pistache::Http::ResponseWriter &res)
 {
     json jrequest;
     try
     {
-        jrequest = json::parse(req.body());
+        jrequest = json_wire_format::decode(req.body(), format);
     }
     catch(std::exception &e)
     {
@@ -268,20 +292,29 @@ nlohmann::json EngineJSONServer::parseRequest(const Pistache::Rest::Request &req
     return jrequest;
 }
 
+void EngineJSONServer::sendResponse(Pistache::Http::ResponseWriter &res, const nlohmann::json &data, JSONWireFormat format)
+{
+    res.send(Pistache::Http::Code::Ok, json_wire_format::encode(data, format),
+             Pistache::Http::Mime::MediaType::fromString(std::string(json_wire_format::contentType(format))));
+}
+
 void EngineJSONServer::getDataPackDataHandler(const Pistache::Rest::Request &req, Pistache::Http::ResponseWriter res)
 {
-    const json jrequest(this->parseRequest(req, res));
-    res.send(Pistache::Http::Code::Ok, this->getDataPackData(jrequest).dump());
+    const auto format = EngineJSONServer::requestWireFormat(req);
+    const json jrequest(this->parseRequest(req, format, res));
+    EngineJSONServer::sendResponse(res, this->getDataPackData(jrequest), format);
 }
 
 void EngineJSONServer::setDataPackProcessorr(const Pistache::Rest::Request &req, Pistache::Http::ResponseWriter res)
 {
     NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
+    const auto format = EngineJSONServer::requestWireFormat(req);
+
     json jrequest;
     try
     {
-        jrequest = json::parse(req.body());
+        jrequest = json_wire_format::decode(req.body(), format);
     }
     catch(std::exception &e)
     {
@@ -295,7 +328,7 @@ void EngineJSONServer::setDataPackProcessorr(const Pistache::Rest::Request &req,
     try
     {
         this->setDataPackData(jrequest);
-        res.send(Pistache::Http::Code::Ok, "{}");
+        EngineJSONServer::sendResponse(res, json::object(), format);
     }
     catch(std::exception &e)
     {
@@ -319,7 +352,8 @@ const std::string &EngineJSONServer::getIteratorKey(const nlohmann::json::const_
 
 void EngineJSONServer::runLoopStepHandler(const Pistache::Rest::Request &req, Pistache::Http::ResponseWriter res)
 {
-    const json jrequest = this->parseRequest(req, res);
+    const auto format = EngineJSONServer::requestWireFormat(req);
+    const json jrequest = this->parseRequest(req, format, res);
 
     SimulationTime timeStep;
     try
@@ -340,7 +374,7 @@ void EngineJSONServer::runLoopStepHandler(const Pistache::Rest::Request &req, Pi
         EngineJSONServer::lock_t lock(this->_datapackLock);
 
         const auto retJson(nlohmann::json({{EngineJSONConfigConst::EngineTimeName.data(), (this->runLoopStep(timeStep)).count()}}));
-        res.send(Pistache::Http::Code::Ok, retJson.dump());
+        EngineJSONServer::sendResponse(res, retJson, format);
     }
     catch(std::exception &e)
     {
@@ -355,7 +389,8 @@ void EngineJSONServer::initializeHandler(const Pistache::Rest::Request &req, Pis
 {
     NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
-    const json jrequest = this->parseRequest(req, res);
+    const auto format = EngineJSONServer::requestWireFormat(req);
+    const json jrequest = this->parseRequest(req, format, res);
 
     json jresp;
     try
@@ -375,12 +410,13 @@ void EngineJSONServer::initializeHandler(const Pistache::Rest::Request &req, Pis
     }
 
     // Return init response
-    res.send(Pistache::Http::Code::Ok, jresp.dump());
+    EngineJSONServer::sendResponse(res, jresp, format);
 }
 
 void EngineJSONServer::resetHandler(const Pistache::Rest::Request &req, Pistache::Http::ResponseWriter res)
 {
-    const json jrequest = this->parseRequest(req, res);
+    const auto format = EngineJSONServer::requestWireFormat(req);
+    const json jrequest = this->parseRequest(req, format, res);
 
     json jresp;
     try
@@ -390,6 +426,9 @@ void EngineJSONServer::resetHandler(const Pistache::Rest::Request &req, Pistache
 
         // Run initialization function
         jresp = this->reset(lock);
+
+        // The client drops the datapacks it received before the reset
+        this->_sentDataPackSequences.clear();
     }
     catch(std::exception &e)
     {
@@ -400,7 +439,7 @@ void EngineJSONServer::resetHandler(const Pistache::Rest::Request &req, Pistache
     }
 
     // Return init response
-    res.send(Pistache::Http::Code::Ok, jresp.dump());
+    EngineJSONServer::sendResponse(res, jresp, format);
 }
 
 void EngineJSONServer::shutdownHandler(const Pistache::Rest::Request &req, Pistache::Http::ResponseWriter res)
@@ -416,7 +455,8 @@ void EngineJSONServer::shutdownHandler(const Pistache::Rest::Request &req, Pista
 
     this->_shutdownFlag = true;
 
-    const json jrequest = this->parseRequest(req, res);
+    const auto format = EngineJSONServer::requestWireFormat(req);
+    const json jrequest = this->parseRequest(req, format, res);
 
     json jresp;
     try
@@ -436,7 +476,7 @@ void EngineJSONServer::shutdownHandler(const Pistache::Rest::Request &req, Pista
     }
 
     // Return shutdown response
-    res.send(Pistache::Http::Code::Ok, jresp.dump());
+    EngineJSONServer::sendResponse(res, jresp, format);
 }
 
 Pistache::Http::Endpoint EngineJSONServer::createEndpoint(std::string *engineAddress, const std::string &engineName)
@@ -24,6 +24,7 @@
 
 #include "nrp_json_engine_protocol/config/engine_json_config.h"
 #include "nrp_json_engine_protocol/engine_server/json_datapack_controller.h"
+#include "nrp_json_engine_protocol/utils/json_wire_format.h"
 
 #include "nrp_general_library/datapack_interface/datapack.h"
 #include "nrp_general_library/utils/time_utils.h"
@@ -236,6 +237,14 @@ class EngineJSONServer
          */
         std::map<std::string, JsonDataPackController*> _datapacksControllers;
 
+        /*!
+         * \brief Sequence numbers of the datapack data last sent, see DataPackController::getDataPackSequence()
+         *
+         * As long as the sequence number reported by a controller doesn't change, an "unchanged" marker is sent instead
+         * of the datapack data
+         */
+        std::map<std::string, uint64_t> _sentDataPackSequences;
+
         NRPLogger _loggerCfg;
 
         /*!
@@ -243,13 +252,29 @@ class EngineJSONServer
          */
         static Pistache::Rest::Router setRoutes(EngineJSONServer *server);
 
+        /*!
+         * \brief Get the wire format of a request from its content type. Responses are sent back in the same format
+         * \param req Request
+         * \return Returns the request format. Defaults to JSON if the request has no content type
+         */
+        static JSONWireFormat requestWireFormat(const Pistache::Rest::Request &req);
+
         /*!
          * \brief Parse request
          * \param req Request
+         * \param format Wire format of the request body
          * \paragraph res Response Writer. Sends back failure message if parse failed
          * \return Returns JSON object
          */
-        static nlohmann::json parseRequest(const Pistache::Rest::Request &req, Pistache::Http::ResponseWriter &res);
+        static nlohmann::json parseRequest(const Pistache::Rest::Request &req, JSONWireFormat format, Pistache::Http::ResponseWriter &res);
+
+        /*!
+         * \brief Send a successful response
+         * \param res Response Writer
+         * \param data Response data
+         * \param format Wire format in which the response is encoded
+         */
+        static void sendResponse(Pistache::Http::ResponseWriter &res, const nlohmann::json &data, JSONWireFormat format);
 
         /*!
          * \brief Callback function to retrieve datapack data. Takes an array of datapack names for which to get data.
@@ -26,13 +26,16 @@
 #include "nrp_json_engine_protocol/config/engine_json_config.h"
 #include "nrp_json_engine_protocol/nrp_client/engine_json_registration_server.h"
 #include "nrp_json_engine_protocol/datapack_interfaces/json_datapack.h"
+#include "nrp_json_engine_protocol/utils/json_wire_format.h"
 #include "nrp_general_library/utils/nrp_exceptions.h"
 #include "nrp_general_library/utils/restclient_setup.h"
 
 #include <nlohmann/json.hpp>
 #include <list>
+#include <map>
 
 #include <chrono>
+#include <strings.h>
 
 #include <iostream>
 #include <restclient-cpp/restclient.h>
@@ -53,7 +56,8 @@ class EngineJSONNRPClient
          */
         EngineJSONNRPClient(nlohmann::json &config, ProcessLauncherInterface::unique_ptr &&launcher)
             : EngineClient<ENGINE, SCHEMA>(config, std::move(launcher)),
-              _serverAddress(this->engineConfig().at("ServerAddress"))
+              _serverAddress(this->engineConfig().at("ServerAddress")),
+              _wireFormat(json_wire_format::fromName(this->engineConfig().at("WireFormat")))
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
@@ -68,7 +72,8 @@ class EngineJSONNRPClient
          */
         EngineJSONNRPClient(const std::string &serverAddress, nlohmann::json &config, ProcessLauncherInterface::unique_ptr &&launcher)
             : EngineClient<ENGINE, SCHEMA>(config, std::move(launcher)),
-              _serverAddress(serverAddress)
+              _serverAddress(serverAddress),
+              _wireFormat(json_wire_format::fromName(this->engineConfig().at("WireFormat")))
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
@@ -76,9 +81,14 @@ class EngineJSONNRPClient
             RestClientSetup::ensureInstance();
         }
 
-        virtual ~EngineJSONNRPClient() override = default;
+        virtual ~EngineJSONNRPClient() override
+        {
+            // The engine was launched, but connectToEngine() wasn't called
+            if(this->_waitForRegistration)
+                EngineJSONRegistrationServer::cancelEngineRequestFromInstance(this->engineName());
+        }
 
-        virtual pid_t launchEngine() override
+        virtual pid_t launchEngineProcess() override
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
@@ -86,21 +96,39 @@ class EngineJSONNRPClient
 
             // Launch engine process.
             // enginePID == -1 means that the launcher hasn't launched a process
-            auto enginePID = this->EngineClientInterface::launchEngine();
+            auto enginePID = this->EngineClientInterface::launchEngineProcess();
 
-            // Wait for engine to register itself if process launching has succeeded
-            if(enginePID > 0 && !this->engineConfig().at("RegistrationServerAddress").empty())
-            {
-                const auto serverAddr = this->waitForRegistration(20, 1);
+            // Engine must register itself if process launching has succeeded.
+            // The engine is requested from the registration server right away, so that the server is kept
+            // running while other engines launched afterwards wait for their registration in connectToEngine()
+            this->_waitForRegistration = enginePID > 0 && !this->engineConfig().at("RegistrationServerAddress").empty();
+            if(this->_waitForRegistration)
+                this->_registeredAddress = EngineJSONRegistrationServer::requestEngineFromInstance(this->engineName());
 
-                if(serverAddr.empty())
-                    throw NRPException::logCreate("Error while waiting for engine \"" + this->engineName() + "\" to register its address. Did not receive a reply");
+            return enginePID;
+        }
 
-                this->engineConfig()["ServerAddress"] = serverAddr;
-                this->_serverAddress = serverAddr;
+        virtual void connectToEngine() override
+        {
+            NRP_LOGGER_TRACE("{} called", __FUNCTION__);
+
+            if(!this->_waitForRegistration)
+                return;
+
+            this->_waitForRegistration = false;
+
+            // Wait for engine to register itself
+            const auto serverAddr = this->_registeredAddress.empty() ? this->waitForRegistration(20, 1) : this->_registeredAddress;
+
+            if(serverAddr.empty())
+            {
+                // Don't keep the registration server running for this engine
+                EngineJSONRegistrationServer::cancelEngineRequestFromInstance(this->engineName());
+                throw NRPException::logCreate("Error while waiting for engine \"" + this->engineName() + "\" to register its address. Did not receive a reply");
             }
 
-            return enginePID;
+            this->engineConfig()["ServerAddress"] = serverAddr;
+            this->_serverAddress = serverAddr;
         }
 
         virtual void sendDataPacksToEngine(const datapacks_set_t & dataPacks) override
@@ -135,7 +163,7 @@ class EngineJSONNRPClient
 
             // Send updated datapacks to Engine JSON server
             EngineJSONNRPClient::sendRequest(this->_serverAddress + "/" + EngineJSONConfigConst::EngineServerSetDataPacksRoute.data(),
-                                             EngineJSONConfigConst::EngineServerContentType.data(), request.dump(),
+                                             request,
                                              "Engine server \"" + this->engineName() + "\" failed during datapack handling");
 
             // TODO: Check if engine has processed all sent datapacks
@@ -177,7 +205,7 @@ class EngineJSONNRPClient
 
             // Post request to Engine JSON server
             const auto resp(EngineJSONNRPClient::sendRequest(this->_serverAddress + "/" + EngineJSONConfigConst::EngineServerGetDataPacksRoute.data(),
-                                                             EngineJSONConfigConst::EngineServerContentType.data(), request.dump(),
+                                                             request,
                                                              "Engine server \"" + this->engineName() + "\" failed during datapack retrieval"));
 
             return this->getDataPackInterfacesFromJSON(resp);
@@ -197,7 +225,7 @@ protected:
 
             // Post init request to Engine JSON server
             return sendRequest(this->_serverAddress + "/" + EngineJSONConfigConst::EngineServerInitializeRoute.data(),
-                               EngineJSONConfigConst::EngineServerContentType.data(), data.dump(),
+                               data,
                                "Engine server \"" + this->engineName() + "\" failed during initialization");
         }
 
@@ -212,9 +240,12 @@ protected:
 
             NRPLogger::debug("EngineJSONNRPClient::sendResetCommand [ data: {} ]", data.dump());
 
+            // The engine sends the data of all datapacks again after a reset
+            this->_receivedDataPacks.clear();
+
             // Post reset request to Engine JSON server
             return sendRequest(this->_serverAddress + "/" + EngineJSONConfigConst::EngineServerResetRoute.data(),
-                               EngineJSONConfigConst::EngineServerContentType.data(), data.dump(),
+                               data,
                                "Engine server \"" + this->engineName() + "\" failed during reset");
         }
 
@@ -231,12 +262,16 @@ protected:
 
             // Post init request to Engine JSON server
             return sendRequest(this->_serverAddress + "/" + EngineJSONConfigConst::EngineServerShutdownRoute.data(),
-                               EngineJSONConfigConst::EngineServerContentType.data(), data.dump(),
+                               data,
                                "Engine server \"" + this->engineName() + "\" failed during shutdown");
         }
 
         /*!
          * \brief Wait for the engine registration server to receive a call from the engine
+         *
+         * The engine must have been requested from the registration server beforehand (see launchEngineProcess()).
+         * It can be called concurrently by clients of different engines.
+         *
          * \param numTries Number of times to check the registration server for an address
          * \param waitTime Wait time (in seconds) between checks
          * \return Returns engine server address if present, empty string otherwise
@@ -245,28 +280,17 @@ protected:
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
-            auto *pRegistrationServer = EngineJSONRegistrationServer::getInstance();
-
-            assert(pRegistrationServer != nullptr);
-            assert(pRegistrationServer->isRunning());
-
             // Try to retrieve engine address
-            auto engineAddr = pRegistrationServer->requestEngine(this->engineName());
+            auto engineAddr = EngineJSONRegistrationServer::retrieveEngineAddressFromInstance(this->engineName());
 
             while(engineAddr.empty() && numTries > 0)
             {
                 // Continue to wait for engine address for 20s
                 sleep(waitTime);
-                engineAddr = pRegistrationServer->retrieveEngineAddress(this->engineName());
+                engineAddr = EngineJSONRegistrationServer::retrieveEngineAddressFromInstance(this->engineName());
                 --numTries;
             }
 
-            // Close server if no additional clients are waiting for their engines to register
-            if(pRegistrationServer->getNumWaitingEngines() == 0)
-            {
-                EngineJSONRegistrationServer::clearInstance();
-            }
-
             return engineAddr;
         }
 
@@ -279,20 +303,49 @@ protected:
          */
         std::string _serverAddress;
 
+        /*!
+         * \brief Whether connectToEngine() must wait for the engine to register its address
+         */
+        bool _waitForRegistration = false;
+
+        /*!
+         * \brief Engine address, if it was already registered when the engine was requested from the registration server
+         */
+        std::string _registeredAddress;
+
+        /*!
+         * \brief Format in which requests are sent to the server
+         */
+        JSONWireFormat _wireFormat;
+
+        /*!
+         * \brief Connection to the server, kept open between requests
+         */
+        RestClientConnection _connection;
+
+        /*!
+         * \brief Copies of the last received datapacks, by name. Returned when the engine reports a datapack as unchanged
+         */
+        std::map<std::string, DataPackInterfaceConstSharedPtr> _receivedDataPacks;
+
         /*!
          * \brief Send a request to the Server
+         *
+         * The request body is encoded in the wire format set in the engine configuration. The server replies in the same
+         * format, the response body is parsed according to its content type.
+         *
          * \param serverName Name of the server
-         * \param contentType Content Type
          * \param request Body of request
          * \param exceptionMessage Message to put into exception output
          * \return Returns body of response, parsed as JSON
          */
-        static nlohmann::json sendRequest(const std::string &serverName, const std::string &contentType, const std::string &request, const std::string_view &exceptionMessage)
+        nlohmann::json sendRequest(const std::string &serverName, const nlohmann::json &request, const std::string_view &exceptionMessage)
         {
             // Post request to Engine JSON server
             try
             {
-                auto resp = RestClient::post(serverName, contentType, request);
+                auto resp = this->_connection.post(serverName, json_wire_format::contentType(this->_wireFormat).data(),
+                                                   json_wire_format::encode(request, this->_wireFormat));
                 if(resp.code != 200)
                 {
                     throw std::domain_error("Request failed with code " + std::to_string(resp.code) +
@@ -300,7 +353,7 @@ protected:
                                             "Client context message: " + exceptionMessage.data());
                 }
 
-                return nlohmann::json::parse(resp.body);
+                return json_wire_format::decode(resp.body, EngineJSONNRPClient::responseWireFormat(resp));
             }
             catch(std::exception &e)
             {
@@ -308,6 +361,22 @@ protected:
             }
         }
 
+        /*!
+         * \brief Gets the wire format of a response from its Content-Type header
+         * \param resp Server response
+         * \return Returns the response format. Defaults to JSON if the response has no Content-Type header
+         */
+        static JSONWireFormat responseWireFormat(const RestClient::Response &resp)
+        {
+            for(const auto &header : resp.headers)
+            {
+                if(strcasecmp(header.first.c_str(), "Content-Type") == 0)
+                    return json_wire_format::fromContentType(header.second);
+            }
+
+            return JSONWireFormat::JSON;
+        }
+
         /*!
          * \brief Thread function that executes the loop and waits for a result from the engine
          * \param timeStep Time (in seconds) to execute the engine
@@ -320,7 +389,7 @@ protected:
 
             // Post run loop request to Engine JSON server
             nlohmann::json resp(EngineJSONNRPClient::sendRequest(this->_serverAddress + "/" + EngineJSONConfigConst::EngineServerRunLoopStepRoute.data(),
-                                                                 EngineJSONConfigConst::EngineServerContentType.data(), request.dump(),
+                                                                 request,
                                                                  "Engine Server failed during loop execution"));
 
             // Get engine time from response
@@ -345,7 +414,7 @@ protected:
          * \param datapacks JSON data of datapacks
          * \return Returns list of datapacks
          */
-        datapacks_vector_t getDataPackInterfacesFromJSON(const nlohmann::json &datapacks) const
+        datapacks_vector_t getDataPackInterfacesFromJSON(const nlohmann::json &datapacks)
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
@@ -381,12 +450,25 @@ protected:
          * \return Returns pointer to created datapack
          */
 
-        inline DataPackInterfaceConstSharedPtr getSingleDataPackInterfaceFromJSON(const nlohmann::json::const_iterator &datapackData, DataPackIdentifier &datapackID) const
+        inline DataPackInterfaceConstSharedPtr getSingleDataPackInterfaceFromJSON(const nlohmann::json::const_iterator &datapackData, DataPackIdentifier &datapackID)
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
             if(datapackID.Type == JsonDataPack::getType())
             {
+                // The engine sends a marker instead of the data of datapacks which didn't change since they were last
+                // received. A copy of the last received datapack is returned in that case
+
+                if(datapackData->contains(EngineJSONConfigConst::DataPackUnchangedName.data()))
+                {
+                    const auto receivedDataPack = this->_receivedDataPacks.find(datapackID.Name);
+                    if(receivedDataPack == this->_receivedDataPacks.end())
+                        throw NRPException::logCreate("DataPack \"" + datapackID.Name + "\" was reported as unchanged, but it wasn't received before");
+
+                    return DataPackInterfaceConstSharedPtr(receivedDataPack->second->clone());
+                }
+
+
                 // Check whether the requested datapack has new data
                 // A datapack that has no data will contain two JSON objects with "engine_name" and "type" keys (parts of datapack ID)
 
@@ -402,6 +484,8 @@ protected:
                 DataPackInterfaceSharedPtr newDataPack(new JsonDataPack(datapackID.Name, datapackID.EngineName, data));
                 newDataPack->setEngineName(this->engineName());
 
+                this->_receivedDataPacks[datapackID.Name] = DataPackInterfaceConstSharedPtr(newDataPack->clone());
+
                 return newDataPack;
             }
             else
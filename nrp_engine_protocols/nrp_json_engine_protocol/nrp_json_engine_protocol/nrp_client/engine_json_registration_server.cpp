@@ -30,6 +30,7 @@
 #include <restclient-cpp/restclient.h>
 
 std::unique_ptr<EngineJSONRegistrationServer> EngineJSONRegistrationServer::_instance = nullptr;
+std::mutex EngineJSONRegistrationServer::_instanceLock;
 
 EngineJSONRegistrationServer::RequestHandler::RequestHandler(EngineJSONRegistrationServer *pServer)
     : _pServer(pServer)
@@ -200,6 +201,55 @@ std::string EngineJSONRegistrationServer::retrieveEngineAddress(const engine_nam
     return "";
 }
 
+std::string EngineJSONRegistrationServer::retrieveEngineAddressFromInstance(const engine_name_t &engineName)
+{
+    std::scoped_lock lock(EngineJSONRegistrationServer::_instanceLock);
+
+    auto *pRegistrationServer = EngineJSONRegistrationServer::getInstance();
+    if(pRegistrationServer == nullptr)
+        return "";
+
+    const auto engineAddress = pRegistrationServer->retrieveEngineAddress(engineName);
+
+    // Close server if no additional clients are waiting for their engines to register
+    if(!engineAddress.empty() && pRegistrationServer->getNumWaitingEngines() == 0)
+        EngineJSONRegistrationServer::clearInstance();
+
+    return engineAddress;
+}
+
+std::string EngineJSONRegistrationServer::requestEngineFromInstance(const engine_name_t &engineName)
+{
+    std::scoped_lock lock(EngineJSONRegistrationServer::_instanceLock);
+
+    auto *pRegistrationServer = EngineJSONRegistrationServer::getInstance();
+    if(pRegistrationServer == nullptr)
+        throw NRPException::logCreate("Can't request JSON Engine \"" + engineName + "\", the registration server is not running");
+
+    const auto engineAddress = pRegistrationServer->requestEngine(engineName);
+
+    // Close server if the engine was already registered and no additional clients are waiting for their engines to register
+    if(!engineAddress.empty() && pRegistrationServer->getNumWaitingEngines() == 0)
+        EngineJSONRegistrationServer::clearInstance();
+
+    return engineAddress;
+}
+
+void EngineJSONRegistrationServer::cancelEngineRequestFromInstance(const engine_name_t &engineName)
+{
+    std::scoped_lock lock(EngineJSONRegistrationServer::_instanceLock);
+
+    auto *pRegistrationServer = EngineJSONRegistrationServer::getInstance();
+    if(pRegistrationServer == nullptr)
+        return;
+
+    pRegistrationServer->cancelEngineRequest(engineName);
+
+    // Close server if no additional clients are waiting for their engines to register
+    if(pRegistrationServer->getNumWaitingEngines() == 0)
+        EngineJSONRegistrationServer::clearInstance();
+}
+
 std::string EngineJSONRegistrationServer::requestEngine(const engine_name_t &engineName)
 {
     {
@@ -213,6 +263,12 @@ std::string EngineJSONRegistrationServer::requestEngine(const engine_name_t &eng
     return this->retrieveEngineAddress(engineName);
 }
 
+void EngineJSONRegistrationServer::cancelEngineRequest(const engine_name_t &engineName)
+{
+    std::scoped_lock lock(this->_lock);
+    this->_registeredAddresses.erase(engineName);
+}
+
 void EngineJSONRegistrationServer::registerEngineAddress(const engine_name_t &engineName, const std::string &address)
 {
     std::scoped_lock lock(this->_lock);
@@ -137,6 +137,37 @@ class EngineJSONRegistrationServer
          */
         std::string retrieveEngineAddress(const engine_name_t &engineName);
 
+        /*!
+         * \brief Retrieve a registered engine address from the server instance. Once no more engines are waiting for
+         * registration, the instance is deleted
+         *
+         * Contrary to retrieveEngineAddress, it can be called concurrently by several clients sharing the instance
+         *
+         * \param engineName Engine Name for which to find the address
+         * \return If address available, return it. Otherwise return empty string
+         */
+        static std::string retrieveEngineAddressFromInstance(const engine_name_t &engineName);
+
+        /*!
+         * \brief Request an engine's address from the server instance. If the address is already available and no
+         * more engines are waiting for registration, the instance is deleted
+         *
+         * Contrary to requestEngine, it can be called concurrently by several clients sharing the instance
+         *
+         * \param engineName Name of engine to wait for
+         * \return If available, returns the address of the engine. Else, returns empty string
+         * \throws NRPException if the server instance doesn't exist
+         */
+        static std::string requestEngineFromInstance(const engine_name_t &engineName);
+
+        /*!
+         * \brief Stop waiting for the registration of an engine, e.g. after a timeout. Once no more engines are waiting
+         * for registration, the server instance is deleted
+         *
+         * \param engineName Name of engine
+         */
+        static void cancelEngineRequestFromInstance(const engine_name_t &engineName);
+
         /*!
          * \brief Request an engine's address. If available, erases entry from _registeredAddresses
          * \param engineName Name of engine to wait for
@@ -144,6 +175,12 @@ class EngineJSONRegistrationServer
          */
         std::string requestEngine(const engine_name_t &engineName);
 
+        /*!
+         * \brief Remove an engine from the engines waiting for registration
+         * \param engineName Name of engine
+         */
+        void cancelEngineRequest(const engine_name_t &engineName);
+
         /*!
          * \brief Register an engine's address
          * \param engineName Name of engine
@@ -193,6 +230,11 @@ class EngineJSONRegistrationServer
          */
         static std::unique_ptr<EngineJSONRegistrationServer> _instance;
 
+        /*!
+         * \brief Prevents deleting _instance while it is used in the *FromInstance functions
+         */
+        static std::mutex _instanceLock;
+
         /*!
          * \brief Constructor
          * \param address Address under which to make server accessible
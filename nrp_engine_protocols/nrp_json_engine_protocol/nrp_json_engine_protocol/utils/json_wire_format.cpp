@@ -0,0 +1,103 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_json_engine_protocol/utils/json_wire_format.h"
+#include "nrp_json_engine_protocol/config/engine_json_config.h"
+#include "nrp_general_library/utils/nrp_exceptions.h"
+
+JSONWireFormat json_wire_format::fromName(const std::string &name)
+{
+    if(name == "JSON")
+        return JSONWireFormat::JSON;
+    else if(name == "CBOR")
+        return JSONWireFormat::CBOR;
+    else if(name == "MessagePack")
+        return JSONWireFormat::MessagePack;
+
+    throw NRPException::logCreate("Unknown JSON wire format \"" + name + "\". Supported formats are JSON, CBOR and MessagePack");
+}
+
+JSONWireFormat json_wire_format::fromContentType(std::string_view contentType)
+{
+    // Strip parameters and surrounding whitespace
+    contentType = contentType.substr(0, contentType.find(';'));
+    const auto begin = contentType.find_first_not_of(" \t");
+    if(begin == std::string_view::npos)
+        return JSONWireFormat::JSON;
+
+    contentType = contentType.substr(begin, contentType.find_last_not_of(" \t") + 1 - begin);
+
+    if(contentType == EngineJSONConfigConst::EngineServerCBORContentType)
+        return JSONWireFormat::CBOR;
+    else if(contentType == EngineJSONConfigConst::EngineServerMessagePackContentType)
+        return JSONWireFormat::MessagePack;
+
+    return JSONWireFormat::JSON;
+}
+
+std::string_view json_wire_format::contentType(JSONWireFormat format)
+{
+    switch(format)
+    {
+        case JSONWireFormat::CBOR:
+            return EngineJSONConfigConst::EngineServerCBORContentType;
+        case JSONWireFormat::MessagePack:
+            return EngineJSONConfigConst::EngineServerMessagePackContentType;
+        default:
+            return EngineJSONConfigConst::EngineServerContentType;
+    }
+}
+
+std::string json_wire_format::encode(const nlohmann::json &data, JSONWireFormat format)
+{
+    std::string body;
+
+    switch(format)
+    {
+        case JSONWireFormat::CBOR:
+            nlohmann::json::to_cbor(data, body);
+            break;
+        case JSONWireFormat::MessagePack:
+            nlohmann::json::to_msgpack(data, body);
+            break;
+        default:
+            body = data.dump();
+            break;
+    }
+
+    return body;
+}
+
+nlohmann::json json_wire_format::decode(const std::string &body, JSONWireFormat format)
+{
+    switch(format)
+    {
+        case JSONWireFormat::CBOR:
+            return nlohmann::json::from_cbor(body);
+        case JSONWireFormat::MessagePack:
+            return nlohmann::json::from_msgpack(body);
+        default:
+            return nlohmann::json::parse(body);
+    }
+}
+
+// EOF
@@ -0,0 +1,85 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+#ifndef JSON_WIRE_FORMAT_H
+#define JSON_WIRE_FORMAT_H
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <string_view>
+
+/*!
+ * \brief Formats in which JSON objects can be exchanged between EngineJSONNRPClient and EngineJSONServer
+ */
+enum class JSONWireFormat
+{
+    JSON,
+    CBOR,
+    MessagePack
+};
+
+namespace json_wire_format
+{
+    /*!
+     * \brief Gets the wire format from its name in the engine configuration ("JSON", "CBOR" or "MessagePack")
+     * \param name Name of the format
+     * \return Returns the corresponding format. Throws an exception if the name is unknown
+     */
+    JSONWireFormat fromName(const std::string &name);
+
+    /*!
+     * \brief Gets the wire format of a message body from its content type
+     *
+     * Parameters in the content type (e.g. charset) are ignored. Unknown or empty content types are assumed to be JSON,
+     * so that clients and servers which don't set the content type keep working.
+     *
+     * \param contentType Content type of the message body
+     * \return Returns the corresponding format
+     */
+    JSONWireFormat fromContentType(std::string_view contentType);
+
+    /*!
+     * \brief Gets the content type used for message bodies in the given format
+     */
+    std::string_view contentType(JSONWireFormat format);
+
+    /*!
+     * \brief Serializes a JSON object into a message body
+     * \param data JSON object
+     * \param format Wire format
+     * \return Returns the message body
+     */
+    std::string encode(const nlohmann::json &data, JSONWireFormat format);
+
+    /*!
+     * \brief Parses a message body into a JSON object
+     * \param body Message body
+     * \param format Wire format
+     * \return Returns the parsed JSON object. Throws an exception if the body can't be parsed
+     */
+    nlohmann::json decode(const std::string &body, JSONWireFormat format);
+}
+
+#endif // JSON_WIRE_FORMAT_H
+
+// EOF
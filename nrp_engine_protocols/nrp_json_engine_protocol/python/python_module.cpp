@@ -141,12 +141,14 @@ static PyObject * nlohmannJsonGetItem(const nlohmann::json & jsonParent, PyObjec
  * It allows to modify nlohmann::json objects using 'object[key] = value' notation.
  * Json arrays cannot be modified this way.
  *
- * \param[in] json The object of which the method was invoked
+ * \param[in] self The python object of which the method was invoked
  * \param[in] index Key to be modified or created
  * \param[in] value Value to be inserted under the key
  */
-static void nlohmannJsonSetItem(nlohmann::json * jsonParent, PyObject * index, PyObject * value)
+static void nlohmannJsonSetItem(const boost::python::object & self, PyObject * index, PyObject * value)
 {
+    nlohmann::json * jsonParent = &extractForWrite<nlohmann::json>(self);
+
     if(jsonParent->is_array())
     {
         setPythonError(PyExc_IndexError, "setting json array elements not supported");
@@ -234,8 +236,10 @@ static PyObject * nlohmannJsonKeys(const nlohmann::json & json)
 }
 
 
-static void nlohmannJsonAppend(nlohmann::json * jsonParent, PyObject * value)
+static void nlohmannJsonAppend(const boost::python::object & self, PyObject * value)
 {
+    nlohmann::json * jsonParent = &extractForWrite<nlohmann::json>(self);
+
     if(!jsonParent->is_array() && !jsonParent->is_null())
     {
         setPythonError(PyExc_AttributeError,
@@ -262,6 +266,9 @@ BOOST_PYTHON_MODULE(JSON_PYTHON_MODULE_NAME)
     // Import General NRP Python Module
     boost::python::import(PYTHON_MODULE_NAME_STR);
 
+    // nlohmannJsonSetItem and nlohmannJsonAppend are the only methods modifying the object
+    DataPackPythonWrites<nlohmann::json>::enableTracking();
+
     boost::python::class_<nlohmann::json, nlohmann::json*, std::unique_ptr<nlohmann::json>>("NlohmannJson")
         .def("__getitem__", &nlohmannJsonGetItem)
         .def("__setitem__", &nlohmannJsonSetItem)
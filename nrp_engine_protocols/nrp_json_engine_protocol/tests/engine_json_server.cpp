@@ -25,14 +25,50 @@
 #include "nrp_json_engine_protocol/config/engine_json_config.h"
 #include "nrp_json_engine_protocol/engine_server/engine_json_server.h"
 #include "nrp_json_engine_protocol/datapack_interfaces/json_datapack.h"
+#include "nrp_json_engine_protocol/utils/json_wire_format.h"
+#include "nrp_general_library/utils/restclient_setup.h"
 
 #include "tests/test_engine_json_datapack_controllers.h"
 
 #include <future>
+#include <mutex>
+#include <set>
+#include <pistache/endpoint.h>
 #include <restclient-cpp/restclient.h>
 
 using namespace testing;
 
+/*!
+ * \brief Handler recording the client port of every request, i.e. the connection through which it was sent
+ */
+struct ClientPortHandler : Pistache::Http::Handler
+{
+    HTTP_PROTOTYPE(ClientPortHandler);
+
+    struct Ports
+    {
+        std::mutex lock;
+        std::set<uint16_t> ports;
+    };
+
+    explicit ClientPortHandler(Ports *ports)
+        : _ports(ports)
+    {}
+
+    void onRequest(const Pistache::Http::Request& req, Pistache::Http::ResponseWriter response) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_ports->lock);
+            this->_ports->ports.insert(static_cast<uint16_t>(req.address().port()));
+        }
+
+        response.send(Pistache::Http::Code::Ok, "{}");
+    }
+
+    private:
+        Ports *_ports = nullptr;
+};
+
 class TestEngineJSONServer
         : public EngineJSONServer
 {
@@ -148,6 +184,48 @@ TEST(EngineJSONServerTest, Functions)
     ASSERT_EQ(server._datapacksControllers.size(), 0);
 }
 
+struct TestSequenceJSONDataPackController
+        : public TestJSONDataPackController
+{
+    using TestJSONDataPackController::TestJSONDataPackController;
+
+    uint64_t getDataPackSequence() override
+    {
+        return this->sequence;
+    }
+
+    uint64_t sequence = 1;
+};
+
+TEST(EngineJSONServerTest, UnchangedDataPacks)
+{
+    TestEngineJSONServer server("localhost:5434");
+
+    const std::string datapackName = "test_name";
+    const std::string engineName = "test_engine_name";
+    auto controller = TestSequenceJSONDataPackController(JsonDataPack::createID(datapackName, engineName));
+    server.registerDataPack(datapackName, &controller);
+
+    auto request = nlohmann::json();
+    request[datapackName] = {{"engine_name", engineName}};
+
+    // The data is sent the first time
+
+    auto retData = server.getDataPackData(request);
+    ASSERT_TRUE(retData[datapackName].contains("data"));
+    ASSERT_FALSE(retData[datapackName].contains(EngineJSONConfigConst::DataPackUnchangedName.data()));
+
+    // It is replaced by a marker as long as the sequence number doesn't change
+
+    retData = server.getDataPackData(request);
+    ASSERT_FALSE(retData[datapackName].contains("data"));
+    ASSERT_EQ(retData[datapackName][EngineJSONConfigConst::DataPackUnchangedName.data()], 1);
+
+    controller.sequence = 2;
+    retData = server.getDataPackData(request);
+    ASSERT_TRUE(retData[datapackName].contains("data"));
+}
+
 TEST(EngineJSONServerTest, HttpRequests)
 {
     const std::string address = "localhost:5434";
@@ -201,3 +279,88 @@ TEST(EngineJSONServerTest, HttpRequests)
     // We should get the same value as was set by the setDataPacks function above
     ASSERT_EQ(retData[datapackName]["data"       ], 2);
 }
+
+TEST(EngineJSONServerTest, BinaryWireFormats)
+{
+    TestEngineJSONServer server("localhost:5434");
+    const std::string address = server.serverAddress();
+
+    const std::string datapackName = "test_name";
+    const std::string engineName = "test_engine_name";
+    auto devData = new nlohmann::json({{datapackName, {{"data", 1}}}});
+    auto dev1 = JsonDataPack(datapackName, engineName, devData);
+
+    auto dev1Ctrl = TestJSONDataPackController(DataPackIdentifier(dev1.id()));
+    server.registerDataPack(dev1.name(), &dev1Ctrl);
+
+    for(const auto format : {JSONWireFormat::CBOR, JSONWireFormat::MessagePack})
+    {
+        const std::string contentType(json_wire_format::contentType(format));
+
+        // Set datapack data. The array should be sent back unchanged
+        const nlohmann::json spikes = {0.1, 0.25, 1.5, 1e-3};
+        auto request = nlohmann::json();
+        request[datapackName] = {{"engine_name", engineName}, {"data", spikes}};
+        auto resp = RestClient::post(address + "/" + EngineJSONConfigConst::EngineServerSetDataPacksRoute.data(), contentType, json_wire_format::encode(request, format));
+        ASSERT_EQ(resp.code, 200);
+
+        // Get datapack data. The response must be encoded in the same format as the request
+        request.clear();
+        request[datapackName] = {{"engine_name", engineName}};
+        resp = RestClient::post(address + "/" + EngineJSONConfigConst::EngineServerGetDataPacksRoute.data(), contentType, json_wire_format::encode(request, format));
+        ASSERT_EQ(resp.code, 200);
+        ASSERT_EQ(json_wire_format::fromContentType(resp.headers["Content-Type"]), format);
+
+        const auto retData = json_wire_format::decode(resp.body, format);
+        ASSERT_TRUE(retData.contains(datapackName));
+        ASSERT_EQ(retData[datapackName]["engine_name"], engineName);
+        ASSERT_EQ(retData[datapackName]["data"], spikes);
+    }
+
+    // Unknown content types are handled as JSON
+    ASSERT_EQ(json_wire_format::fromContentType("application/json; charset=utf-8"), JSONWireFormat::JSON);
+    ASSERT_EQ(json_wire_format::fromContentType(""), JSONWireFormat::JSON);
+    ASSERT_EQ(json_wire_format::fromContentType(" application/cbor "), JSONWireFormat::CBOR);
+    ASSERT_THROW(json_wire_format::fromName("XML"), NRPException);
+}
+
+TEST(EngineJSONServerTest, PersistentConnection)
+{
+    TestEngineJSONServer server("localhost:5434");
+    const std::string address = server.serverAddress();
+
+    // Consecutive requests are sent through the same connection
+    RestClientConnection connection;
+    const SimulationTime runTime = toSimulationTime<int, std::milli>(1);
+    for(int i = 1; i <= 3; ++i)
+    {
+        const nlohmann::json data = {{EngineJSONConfigConst::EngineTimeStepName.data(), runTime.count()}};
+        const auto resp = connection.post(address + "/" + EngineJSONConfigConst::EngineServerRunLoopStepRoute.data(),
+                                          EngineJSONConfigConst::EngineServerContentType.data(), data.dump());
+        ASSERT_EQ(resp.code, 200);
+        ASSERT_EQ(nlohmann::json::parse(resp.body)[EngineJSONConfigConst::EngineTimeName.data()], (runTime*i).count());
+    }
+
+    ASSERT_EQ(server.curTime, runTime*3);
+
+    // All requests sent through a RestClientConnection come from the same client port, RestClient::post opens a new
+    // connection every time
+    ClientPortHandler::Ports ports;
+    Pistache::Http::Endpoint endpoint(Pistache::Address("localhost", Pistache::Port(0)));
+    endpoint.init(Pistache::Http::Endpoint::options().threads(1));
+    endpoint.setHandler(Pistache::Http::make_handler<ClientPortHandler>(&ports));
+    endpoint.serveThreaded();
+
+    const std::string countAddress = "localhost:" + endpoint.getPort().toString();
+    for(int i = 0; i < 3; ++i)
+        ASSERT_EQ(connection.post(countAddress, "application/json", "{}").code, 200);
+
+    ASSERT_EQ(ports.ports.size(), 1);
+
+    for(int i = 0; i < 3; ++i)
+        ASSERT_EQ(RestClient::post(countAddress, "application/json", "{}").code, 200);
+
+    ASSERT_EQ(ports.ports.size(), 4);
+
+    endpoint.shutdown();
+}
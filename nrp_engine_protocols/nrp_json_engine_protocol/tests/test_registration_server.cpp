@@ -84,4 +84,54 @@ TEST_F(RegistrationServer, TryInitializePortTakenRetry)
     ASSERT_TRUE(result.find(std::to_string(port)) == std::string::npos);
 }
 
+TEST_F(RegistrationServer, RetrieveEngineAddressFromInstance)
+{
+    EngineJSONRegistrationServer::tryInstantiate(address, 0);
+    auto *pRegistrationServer = EngineJSONRegistrationServer::getInstance();
+
+    ASSERT_EQ(pRegistrationServer->requestEngine("engine1"), "");
+    ASSERT_EQ(pRegistrationServer->requestEngine("engine2"), "");
+
+    // No address registered yet
+
+    ASSERT_EQ(EngineJSONRegistrationServer::retrieveEngineAddressFromInstance("engine1"), "");
+
+    // The instance is kept while other engines are still waiting for registration
+
+    pRegistrationServer->registerEngineAddress("engine1", "localhost:1234");
+    ASSERT_EQ(EngineJSONRegistrationServer::retrieveEngineAddressFromInstance("engine1"), "localhost:1234");
+    ASSERT_EQ(EngineJSONRegistrationServer::getInstance(), pRegistrationServer);
+
+    // The instance is deleted once the last engine address is retrieved
+
+    pRegistrationServer->registerEngineAddress("engine2", "localhost:1235");
+    ASSERT_EQ(EngineJSONRegistrationServer::retrieveEngineAddressFromInstance("engine2"), "localhost:1235");
+    ASSERT_EQ(EngineJSONRegistrationServer::getInstance(), nullptr);
+
+    ASSERT_EQ(EngineJSONRegistrationServer::retrieveEngineAddressFromInstance("engine2"), "");
+}
+
+TEST_F(RegistrationServer, RequestEngineFromInstance)
+{
+    ASSERT_THROW(EngineJSONRegistrationServer::requestEngineFromInstance("engine1"), NRPException);
+
+    EngineJSONRegistrationServer::tryInstantiate(address, 0);
+
+    ASSERT_EQ(EngineJSONRegistrationServer::requestEngineFromInstance("engine1"), "");
+    ASSERT_EQ(EngineJSONRegistrationServer::requestEngineFromInstance("engine2"), "");
+    ASSERT_THROW(EngineJSONRegistrationServer::requestEngineFromInstance("engine2"), NRPException);
+
+    // The instance is kept while other engines are still waiting for registration
+
+    EngineJSONRegistrationServer::cancelEngineRequestFromInstance("engine1");
+    ASSERT_NE(EngineJSONRegistrationServer::getInstance(), nullptr);
+
+    // The instance is deleted once no engine is waiting for registration
+
+    EngineJSONRegistrationServer::cancelEngineRequestFromInstance("engine2");
+    ASSERT_EQ(EngineJSONRegistrationServer::getInstance(), nullptr);
+
+    EngineJSONRegistrationServer::cancelEngineRequestFromInstance("engine2");
+}
+
 // EOF
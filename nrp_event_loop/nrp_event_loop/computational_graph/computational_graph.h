@@ -24,6 +24,7 @@
 
 #include "nrp_general_library/utils/nrp_exceptions.h"
 #include "nrp_general_library/utils/nrp_logger.h"
+#include "nrp_general_library/utils/thread_pool.h"
 #include "nrp_event_loop/computational_graph/ngraph/ngraph.hpp"
 #include "nrp_event_loop/computational_graph/computational_node.h"
 
@@ -49,6 +50,12 @@
  * with no inputs. For convenience, the latter are moved to the second layer (with no consequences) and the first
  * layer is kept with 'Input' nodes only.
  * In the same way, all 'Output' nodes are moved to a separate layer which is executed the last.
+ *
+ * Optionally, the nodes in each layer can be executed concurrently using a pool of worker threads (see 'setNumThreads').
+ * For this purpose, each layer is split into lanes, i.e. groups of nodes which are executed sequentially:
+ * - nodes publishing to the same target node share a lane, since delivering a msg modifies the target node
+ * - nodes requiring the Python GIL, or publishing to nodes which require it, share the first lane, which is always
+ *   executed in the thread calling 'compute'
  */
 class ComputationalGraph :
         private NGraph::tGraph<ComputationalNode *>
@@ -57,6 +64,9 @@ public:
 
     typedef std::vector<ComputationalGraph::vertex> comp_layer;
 
+    /*! \brief Layer split into groups of nodes that can be executed concurrently. See 'setLayerLanes' */
+    typedef std::vector<comp_layer> comp_lanes;
+
     enum GraphState {EMPTY, CONFIGURING, READY, COMPUTING};
 
     enum ExecMode {ALL_NODES, OUTPUT_DRIVEN};
@@ -133,6 +143,14 @@ public:
             if (checkForCycles())
                 throw NRPException::logCreate("Cycle(s) found in the graph. Cycles are not supported");
 
+            // Split layers into lanes for concurrent execution
+            setLayerLanes(_inputLayer, _inputLanes);
+            for (const auto &l: _compLayers) {
+                _compLanes.emplace_back();
+                setLayerLanes(l, _compLanes.back());
+            }
+            setLayerLanes(_outputLayer, _outputLanes);
+
 
             this->_state = GraphState::READY;
         }
@@ -160,26 +178,15 @@ public:
         sendCycleStartSignal();
         
         try {
-            // TODO: each of these loops could be possibly parallelized
-
             // Input nodes are always executed, regardless of the execution mode
-            for (auto &node: _inputLayer)
-                node->compute();
+            computeLayer(_inputLayer, _inputLanes, true);
 
             // Functional nodes and output nodes are executed if they have been marked for execution or the CG is
             // being run in input controlled execution mode
-            for (auto &layer: _compLayers)
-                for (auto &node: layer)
-                    if (this->_execMode == ExecMode::ALL_NODES || node->doCompute()) {
-                        node->compute();
-                        node->setDoCompute(false);
-                    }
-
-            for (auto &node: _outputLayer)
-                if (this->_execMode == ExecMode::ALL_NODES || node->doCompute()) {
-                    node->compute();
-                    node->setDoCompute(false);
-                }
+            for (size_t i = 0; i < _compLayers.size(); ++i)
+                computeLayer(_compLayers[i], _compLanes[i], this->_execMode == ExecMode::ALL_NODES);
+
+            computeLayer(_outputLayer, _outputLanes, this->_execMode == ExecMode::ALL_NODES);
 
             this->_state = GraphState::READY;
         }
@@ -206,8 +213,51 @@ public:
     ExecMode getExecMode()
     { return _execMode; }
 
+    /*!
+     * \brief Sets the number of worker threads used to execute nodes in the same layer concurrently
+     *
+     * Worker threads are used in addition to the thread calling 'compute'. If 0, all nodes are executed sequentially
+     * in the thread calling 'compute'
+     */
+    void setNumThreads(size_t numThreads)
+    {
+        if( this->_state == GraphState::COMPUTING)
+            throw NRPException::logCreate("Graph number of threads can't be changed while computing");
+
+        _threadPool.reset(numThreads > 0 ? new ThreadPool(numThreads) : nullptr);
+    }
+
+    size_t getNumThreads() const
+    { return _threadPool ? _threadPool->size() : 0; }
+
 private:
 
+    /*!
+     * \brief Executes the nodes in 'layer'
+     *
+     * If worker threads are available, 'lanes' are executed concurrently. The first lane is executed in the calling
+     * thread. If any node throws, the exception is rethrown after all lanes have finished.
+     *
+     * \param layer Nodes to execute
+     * \param lanes 'layer' split into lanes
+     * \param computeAll If true, nodes are executed even if they are not marked for execution
+     */
+    void computeLayer(const comp_layer& layer, const comp_lanes& lanes, bool computeAll)
+    {
+        auto computeLane = [computeAll] (const comp_layer& lane) {
+            for (auto &node: lane)
+                if (computeAll || node->doCompute()) {
+                    node->compute();
+                    node->setDoCompute(false);
+                }
+        };
+
+        if (_threadPool && lanes.size() > 1)
+            _threadPool->parallelFor(lanes.size(), [&] (size_t i) { computeLane(lanes[i]); });
+        else
+            computeLane(layer);
+    }
+
     void sendCycleStartSignal()
     {
         // Inform OutputNodes that it is a new execution cycle, currently they are the only type of nodes using this
@@ -239,6 +289,90 @@ private:
         _inputLayer.clear();
         _outputLayer.clear();
         _compLayers.clear();
+        _inputLanes.clear();
+        _outputLanes.clear();
+        _compLanes.clear();
+    }
+
+    /*!
+     * \brief Returns true if 'v' or any of the nodes it publishes to requires the Python GIL
+     *
+     * Msgs are converted in the publishing thread, hence nodes publishing to a node requiring the GIL require it as well
+     */
+    bool requiresGIL(const ComputationalGraph::vertex& v)
+    {
+        if(v->requiresGIL())
+            return true;
+
+        for(const auto &o : this->out_neighbors(v))
+            if(o->requiresGIL())
+                return true;
+
+        return false;
+    }
+
+    /*!
+     * \brief Splits 'layer' into lanes, i.e. groups of nodes which can be executed concurrently with each other
+     *
+     * Nodes publishing to the same target node are placed in the same lane. All nodes requiring the Python GIL are
+     * placed in the first lane. The order of nodes in 'layer' is preserved within each lane.
+     */
+    void setLayerLanes(const comp_layer& layer, comp_lanes& lanes)
+    {
+        // Disjoint sets of node indices in 'layer'. Index layer.size() represents the set of nodes requiring the GIL
+        std::vector<size_t> parent(layer.size() + 1);
+        for(size_t i = 0; i < parent.size(); ++i)
+            parent[i] = i;
+
+        auto find = [&parent] (size_t i) {
+            while(parent[i] != i)
+                i = parent[i] = parent[parent[i]];
+            return i;
+        };
+
+        // Join in a set with the greatest index as root, so the GIL set keeps its index
+        auto join = [&] (size_t a, size_t b) {
+            a = find(a);
+            b = find(b);
+            if(a < b)
+                parent[a] = b;
+            else
+                parent[b] = a;
+        };
+
+        const size_t gilSet = layer.size();
+        std::map<ComputationalGraph::vertex, size_t> targetOwner;
+        for(size_t i = 0; i < layer.size(); ++i) {
+            if(requiresGIL(layer[i]))
+                join(i, gilSet);
+
+            for(const auto &o : this->out_neighbors(layer[i])) {
+                auto owner = targetOwner.emplace(o, i);
+                if(!owner.second)
+                    join(i, owner.first->second);
+            }
+        }
+
+        // Build lanes, GIL lane always first
+        lanes.assign(1, comp_layer());
+        std::map<size_t, size_t> setLane;
+        for(size_t i = 0; i < layer.size(); ++i) {
+            auto set = find(i);
+            if(set == gilSet) {
+                lanes.front().push_back(layer[i]);
+                continue;
+            }
+
+            auto lane = setLane.emplace(set, lanes.size());
+            if(lane.second)
+                lanes.emplace_back();
+
+            lanes[lane.first->second].push_back(layer[i]);
+        }
+
+        // An empty first lane would leave the calling thread idle
+        if(lanes.front().empty())
+            lanes.erase(lanes.begin());
     }
 
     /*!
@@ -329,10 +463,16 @@ private:
     comp_layer _outputLayer;
     std::vector<comp_layer> _compLayers;
 
+    comp_lanes _inputLanes;
+    comp_lanes _outputLanes;
+    std::vector<comp_lanes> _compLanes;
+
     GraphState _state = GraphState::EMPTY;
 
     ExecMode _execMode = ExecMode::ALL_NODES;
 
+    /*! \brief Worker threads used to execute the lanes of each layer concurrently. If null, nodes are executed sequentially */
+    std::unique_ptr<ThreadPool> _threadPool;
 
 };
 
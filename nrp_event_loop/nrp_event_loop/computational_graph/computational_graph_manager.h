@@ -163,6 +163,12 @@ public:
     ComputationalGraph::ExecMode getExecMode()
     { return _graph.getExecMode(); }
 
+    void setNumThreads(size_t numThreads)
+    { _graph.setNumThreads(numThreads); }
+
+    size_t getNumThreads() const
+    { return _graph.getNumThreads(); }
+
 private:
 
     ComputationalGraphManager() = default;
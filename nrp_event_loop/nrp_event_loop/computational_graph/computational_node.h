@@ -96,6 +96,15 @@ public:
     virtual bool doCompute() const
     { return _doCompute; }
 
+    /*!
+     * \brief Tells if this node handles python objects, and thus must be executed by a thread holding the Python GIL
+     *
+     * It is used by ComputationalGraph to decide which nodes can be executed in worker threads. ComputationalNode returns
+     * false, subclasses handling python objects must return true
+     */
+    virtual bool requiresGIL() const
+    { return false; }
+
     /*!
      * \brief Parses a computational node address returning the node id and the port (if any) contained in the address
      *
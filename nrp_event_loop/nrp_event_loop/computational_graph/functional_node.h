@@ -345,6 +345,15 @@ public:
         return nullptr;
     }
 
+    /*!
+     * \brief Returns true if any of the node inputs or outputs is a python object
+     */
+    bool requiresGIL() const override
+    {
+        return (std::is_same_v<INPUT_TYPES, boost::python::object> || ...) ||
+               (std::is_same_v<OUTPUT_TYPES, boost::python::object> || ...);
+    }
+
 protected:
 
     /*!
@@ -26,6 +26,8 @@
 #include <map>
 #include <iostream>
 
+#include <boost/python.hpp>
+
 #include "nrp_general_library/utils/nrp_logger.h"
 
 #include "nrp_event_loop/computational_graph/computational_node_policies.h"
@@ -177,6 +179,9 @@ public:
     void setMsgCachePolicy(InputNodePolicies::MsgCachePolicy msgCachePolicy)
     { _msgCachePolicy = msgCachePolicy; }
 
+    bool requiresGIL() const override
+    { return std::is_same_v<DATA, boost::python::object>; }
+
 protected:
 
     /*!
@@ -112,6 +112,9 @@ public:
     virtual bool doCompute() const override final
     { return  ComputationalNode::doCompute() || (_computePeriod != 0 && (_nLoop-1) % _computePeriod == 0); }
 
+    bool requiresGIL() const override
+    { return std::is_same_v<DATA, boost::python::object>; }
+
 protected:
 
     void configure() override
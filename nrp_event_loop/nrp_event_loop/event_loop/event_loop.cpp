@@ -30,12 +30,13 @@
 #include "nrp_event_loop/utils/graph_utils.h"
 
 EventLoop::EventLoop(const nlohmann::json &graph_config, std::chrono::milliseconds timestep, std::chrono::milliseconds timestepThres,
-                     ComputationalGraph::ExecMode execMode, bool ownGIL, bool spinROS) :
+                     ComputationalGraph::ExecMode execMode, bool ownGIL, bool spinROS, size_t numThreads) :
         EventLoopInterface(timestep, timestepThres),
     _graph_config(graph_config),
     _execMode(execMode),
     _ownGIL(ownGIL),
-    _spinROS(spinROS)
+    _spinROS(spinROS),
+    _numThreads(numThreads)
 {
     this->initialize();
 }
@@ -51,6 +52,7 @@ void EventLoop::initializeCB()
     try {
         boost::python::dict globalDict;
         createPythonGraphFromConfig(_graph_config, _execMode, globalDict);
+        ComputationalGraphManager::getInstance().setNumThreads(_numThreads);
     }
     catch (std::exception& e) {
         if(!_ownGIL)
@@ -47,7 +47,7 @@ class EventLoop : public EventLoopInterface
          */
         EventLoop(const nlohmann::json &graph_config, std::chrono::milliseconds timestep, std::chrono::milliseconds timestepThres,
                   ComputationalGraph::ExecMode execMode = ComputationalGraph::ExecMode::ALL_NODES,
-                  bool ownGIL = true, bool spinROS = false);
+                  bool ownGIL = true, bool spinROS = false, size_t numThreads = 0);
 
         ~EventLoop();
 
@@ -69,6 +69,8 @@ class EventLoop : public EventLoopInterface
         bool _ownGIL;
         /*! \brief if true ros::spin is called in every loop  */
         bool _spinROS;
+        /*! \brief Number of worker threads used to execute the Computational Graph. 0 means sequential execution  */
+        size_t _numThreads;
         /*! \brief GIL state object used to request the GIL ownership when needed  */
         PyGILState_STATE _pyGILState;
         /*! \brief Pointer to the clock_node of the graph */
@@ -75,11 +75,11 @@ void EventLoopEngine::runLoopCB()
     }
     // Advance Engine
     this->_engineWrapper->runLoopStep(std::chrono::duration_cast<SimulationTime>(this->_timestep));
-    // Get and publish datapacks
+    // Get and publish datapacks. Subscribers can't substitute "unchanged" markers, the data is always sent
     for(const auto& dpName : _datapackNames) {
         _datapackPub->clear_datapackid();
         _datapackPub->clear_data();
-        if(this->_engineWrapper->getDataPack(dpName, _datapackPub.get()))
+        if(this->_engineWrapper->getDataPack(dpName, _datapackPub.get(), false))
             _mqttProxy->publish(datapackTopicGet(dpName), _datapackPub->SerializeAsString());
     }
 
@@ -186,6 +186,74 @@ TEST(ComputationalGraph, COMPUTATIONAL_GRAPH)
     cg.clear();
 }
 
+TEST(ComputationalGraph, PARALLEL_EXECUTION)
+{
+    auto i1 = std::make_shared<TestParallelNode>("i1", ComputationalNode::Input);
+    auto i2 = std::make_shared<TestParallelNode>("i2", ComputationalNode::Input);
+    auto f1 = std::make_shared<TestParallelNode>("f1", ComputationalNode::Functional);
+    auto f2 = std::make_shared<TestParallelNode>("f2", ComputationalNode::Functional);
+    auto f3 = std::make_shared<TestParallelNode>("f3", ComputationalNode::Functional);
+    auto py = std::make_shared<TestParallelNode>("py", ComputationalNode::Functional, true);
+    auto f4 = std::make_shared<TestParallelNode>("f4", ComputationalNode::Functional);
+    auto o1 = std::make_shared<TestParallelNode>("o1", ComputationalNode::Output);
+    auto o2 = std::make_shared<TestParallelNode>("o2", ComputationalNode::Output);
+    std::vector<std::shared_ptr<TestParallelNode>> nodes = {i1, i2, f1, f2, f3, py, f4, o1, o2};
+
+    ComputationalGraph cg;
+
+    cg.insert_edge(i1.get(), f1.get());
+    cg.insert_edge(i1.get(), f2.get());
+    cg.insert_edge(i1.get(), f3.get());
+    cg.insert_edge(i2.get(), py.get());
+    cg.insert_edge(f2.get(), f4.get());
+    cg.insert_edge(f3.get(), f4.get());
+    cg.insert_edge(f1.get(), o1.get());
+    cg.insert_edge(py.get(), o2.get());
+    cg.insert_edge(f4.get(), o2.get());
+
+    cg.configure();
+
+    ASSERT_EQ(cg.getNumThreads(), 0u);
+    cg.setNumThreads(2);
+    ASSERT_EQ(cg.getNumThreads(), 2u);
+
+    TestParallelNode::maxRunning = 0;
+    cg.compute();
+    ASSERT_EQ(cg.getState(), ComputationalGraph::READY);
+
+    for(auto& n : nodes)
+        ASSERT_EQ(n->nComputes, 1);
+
+    // Nodes in the same layer run concurrently
+    ASSERT_GT(TestParallelNode::maxRunning, 1);
+
+    // Nodes requiring the GIL, and nodes publishing to them, run in the calling thread
+    ASSERT_EQ(py->threadId, std::this_thread::get_id());
+    ASSERT_EQ(i2->threadId, std::this_thread::get_id());
+
+    // Nodes publishing to the same node run in the same lane
+    ASSERT_EQ(f2->threadId, f3->threadId);
+
+    // Exceptions are rethrown once the layer has finished
+    f1->doThrow = true;
+    ASSERT_THROW(cg.compute(), NRPException);
+    ASSERT_EQ(cg.getState(), ComputationalGraph::READY);
+    ASSERT_EQ(f3->nComputes, 2);
+    ASSERT_EQ(o1->nComputes, 1);
+    f1->doThrow = false;
+
+    // Sequential execution
+    cg.setNumThreads(0);
+    ASSERT_EQ(cg.getNumThreads(), 0u);
+    TestParallelNode::maxRunning = 0;
+    cg.compute();
+    ASSERT_EQ(TestParallelNode::maxRunning, 1);
+    for(auto& n : nodes)
+        ASSERT_EQ(n->threadId, std::this_thread::get_id());
+
+    cg.clear();
+}
+
 TEST(ComputationalGraph, COMPUTATIONAL_GRAPH_MANAGER)
 {
     ComputationalGraphManager::resetInstance();
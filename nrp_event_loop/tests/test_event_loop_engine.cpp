@@ -47,8 +47,13 @@ public:
         // throws bad_cast
         const auto &j = dynamic_cast<const EngineTest::TestPayload &>(data);
         _data->CopyFrom(j);
+        _sequence.modified();
     }
 
+    // The data only changes when it is set, it is the same in every engine step
+    virtual uint64_t getDataPackSequence() override
+    { return _sequence.update(0); }
+
     virtual google::protobuf::Message *getDataPackInformation() override
     {
         auto old_data = _data;
@@ -59,6 +64,7 @@ public:
 
 private:
     EngineTest::TestPayload* _data;
+    DataPackStepSequence _sequence;
 };
 
 
@@ -134,10 +140,14 @@ TEST(EventLoop, EVENT_LOOP_ENGINE) {
     const std::string dpSubTopic = engine->getEngineName() + "/set/" + engine->dpName;
     const std::string dpPubTopic = engine->getEngineName() + "/get/" + engine->dpName;
 
+    // Subscribers can't handle "unchanged" markers, published datapacks must always contain the data
     std::string msg = "";
+    std::atomic<int> markerMsgs = 0;
     NRPMQTTProxy::getInstance().subscribe(dpPubTopic, [&] (const std::string& msgStr) {
         EngineGrpc::DataPackMessage m;
         m.ParseFromString(msgStr);
+        if(!m.data().Is<EngineTest::TestPayload>())
+            ++markerMsgs;
         EngineTest::TestPayload d;
         m.data().UnpackTo(&d);
         msg = d.str();
@@ -183,6 +193,8 @@ TEST(EventLoop, EVENT_LOOP_ENGINE) {
     ASSERT_EQ(msg, "test_3_value");
 
     ele.stopLoop();
+    ASSERT_GT(engine->runLoopCalls, 2);
+    ASSERT_EQ(markerMsgs, 0);
 
     // shutdown
     ele.shutdown();
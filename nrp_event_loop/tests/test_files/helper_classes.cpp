@@ -29,4 +29,7 @@ std::mutex TestNode::m;
 std::condition_variable TestNode::cv;
 bool TestNode::isExecuting = false;
 
+std::atomic<int> TestParallelNode::running = 0;
+std::atomic<int> TestParallelNode::maxRunning = 0;
+
 // EOF
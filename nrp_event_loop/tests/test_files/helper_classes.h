@@ -20,6 +20,7 @@
 // Agreement No. 945539 (Human Brain Project SGA3).
 //
 
+#include <atomic>
 #include <chrono>
 #include <thread>
 #include <mutex>
@@ -97,6 +98,48 @@ public:
     bool isConfigured = false;
 };
 
+class TestParallelNode : public ComputationalNode {
+public:
+
+    static std::atomic<int> running;
+    static std::atomic<int> maxRunning;
+
+    TestParallelNode(const std::string &id, NodeType type, bool gil = false) :
+            ComputationalNode(id, type),
+            _gil(gil)
+    {}
+
+    void configure() override
+    { }
+
+    void compute() override
+    {
+        int r = ++running;
+        int m = maxRunning;
+        while(r > m && !maxRunning.compare_exchange_weak(m, r));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        threadId = std::this_thread::get_id();
+        nComputes++;
+        running--;
+
+        if(doThrow)
+            throw NRPException::logCreate("Node \"" + this->id() + "\" failed");
+    }
+
+    bool requiresGIL() const override
+    { return _gil; }
+
+    std::thread::id threadId;
+    int nComputes = 0;
+    bool doThrow = false;
+
+private:
+
+    bool _gil;
+};
+
 class TestInputNode : public InputNode<TestMsg> {
 public:
 
@@ -25,7 +25,7 @@
 #include <gazebo/gazebo.hh>
 #include <gazebo/physics/JointController.hh>
 #include <gazebo/physics/Joint.hh>
-#include "nrp_general_library/engine_interfaces/datapack_controller.h"
+#include "nrp_protobuf/proto_ops/arena_datapack_controller.h"
 #include "nrp_protobuf/engine_grpc.grpc.pb.h"
 #include "nrp_protobuf/gazebo.pb.h"
 
@@ -35,7 +35,7 @@ namespace gazebo
      * \brief Interface for a single joint
      */
     class JointGrpcDataPackController
-            : public DataPackController<google::protobuf::Message>
+            : public ArenaDataPackController
     {
         public:
         JointGrpcDataPackController(const std::string &jointName, const physics::JointPtr &joint, const physics::JointControllerPtr &jointController)
@@ -57,11 +57,18 @@ namespace gazebo
 
                 if(!std::isnan(j.effort()))
                     this->_joint->SetForce(0, j.effort());
+
+                this->_sequence.modified();
+            }
+
+            virtual uint64_t getDataPackSequence() override
+            {
+                return this->_sequence.update(this->_joint->GetWorld()->Iterations());
             }
 
             virtual google::protobuf::Message *getDataPackInformation() override
             {
-                auto l = new Gazebo::Joint();
+                auto l = this->createMessage<Gazebo::Joint>();
             
                 l->set_position(this->_joint->Position(0));
                 l->set_velocity(this->_joint->GetVelocity(0));
@@ -86,6 +93,11 @@ namespace gazebo
              * \brief Pointer to joint controller of the joint's model
              */
             physics::JointControllerPtr _jointController = nullptr;
+
+            /*!
+             * \brief Sequence number of the joint state, which changes with every physics iteration
+             */
+            DataPackStepSequence _sequence;
     };
 }
 
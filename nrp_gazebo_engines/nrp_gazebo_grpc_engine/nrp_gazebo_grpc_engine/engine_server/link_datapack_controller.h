@@ -24,7 +24,7 @@
 
 #include <gazebo/gazebo.hh>
 #include <gazebo/physics/Link.hh>
-#include "nrp_general_library/engine_interfaces/datapack_controller.h"
+#include "nrp_protobuf/proto_ops/arena_datapack_controller.h"
 #include "nrp_protobuf/engine_grpc.grpc.pb.h"
 #include "nrp_protobuf/gazebo.pb.h"
 
@@ -34,7 +34,7 @@ namespace gazebo
      * \brief Interface for links
      */
     class LinkGrpcDataPackController
-            : public DataPackController<google::protobuf::Message>
+            : public ArenaDataPackController
     {
             template<class T>
             constexpr static float ToFloat(const T &val)
@@ -49,9 +49,14 @@ namespace gazebo
             virtual void handleDataPackData(const google::protobuf::Message &data) override
             {}
 
+            virtual uint64_t getDataPackSequence() override
+            {
+                return this->_sequence.update(this->_link->GetWorld()->Iterations());
+            }
+
             virtual google::protobuf::Message *getDataPackInformation() override
             {
-                auto l = new Gazebo::Link();
+                auto l = this->createMessage<Gazebo::Link>();
 
                 const auto &pose = this->_link->WorldCoGPose();
                 l->add_position(ToFloat(pose.Pos().X()));
@@ -86,6 +91,11 @@ namespace gazebo
              * \brief Pointer to link
              */
             physics::LinkPtr _link;
+
+            /*!
+             * \brief Sequence number of the link state, which changes with every physics iteration
+             */
+            DataPackStepSequence _sequence;
     };
 }
 
@@ -24,7 +24,7 @@
 
 #include <gazebo/gazebo.hh>
 #include <gazebo/physics/Model.hh>
-#include "nrp_general_library/engine_interfaces/datapack_controller.h"
+#include "nrp_protobuf/proto_ops/arena_datapack_controller.h"
 #include "nrp_general_library/utils/nrp_exceptions.h"
 #include "nrp_protobuf/engine_grpc.grpc.pb.h"
 #include "nrp_protobuf/gazebo.pb.h"
@@ -35,7 +35,7 @@ namespace gazebo
      * \brief Interface for Models
      */
     class ModelGrpcDataPackController
-            : public DataPackController<google::protobuf::Message>
+            : public ArenaDataPackController
     {
             template<class T>
             constexpr static float ToFloat(const T &val)
@@ -52,6 +52,7 @@ namespace gazebo
             {
                 // throws bad_cast
                 const auto &l = dynamic_cast<const Gazebo::Model &>(data);
+                this->_sequence.modified();
 
                 // Set Pose
                 if(l.position_size() || l.rotation_size()) {
@@ -100,9 +101,14 @@ namespace gazebo
                     throw NRPException::logCreate("Model msg angular velocity wrong");
             }
 
+            virtual uint64_t getDataPackSequence() override
+            {
+                return this->_sequence.update(this->_model->GetWorld()->Iterations());
+            }
+
             virtual google::protobuf::Message *getDataPackInformation() override
             {
-                auto l = new Gazebo::Model();
+                auto l = this->createMessage<Gazebo::Model>();
 
                 const auto &pose = this->_model->WorldPose();
                 l->add_position(ToFloat(pose.Pos().X()));
@@ -137,6 +143,11 @@ namespace gazebo
              * \brief Pointer to model
              */
             physics::ModelPtr _model;
+
+            /*!
+             * \brief Sequence number of the model state, which changes with every physics iteration
+             */
+            DataPackStepSequence _sequence;
     };
 }
 
@@ -23,6 +23,7 @@
 #define DATA_DATAPACK_H
 
 #include "nrp_general_library/datapack_interface/datapack_interface.h"
+#include "nrp_general_library/datapack_interface/datapack_data.h"
 #include "nrp_general_library/utils/nrp_exceptions.h"
 #include <boost/python.hpp>
 
@@ -31,6 +32,9 @@
  *
  * The class must be specialized by providing a template argument. The argument
  * defines what data class will be stored in the datapack objects.
+ *
+ * The data is copy-on-write: clone() shares it with the original DataPack, and a DataPack only copies it
+ * when a mutable reference is requested through getMutableData() while the data is shared (see DataPackData).
  */
 template< class DATA_TYPE>
 class DataPack : public DataPackInterface
@@ -38,11 +42,21 @@ class DataPack : public DataPackInterface
 public:
 
     DataPack(const std::string &name, const std::string &engineName, DATA_TYPE* data_)
-    : DataPackInterface(createID(name, engineName)), data(data_)
+    : DataPackInterface(createID(name, engineName)), _data(std::make_shared<DataPackData<DATA_TYPE> >(std::shared_ptr<DATA_TYPE>(data_)))
     { this->setIsEmpty(false); }
 
     DataPack(const std::string &name, const std::string &engineName)
-    : DataPackInterface(createID(name, engineName)), data(new DATA_TYPE())
+    : DataPackInterface(createID(name, engineName)), _data(std::make_shared<DataPackData<DATA_TYPE> >(std::make_shared<DATA_TYPE>()))
+    { this->setIsEmpty(false); }
+
+    /*!
+     * \brief Constructor taking shared ownership of the data
+     *
+     * It allows the data to be owned by another object, e.g. a protobuf arena, by passing a shared_ptr which
+     * aliases the owner's one. The data is copied on the first call to getMutableData().
+     */
+    DataPack(const std::string &name, const std::string &engineName, std::shared_ptr<DATA_TYPE> data_)
+    : DataPackInterface(createID(name, engineName)), _data(std::make_shared<DataPackData<DATA_TYPE> >(std::move(data_), true))
     { this->setIsEmpty(false); }
 
     DataPack (const DataPack&) = delete;
@@ -91,7 +105,23 @@ public:
         if(this->isEmpty())
             throw NRPException::logCreate("Attempt to get data from empty DataPack " + this->name());
         else
-            return *data.get();
+            return *this->_data->data;
+    }
+
+    /*!
+     * \brief Returns a mutable reference to data stored in the object
+     *
+     * If the data is shared with other DataPacks, e.g. after clone(), it is copied first, so modifications
+     * are not visible from them.
+     *
+     * \return Reference to the data stored by the object
+     */
+    DATA_TYPE& getMutableData()
+    {
+        if(this->isEmpty())
+            throw NRPException::logCreate("Attempt to get data from empty DataPack " + this->name());
+
+        return this->_data->mutableData();
     }
 
     /*!
@@ -101,7 +131,7 @@ public:
      */
     PyObject * toPythonString()
     {
-        std::string dataStr = boost::python::extract<std::string>(boost::python::str(this->data.get()));
+        std::string dataStr = boost::python::extract<std::string>(boost::python::str(this->_data->data.get()));
         std::string dataPackStr = "- name: '" + this->name() + "'\n- engine: '" + this->engineName() + "'\n- data:\n" + dataStr;
         return PyUnicode_FromString(dataPackStr.c_str());
     }
@@ -111,24 +141,50 @@ public:
         using namespace boost::python;
         class_< DataPack<DATA_TYPE>, DataPack<DATA_TYPE> *, bases<DataPackInterface>, boost::noncopyable >
             binder(name.data(), init<const std::string&, const std::string& >((boost::python::arg("name"), boost::python::arg("engine_name"))));
-        binder.add_property("data", make_function(&DataPack<DATA_TYPE>::getData, return_internal_reference<>()));
+        binder.add_property("data", &DataPack<DATA_TYPE>::getPythonData);
         binder.def("__str__", &DataPack<DATA_TYPE>::toPythonString);
         binder.def("getType", &DataPack<DATA_TYPE>::getType).staticmethod("getType");
     }
 
+    /*!
+     * \brief Returns a copy of this DataPack which shares its data. The data is copied on first write access
+     */
     DataPackInterface* clone() const override
-    { return new DataPack<DATA_TYPE>(this->name(), this->engineName(), new DATA_TYPE(*data), isUpdated()); }
+    { return new DataPack<DATA_TYPE>(this->name(), this->engineName(), *this->_data, isUpdated()); }
+
+protected:
+
+    /*!
+     * \brief Getter of the python 'data' property
+     *
+     * The returned python object refers to the DataPack data and keeps it alive. If the python bindings of DATA_TYPE
+     * track modifications (see DataPackPythonWrites), shared data is only copied when it is modified from python.
+     * Otherwise it is copied here, since it may be modified through the returned object.
+     */
+    static boost::python::object getPythonData(DataPack<DATA_TYPE> &dataPack)
+    {
+        if(dataPack.isEmpty())
+            throw NRPException::logCreate("Attempt to get data from empty DataPack " + dataPack.name());
+
+        if(!DataPackPythonWrites<DATA_TYPE>::isTracked())
+            dataPack._data->mutableData();
+
+        return createDataPackPythonData(dataPack._data);
+    }
 
 private:
 
-    DataPack(const std::string &name, const std::string &engineName, DATA_TYPE* data_, bool isUpdated) :
+    DataPack(const std::string &name, const std::string &engineName, const DataPackData<DATA_TYPE> &data_, bool isUpdated) :
         DataPackInterface(name, engineName, getType(), isUpdated),
-        data(data_)
+        _data(std::make_shared<DataPackData<DATA_TYPE> >(data_))
     {
         this->setIsEmpty(false);
     }
 
-    std::unique_ptr<DATA_TYPE> data;
+    /*!
+     * \brief Data of the DataPack. It can be shared between clones until one of them requests write access
+     */
+    std::shared_ptr<DataPackData<DATA_TYPE> > _data;
 };
 
 
@@ -153,7 +209,7 @@ public:
         using namespace boost::python;
         class_< RawData<DATA_TYPE>, RawData<DATA_TYPE> *, bases<DataPack<DATA_TYPE>>, boost::noncopyable>
             binder(name.data(), init<>());
-        binder.add_property("data", make_function(&RawData<DATA_TYPE>::getData, return_internal_reference<>()));
+        binder.add_property("data", &RawData<DATA_TYPE>::getPythonData);
         binder.def("__str__", &RawData<DATA_TYPE>::toPythonString);
         binder.def("getType", &RawData<DATA_TYPE>::getType).staticmethod("getType");
     }
@@ -0,0 +1,304 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+#ifndef DATAPACK_DATA_H
+#define DATAPACK_DATA_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <boost/python.hpp>
+#include <boost/python/object/class_detail.hpp>
+
+/*!
+ * \brief Data of a DataPack, shared with its clones until one of them modifies it
+ *
+ * Every DataPack has its own DataPackData. DataPackData objects created from another one share its data, which is
+ * copied by the first mutableData() call while it is shared. The number of DataPackData sharing the data is counted
+ * explicitly, since other objects (e.g. python objects, see DataPackDataHolder) may hold references to the data too.
+ *
+ * Data obtained with pinnedData() may be modified at any time through the references handed out to other objects.
+ * It is thus never shared, DataPackData objects created from one with pinned data copy it right away.
+ */
+template<class DATA_TYPE>
+class DataPackData
+{
+public:
+
+    /*!
+     * \brief Constructor
+     *
+     * \param data_ Data
+     * \param isShared If true, the data is owned by other objects too (e.g. a protobuf arena), and thus it is
+     *                 copied on the first mutableData() call
+     */
+    explicit DataPackData(std::shared_ptr<DATA_TYPE> data_, bool isShared = false)
+        : data(std::move(data_)), _sharing(std::make_shared<Sharing>(isShared ? 2 : 1))
+    {}
+
+    /*!
+     * \brief Creates a DataPackData sharing the data of 'other', or with a copy of it if it is pinned
+     */
+    DataPackData(const DataPackData &other)
+        : data(other.data), _sharing(other._sharing)
+    {
+        if(this->_sharing->pinned.load(std::memory_order_acquire))
+        {
+            this->data = std::make_shared<DATA_TYPE>(*other.data);
+            this->_sharing = std::make_shared<Sharing>(1);
+        }
+        else
+            this->_sharing->owners.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    DataPackData &operator=(const DataPackData &) = delete;
+
+    ~DataPackData()
+    { this->_sharing->owners.fetch_sub(1, std::memory_order_release); }
+
+    /*!
+     * \brief Returns a mutable reference to the data, copying it first if it is shared
+     */
+    DATA_TYPE &mutableData()
+    {
+        if(this->_sharing->owners.load(std::memory_order_acquire) > 1)
+        {
+            this->data = std::make_shared<DATA_TYPE>(*this->data);
+            this->_sharing->owners.fetch_sub(1, std::memory_order_release);
+            this->_sharing = std::make_shared<Sharing>(1);
+        }
+
+        return *this->data;
+    }
+
+    /*!
+     * \brief Returns a mutable reference to the data, which is not shared with other DataPackData from then on
+     *
+     * To be used when references to the data outlive the call, e.g. NumPy arrays referring to a message field
+     */
+    DATA_TYPE &pinnedData()
+    {
+        DATA_TYPE &mutableData = this->mutableData();
+        this->_sharing->pinned.store(true, std::memory_order_release);
+
+        return mutableData;
+    }
+
+    std::shared_ptr<DATA_TYPE> data;
+
+private:
+
+    struct Sharing
+    {
+        explicit Sharing(size_t owners_)
+            : owners(owners_)
+        {}
+
+        /*!
+         * \brief Number of DataPackData sharing the data
+         */
+        std::atomic<size_t> owners;
+
+        /*!
+         * \brief Whether the data was pinned, see pinnedData()
+         */
+        std::atomic<bool> pinned{false};
+    };
+
+    std::shared_ptr<Sharing> _sharing;
+};
+
+/*!
+ * \brief Tells whether the python bindings of DATA_TYPE notify modifications of the data to DataPackDataHolder
+ *
+ * It is enabled by the python bindings of DATA_TYPE, if they call DataPackDataHolderBase::prepareWrite (e.g. through
+ * extractForWrite) before every modification. Otherwise the DataPack 'data' python property gives write access to
+ * the data on every call.
+ */
+template<class DATA_TYPE>
+struct DataPackPythonWrites
+{
+    static void enableTracking()
+    { tracked() = true; }
+
+    static bool isTracked()
+    { return tracked(); }
+
+private:
+
+    static bool &tracked()
+    {
+        static bool isTracked = false;
+        return isTracked;
+    }
+};
+
+/*!
+ * \brief Base class of the holders of DataPack data in python objects
+ */
+class DataPackDataHolderBase : public boost::python::instance_holder
+{
+public:
+
+    /*!
+     * \brief Copies the held data if it is shared with other DataPacks. Must be called before modifying it
+     */
+    virtual void prepareWrite() = 0;
+
+    /*!
+     * \brief Same as prepareWrite, and keeps the data from being shared with other DataPacks afterwards. Must be
+     * called before handing out references to the data which outlive the call. See DataPackData::pinnedData
+     */
+    virtual void pin() = 0;
+
+    /*!
+     * \brief Returns the DataPackDataHolderBase of a python object, or null if it is not holding DataPack data
+     */
+    static DataPackDataHolderBase *find(PyObject *obj)
+    {
+        namespace bpy = boost::python;
+
+        PyTypeObject *metaType = Py_TYPE(Py_TYPE(obj));
+        if(!PyType_IsSubtype(metaType, bpy::objects::class_metatype().get()))
+            return nullptr;
+
+        for(auto *holder = reinterpret_cast<bpy::objects::instance<> *>(obj)->objects; holder != nullptr; holder = holder->next())
+        {
+            auto *dataHolder = dynamic_cast<DataPackDataHolderBase *>(holder);
+            if(dataHolder)
+                return dataHolder;
+        }
+
+        return nullptr;
+    }
+};
+
+/*!
+ * \brief Holds the data of a DataPack in the python object returned by its 'data' property
+ *
+ * The holder keeps the DataPackData alive, so the python object stays valid after the DataPack is destroyed. It
+ * always refers to the DataPack current data, also after it is copied by a modification, and keeps alive the data
+ * it referred to before, which may still be referenced from python objects obtained from it (e.g. message fields)
+ */
+template<class DATA_TYPE>
+class DataPackDataHolder : public DataPackDataHolderBase
+{
+public:
+
+    DataPackDataHolder(PyObject */*self*/, std::shared_ptr<DataPackData<DATA_TYPE> > dataPackData)
+        : _dataPackData(std::move(dataPackData)), _data(_dataPackData->data)
+    {}
+
+    void *holds(boost::python::type_info dstType, bool /*null_ptr_only*/) override
+    {
+        this->update();
+
+        const boost::python::type_info srcType = boost::python::type_id<DATA_TYPE>();
+        return srcType == dstType ? this->_data.get() : boost::python::objects::find_dynamic_type(this->_data.get(), srcType, dstType);
+    }
+
+    void prepareWrite() override
+    {
+        this->_dataPackData->mutableData();
+        this->update();
+    }
+
+    void pin() override
+    {
+        this->_dataPackData->pinnedData();
+        this->update();
+    }
+
+private:
+
+    void update()
+    {
+        if(this->_data != this->_dataPackData->data)
+        {
+            this->_previousData.push_back(std::move(this->_data));
+            this->_data = this->_dataPackData->data;
+        }
+    }
+
+    std::shared_ptr<DataPackData<DATA_TYPE> > _dataPackData;
+    std::shared_ptr<DATA_TYPE> _data;
+    std::vector<std::shared_ptr<DATA_TYPE> > _previousData;
+};
+
+/*!
+ * \brief Creates the python object of DataPack data, a DATA_TYPE python object referring to it
+ *
+ * Returns a python object holding a copy of the data if DATA_TYPE is not a class exposed to python
+ */
+template<class DATA_TYPE>
+boost::python::object createDataPackPythonData(const std::shared_ptr<DataPackData<DATA_TYPE> > &dataPackData)
+{
+    namespace bpy = boost::python;
+    using holder_t = DataPackDataHolder<DATA_TYPE>;
+
+    struct make_holder_instance : bpy::objects::make_instance_impl<DATA_TYPE, holder_t, make_holder_instance>
+    {
+        static PyTypeObject *get_class_object(const std::shared_ptr<DataPackData<DATA_TYPE> > &)
+        { return bpy::converter::registered<DATA_TYPE>::converters.get_class_object(); }
+
+        static holder_t *construct(void *storage, PyObject *instance, const std::shared_ptr<DataPackData<DATA_TYPE> > &data)
+        { return new (storage) holder_t(instance, data); }
+    };
+
+    if(bpy::converter::registered<DATA_TYPE>::converters.m_class_object == nullptr)
+        return bpy::object(*dataPackData->data);
+
+    return bpy::object(bpy::handle<>(make_holder_instance::execute(dataPackData)));
+}
+
+/*!
+ * \brief Extracts a reference to a DATA_TYPE object from python to modify it
+ *
+ * If the object holds DataPack data, the data is copied first when shared with other DataPacks
+ */
+template<class DATA_TYPE>
+DATA_TYPE &extractForWrite(const boost::python::object &obj)
+{
+    auto *holder = DataPackDataHolderBase::find(obj.ptr());
+    if(holder)
+        holder->prepareWrite();
+
+    return boost::python::extract<DATA_TYPE &>(obj);
+}
+
+/*!
+ * \brief Extracts a reference to a DATA_TYPE object from python to hand out references to it
+ *
+ * Same as extractForWrite, but if the object holds DataPack data, it is not shared with other DataPacks afterwards.
+ * References to it (e.g. python objects of message fields) thus never refer to data seen by other DataPacks
+ */
+template<class DATA_TYPE>
+DATA_TYPE &extractForReference(const boost::python::object &obj)
+{
+    auto *holder = DataPackDataHolderBase::find(obj.ptr());
+    if(holder)
+        holder->pin();
+
+    return boost::python::extract<DATA_TYPE &>(obj);
+}
+
+#endif // DATAPACK_DATA_H
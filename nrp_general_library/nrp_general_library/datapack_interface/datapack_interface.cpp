@@ -39,6 +39,7 @@ const std::string &DataPackInterface::name() const
 void DataPackInterface::setName(const std::string &name)
 {
     this->_id.Name = name;
+    this->_registryCache.reset();
 }
 
 const std::string &DataPackInterface::type() const
@@ -59,6 +60,7 @@ const std::string &DataPackInterface::engineName() const
 void DataPackInterface::setEngineName(const std::string &engineName)
 {
     this->_id.EngineName = engineName;
+    this->_registryCache.reset();
 }
 
 const DataPackIdentifier &DataPackInterface::id() const
@@ -69,6 +71,7 @@ const DataPackIdentifier &DataPackInterface::id() const
 void DataPackInterface::setID(const DataPackIdentifier &id)
 {
     this->_id = id;
+    this->_registryCache.reset();
 }
 
 bool DataPackInterface::isEmpty() const
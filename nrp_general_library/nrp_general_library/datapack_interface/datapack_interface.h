@@ -24,6 +24,8 @@
 
 #include "nrp_general_library/utils/ptr_templates.h"
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <memory>
@@ -83,6 +85,44 @@ struct DataPackIdentifier
 };
 
 
+/*!
+ * \brief Result of the last lookup of a DataPack identifier in DataPackRegistry, cached in the DataPack
+ *
+ * It is only read and written by DataPackRegistry, see DataPackRegistry::find(const DataPackInterface&, datapack_handle_t&).
+ * The cache is updated from const DataPacks, possibly concurrently, hence it is mutable and atomic.
+ */
+class DataPackRegistryCache
+{
+    public:
+        DataPackRegistryCache() = default;
+
+        DataPackRegistryCache(const DataPackRegistryCache &other)
+            : _value(other._value.load(std::memory_order_relaxed))
+        {}
+
+        DataPackRegistryCache &operator=(const DataPackRegistryCache &other)
+        {
+            this->_value.store(other._value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        /*!
+         * \brief Discards the cached lookup. Must be called when the identifier of the DataPack changes
+         */
+        void reset()
+        { this->_value.store(0, std::memory_order_relaxed); }
+
+    private:
+
+        friend class DataPackRegistry;
+
+        /*!
+         * \brief 0 if not looked up yet. See DataPackRegistry for the encoding of lookup results
+         */
+        mutable std::atomic<uint64_t> _value{0};
+};
+
+
 /*!
  * \brief Interface to datapacks
  */
@@ -120,6 +160,12 @@ class DataPackInterface
         const DataPackIdentifier &id() const;
         void setID(const DataPackIdentifier &id);
 
+        /*!
+         * \brief Returns the cached lookup of the DataPack identifier in DataPackRegistry
+         */
+        const DataPackRegistryCache &registryCache() const
+        { return this->_registryCache; }
+
         /*!
         * \brief Virtual clone method to support polymorphic copy
         */
@@ -164,6 +210,11 @@ class DataPackInterface
          */
         DataPackIdentifier _id;
 
+        /*!
+         * \brief Cached lookup of _id in DataPackRegistry
+         */
+        DataPackRegistryCache _registryCache;
+
         /*!
          * \brief Indicates if the datapack contains any data aside from datapack ID
          */
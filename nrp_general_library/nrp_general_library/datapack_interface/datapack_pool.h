@@ -0,0 +1,279 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#ifndef DATAPACK_POOL_H
+#define DATAPACK_POOL_H
+
+#include "nrp_general_library/datapack_interface/datapack_registry.h"
+
+#include <limits>
+
+
+/*!
+ * \brief Pool of DataPacks, indexed by their DataPackRegistry handle
+ *
+ * The pool stores at most one DataPack per identifier, as datapacks_set_t does. DataPacks whose identifier is
+ * registered in DataPackRegistry are looked up by handle instead of comparing identifier strings, other DataPacks are
+ * looked up by hash. The handle lookup is cached in each DataPack, so inserting or finding the same DataPack again
+ * doesn't access the registry. The pool never registers identifiers. DataPacks are iterated in insertion order.
+ * Entries are also indexed by engine, so that iterating over the DataPacks of an engine doesn't visit other entries.
+ *
+ * Every update of the pool increments its version, which is recorded for the updated DataPack. It allows to find
+ * the DataPacks updated after a given point, even if the same DataPack object is inserted again.
+ */
+class DataPackPool
+{
+    public:
+
+        /*!
+         * \brief Inserts a DataPack into the pool, replacing the DataPack with the same identifier, if any
+         */
+        void update(const DataPackInterfaceConstSharedPtr &dataPack)
+        {
+            this->_entries[this->addEntry(*dataPack)] = {dataPack, ++this->_version};
+        }
+
+        /*!
+         * \brief Inserts a DataPack into the pool, unless it already contains a DataPack with the same identifier
+         * \return True if the DataPack was inserted
+         */
+        bool insert(const DataPackInterfaceConstSharedPtr &dataPack)
+        {
+            auto &entry = this->_entries[this->addEntry(*dataPack)];
+            if(entry.dataPack != nullptr)
+                return false;
+
+            entry = {dataPack, ++this->_version};
+            return true;
+        }
+
+        /*!
+         * \brief Returns the DataPack with the given identifier, or nullptr if there is none in the pool
+         *
+         * \param handle Handle of id in DataPackRegistry
+         * \param id DataPack ID
+         */
+        const DataPackInterfaceConstSharedPtr &find(datapack_handle_t handle, const DataPackIdentifier &id) const
+        {
+            if(handle < this->_registeredEntries.size() && this->_registeredEntries[handle] != NoEntry)
+                return this->_entries[this->_registeredEntries[handle]].dataPack;
+
+            // The DataPack could have been stored before its identifier was registered
+            return this->findUnregistered(id);
+        }
+
+        /*!
+         * \brief Returns the DataPack with the given identifier, or nullptr if there is none in the pool
+         */
+        const DataPackInterfaceConstSharedPtr &find(const DataPackIdentifier &id) const
+        {
+            datapack_handle_t handle;
+            if(DataPackRegistry::getInstance().find(id, handle))
+                return this->find(handle, id);
+
+            return this->findUnregistered(id);
+        }
+
+        /*!
+         * \brief Returns the DataPack with the same identifier as the given DataPack, or nullptr if there is none
+         */
+        const DataPackInterfaceConstSharedPtr &find(const DataPackInterface &dataPack) const
+        {
+            datapack_handle_t handle;
+            if(DataPackRegistry::getInstance().find(dataPack, handle))
+                return this->find(handle, dataPack.id());
+
+            return this->findUnregistered(dataPack.id());
+        }
+
+        /*!
+         * \brief Calls fcn with each DataPack in the pool, in insertion order
+         */
+        template<class FCN>
+        void forEach(FCN &&fcn) const
+        {
+            for(const auto &entry : this->_entries)
+                fcn(entry.dataPack);
+        }
+
+        /*!
+         * \brief Calls fcn with each DataPack in the pool linked to the given engine, in insertion order
+         */
+        template<class FCN>
+        void forEachOfEngine(const std::string &engineName, FCN &&fcn) const
+        {
+            this->forEachUpdatedOfEngine(engineName, 0, std::forward<FCN>(fcn));
+        }
+
+        /*!
+         * \brief Calls fcn with each DataPack in the pool linked to the given engine and updated after the given
+         *        version of the pool, in insertion order
+         */
+        template<class FCN>
+        void forEachUpdatedOfEngine(const std::string &engineName, uint64_t version, FCN &&fcn) const
+        {
+            const auto engineEntries = this->_engineEntries.find(engineName);
+            if(engineEntries == this->_engineEntries.end())
+                return;
+
+            for(const auto entryIndex : engineEntries->second)
+            {
+                const auto &entry = this->_entries[entryIndex];
+                if(entry.version > version)
+                    fcn(entry.dataPack);
+            }
+        }
+
+        /*!
+         * \brief Returns the version of the pool, i.e. the number of updates done since its creation
+         */
+        uint64_t version() const
+        { return this->_version; }
+
+        /*!
+         * \brief Inserts the DataPacks of the pool into dataPacks. DataPacks already in dataPacks take precedence
+         */
+        void mergeInto(datapacks_set_t &dataPacks) const
+        {
+            this->forEach([&dataPacks] (const DataPackInterfaceConstSharedPtr &dataPack) {
+                dataPacks.insert(dataPack);
+            });
+        }
+
+        /*!
+         * \brief Returns the DataPacks in the pool as a set
+         */
+        datapacks_set_t toSet() const
+        {
+            datapacks_set_t dataPacks;
+            this->mergeInto(dataPacks);
+            return dataPacks;
+        }
+
+        size_t size() const
+        { return this->_entries.size(); }
+
+        bool empty() const
+        { return this->_entries.empty(); }
+
+        void clear()
+        {
+            this->_entries.clear();
+            this->_engineEntries.clear();
+            this->_registeredEntries.clear();
+            this->_unregisteredEntries.clear();
+        }
+
+    private:
+
+        struct Entry
+        {
+            DataPackInterfaceConstSharedPtr dataPack;
+            /*! \brief Pool version at the last update of the DataPack */
+            uint64_t version = 0;
+        };
+
+        static constexpr size_t NoEntry = std::numeric_limits<size_t>::max();
+
+        const DataPackInterfaceConstSharedPtr &findUnregistered(const DataPackIdentifier &id) const
+        {
+            static const DataPackInterfaceConstSharedPtr noDataPack;
+
+            if(this->_unregisteredEntries.empty())
+                return noDataPack;
+
+            const auto entry = this->_unregisteredEntries.find(id);
+            return entry != this->_unregisteredEntries.end() ? this->_entries[entry->second].dataPack : noDataPack;
+        }
+
+        /*!
+         * \brief Returns the index of the entry with the identifier of the given DataPack, adding an empty entry if
+         *        there is none
+         */
+        size_t addEntry(const DataPackInterface &dataPack)
+        {
+            const auto &id = dataPack.id();
+            const size_t newEntry = this->_entries.size();
+            size_t entry;
+
+            datapack_handle_t handle;
+            if(DataPackRegistry::getInstance().find(dataPack, handle))
+            {
+                if(handle >= this->_registeredEntries.size())
+                    this->_registeredEntries.resize(handle + 1, NoEntry);
+
+                if(this->_registeredEntries[handle] == NoEntry)
+                {
+                    // The DataPack could have been stored before its identifier was registered
+                    const auto unregisteredEntry = this->_unregisteredEntries.find(id);
+                    if(unregisteredEntry != this->_unregisteredEntries.end())
+                    {
+                        this->_registeredEntries[handle] = unregisteredEntry->second;
+                        this->_unregisteredEntries.erase(unregisteredEntry);
+                    }
+                    else
+                        this->_registeredEntries[handle] = newEntry;
+                }
+
+                entry = this->_registeredEntries[handle];
+            }
+            else
+                entry = this->_unregisteredEntries.try_emplace(id, newEntry).first->second;
+
+            if(entry == newEntry)
+            {
+                this->_entries.emplace_back();
+                this->_engineEntries[id.EngineName].push_back(newEntry);
+            }
+
+            return entry;
+        }
+
+        /*!
+         * \brief DataPacks in the pool, in insertion order
+         */
+        std::vector<Entry> _entries;
+
+        /*!
+         * \brief Indices of the entries of each engine, in insertion order
+         */
+        std::unordered_map<std::string, std::vector<size_t>> _engineEntries;
+
+        /*!
+         * \brief Entries of DataPacks with registered identifiers, indexed by handle. NoEntry if not in the pool
+         */
+        std::vector<size_t> _registeredEntries;
+
+        /*!
+         * \brief Entries of DataPacks whose identifier is not registered in DataPackRegistry
+         */
+        std::unordered_map<DataPackIdentifier, size_t, DataPackRegistry::IdentifierHash, DataPackRegistry::IdentifierEqual> _unregisteredEntries;
+
+        /*!
+         * \brief Number of updates done in the pool. It is not reset by clear(), versions keep increasing
+         */
+        uint64_t _version = 0;
+};
+
+
+#endif // DATAPACK_POOL_H
+
+// EOF
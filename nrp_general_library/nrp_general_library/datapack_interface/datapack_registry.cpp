@@ -0,0 +1,120 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_general_library/datapack_interface/datapack_registry.h"
+
+#include <functional>
+#include <mutex>
+
+
+DataPackRegistry &DataPackRegistry::getInstance()
+{
+    static DataPackRegistry instance;
+    return instance;
+}
+
+datapack_handle_t DataPackRegistry::intern(const DataPackIdentifier &id)
+{
+    {
+        std::shared_lock lock(this->_lock);
+
+        const auto handle = this->_handles.find(id);
+        if(handle != this->_handles.end())
+            return handle->second;
+    }
+
+    std::unique_lock lock(this->_lock);
+
+    // The identifier could have been registered by another thread while the lock was released
+    const auto handle = this->_handles.find(id);
+    if(handle != this->_handles.end())
+        return handle->second;
+
+    const auto newHandle = static_cast<datapack_handle_t>(this->_identifiers.size());
+    this->_identifiers.emplace_back(id.Name, id.EngineName, "");
+    this->_handles.emplace(this->_identifiers.back(), newHandle);
+    this->_size.store(this->_identifiers.size(), std::memory_order_release);
+
+    return newHandle;
+}
+
+bool DataPackRegistry::find(const DataPackIdentifier &id, datapack_handle_t &handle) const
+{
+    std::shared_lock lock(this->_lock);
+
+    const auto handleIt = this->_handles.find(id);
+    if(handleIt == this->_handles.end())
+        return false;
+
+    handle = handleIt->second;
+    return true;
+}
+
+bool DataPackRegistry::find(const DataPackInterface &dataPack, datapack_handle_t &handle) const
+{
+    auto &cache = dataPack.registryCache()._value;
+    const uint64_t cached = cache.load(std::memory_order_relaxed);
+
+    if(cached & CachedHandleFlag)
+    {
+        handle = static_cast<datapack_handle_t>(cached);
+        return true;
+    }
+
+    if(cached != 0 && cached - 1 == this->_size.load(std::memory_order_acquire))
+        return false;
+
+    std::shared_lock lock(this->_lock);
+
+    const auto handleIt = this->_handles.find(dataPack.id());
+    if(handleIt == this->_handles.end())
+    {
+        // No identifier is registered while the lock is held
+        cache.store(this->_identifiers.size() + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    handle = handleIt->second;
+    cache.store(CachedHandleFlag | handle, std::memory_order_relaxed);
+    return true;
+}
+
+const DataPackIdentifier &DataPackRegistry::identifier(datapack_handle_t handle) const
+{
+    std::shared_lock lock(this->_lock);
+    return this->_identifiers.at(handle);
+}
+
+size_t DataPackRegistry::size() const
+{
+    return this->_size.load(std::memory_order_acquire);
+}
+
+size_t DataPackRegistry::IdentifierHash::operator() (const DataPackIdentifier &id) const
+{
+    const size_t nameHash = std::hash<std::string>()(id.Name);
+    const size_t engineHash = std::hash<std::string>()(id.EngineName);
+
+    return nameHash ^ (engineHash + 0x9e3779b9 + (nameHash << 6) + (nameHash >> 2));
+}
+
+// EOF
@@ -0,0 +1,155 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#ifndef DATAPACK_REGISTRY_H
+#define DATAPACK_REGISTRY_H
+
+#include "nrp_general_library/datapack_interface/datapack_interface.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <unordered_map>
+
+/*!
+ * \brief Handle of an interned DataPackIdentifier. See DataPackRegistry
+ */
+using datapack_handle_t = uint32_t;
+
+
+/*!
+ * \brief Interns DataPack identifiers into small integer handles
+ *
+ * DataPacks are identified by their name and the name of their engine, which is also the criterion used by
+ * DataPackPointerComparator. The registry assigns a handle to each distinct identifier the first time it is interned.
+ * Handles are consecutive, starting from 0, and remain valid for the lifetime of the process, so they can be used
+ * as indices into flat arrays instead of comparing strings.
+ *
+ * Entries are never removed. Identifiers must thus be interned at configuration time, e.g. those requested by the
+ * Functions when they are loaded, and only looked up afterwards. DataPacks with identifiers which were not interned
+ * are still handled by DataPackPool, without a handle.
+ *
+ * The registry is thread-safe. Lookups only take a shared lock. Lookups of DataPacks cache their result in the
+ * DataPack, so that looking up the same DataPack again takes no lock and computes no hash.
+ */
+class DataPackRegistry
+{
+    public:
+
+        /*!
+         * \brief Hash of the name and engine name of a DataPackIdentifier
+         */
+        struct IdentifierHash
+        {
+            size_t operator() (const DataPackIdentifier &id) const;
+        };
+
+        /*!
+         * \brief Compares the name and engine name of two DataPackIdentifiers, as DataPackPointerComparator does
+         */
+        struct IdentifierEqual
+        {
+            bool operator() (const DataPackIdentifier &lhs, const DataPackIdentifier &rhs) const
+            { return lhs.Name == rhs.Name && lhs.EngineName == rhs.EngineName; }
+        };
+
+        DataPackRegistry(const DataPackRegistry &) = delete;
+        DataPackRegistry(DataPackRegistry &&) = delete;
+
+        DataPackRegistry &operator=(const DataPackRegistry &) = delete;
+        DataPackRegistry &operator=(DataPackRegistry &&) = delete;
+
+        /*!
+         * \brief Get singleton instance of DataPackRegistry
+         */
+        static DataPackRegistry &getInstance();
+
+        /*!
+         * \brief Returns the handle of the given identifier, registering it if needed
+         *
+         * Meant to be called at configuration time. The Type of the identifier is not part of the key
+         */
+        datapack_handle_t intern(const DataPackIdentifier &id);
+
+        /*!
+         * \brief Looks up the handle of the given identifier without registering it
+         *
+         * \param id Identifier to look up. Its Type is not part of the key
+         * \param handle Set to the handle of the identifier, if it is registered
+         * \return True if the identifier is registered
+         */
+        bool find(const DataPackIdentifier &id, datapack_handle_t &handle) const;
+
+        /*!
+         * \brief Looks up the handle of the identifier of the given DataPack without registering it
+         *
+         * The result is cached in the DataPack. A cached handle is always valid, since handles are never removed.
+         * A cached miss is valid until another identifier is registered.
+         *
+         * \param dataPack DataPack whose identifier is looked up
+         * \param handle Set to the handle of the identifier, if it is registered
+         * \return True if the identifier is registered
+         */
+        bool find(const DataPackInterface &dataPack, datapack_handle_t &handle) const;
+
+        /*!
+         * \brief Returns the identifier registered with the given handle. Its Type is left empty
+         */
+        const DataPackIdentifier &identifier(datapack_handle_t handle) const;
+
+        /*!
+         * \brief Returns the number of registered identifiers
+         */
+        size_t size() const;
+
+    private:
+
+        DataPackRegistry() = default;
+
+        /*!
+         * \brief Marks a cached lookup as a handle. Otherwise the cache holds the number of registered
+         *        identifiers at the time of the lookup plus one
+         */
+        static constexpr uint64_t CachedHandleFlag = uint64_t(1) << 63;
+
+        mutable std::shared_mutex _lock;
+
+        /*!
+         * \brief Number of registered identifiers. It is only modified with the lock held, but can be read without it
+         */
+        std::atomic<size_t> _size{0};
+
+        /*!
+         * \brief Handles of registered identifiers
+         */
+        std::unordered_map<DataPackIdentifier, datapack_handle_t, IdentifierHash, IdentifierEqual> _handles;
+
+        /*!
+         * \brief Registered identifiers, indexed by handle. A deque keeps references to them valid while it grows
+         */
+        std::deque<DataPackIdentifier> _identifiers;
+};
+
+
+#endif // DATAPACK_REGISTRY_H
+
+// EOF
@@ -0,0 +1,139 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#ifndef DATAPACKS_VIEW_H
+#define DATAPACKS_VIEW_H
+
+#include "nrp_general_library/datapack_interface/datapack_pool.h"
+
+
+/*!
+ * \brief Read-only view over one or several collections of DataPacks
+ *
+ * The view either wraps a set of DataPacks or chains several DataPackPools. It doesn't copy the DataPacks nor their
+ * pointers, so the viewed collections must outlive the view and must not be modified while it is in use.
+ * When several pools contain a DataPack with the same ID, the DataPack from the first of them is seen.
+ */
+class DataPacksView
+{
+    public:
+
+        DataPacksView() = default;
+
+        /*!
+         * \brief Creates a view over a set of DataPacks
+         *
+         * The view only stores a pointer to the set, so it can't be created from a temporary
+         */
+        explicit DataPacksView(const datapacks_set_t &dataPacks)
+            : _set(&dataPacks)
+        {}
+
+        explicit DataPacksView(datapacks_set_t &&) = delete;
+
+        /*!
+         * \brief Creates a view chaining the given pools, in order of precedence
+         */
+        DataPacksView(std::initializer_list<const DataPackPool *> pools)
+            : _pools(pools)
+        {}
+
+        /*!
+         * \brief Finds the DataPack with the given ID
+         *
+         * \param handle Handle of id in DataPackRegistry
+         * \param id DataPack ID
+         * \return Pointer to the DataPack, or nullptr if it is not in the view
+         */
+        const DataPackInterfaceConstSharedPtr *find(datapack_handle_t handle, const DataPackIdentifier &id) const
+        {
+            for(const auto pool : this->_pools)
+            {
+                const auto &dataPack = pool->find(handle, id);
+                if(dataPack != nullptr)
+                    return &dataPack;
+            }
+
+            return this->findInSet(id);
+        }
+
+        /*!
+         * \brief Finds the DataPack with the given ID
+         *
+         * \param id DataPack ID
+         * \return Pointer to the DataPack, or nullptr if it is not in the view
+         */
+        const DataPackInterfaceConstSharedPtr *find(const DataPackIdentifier &id) const
+        {
+            for(const auto pool : this->_pools)
+            {
+                const auto &dataPack = pool->find(id);
+                if(dataPack != nullptr)
+                    return &dataPack;
+            }
+
+            return this->findInSet(id);
+        }
+
+        /*!
+         * \brief Copies the DataPacks in the view into a set
+         */
+        datapacks_set_t toSet() const
+        {
+            datapacks_set_t dataPacks;
+            if(this->_set != nullptr)
+                dataPacks = *(this->_set);
+
+            for(const auto pool : this->_pools)
+                pool->mergeInto(dataPacks);
+
+            return dataPacks;
+        }
+
+    private:
+
+        const DataPackInterfaceConstSharedPtr *findInSet(const DataPackIdentifier &id) const
+        {
+            if(this->_set != nullptr)
+            {
+                const auto dataPack = this->_set->find(id);
+                if(dataPack != this->_set->end())
+                    return &(*dataPack);
+            }
+
+            return nullptr;
+        }
+
+        /*!
+         * \brief Viewed pools, in order of precedence
+         */
+        std::vector<const DataPackPool *> _pools;
+
+        /*!
+         * \brief Viewed set, if the view wraps one
+         */
+        const datapacks_set_t *_set = nullptr;
+};
+
+
+#endif // DATAPACKS_VIEW_H
+
+// EOF
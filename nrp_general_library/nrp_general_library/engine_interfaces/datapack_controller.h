@@ -22,6 +22,9 @@
 #ifndef DATA_DATAPACK_CONTROLLER_H
 #define DATA_DATAPACK_CONTROLLER_H
 
+#include <cstdint>
+#include <limits>
+
 /*!
  *  \brief Helper class to handle DataPacks on the Engine Server side
  *
@@ -53,6 +56,63 @@ public:
      * \param data Data to be processed
      */
     virtual void handleDataPackData(const DATA_TYPE &data) = 0;
+
+    /*!
+     * \brief Sequence number of the data returned by getDataPackInformation()
+     *
+     * Controllers whose data stays the same for many steps can return a number which changes whenever the data does.
+     * As long as it doesn't change, engine servers don't fetch the data again and send an "unchanged" marker instead,
+     * for which clients reuse the datapack they received last.
+     *
+     * \return Sequence number of the data, or NoSequence if the data must be fetched every time. This is the default
+     */
+    virtual uint64_t getDataPackSequence()
+    { return NoSequence; }
+
+    /*!
+     * \brief Sequence number disabling "unchanged" markers, see getDataPackSequence()
+     */
+    static constexpr uint64_t NoSequence = 0;
+};
+
+/*!
+ * \brief Sequence number of datapack data which only changes when the simulation steps or when data is written to it
+ *
+ * Helper for implementing DataPackController::getDataPackSequence(). The sequence number changes whenever the step
+ * count passed to update() differs from the previous one, or modified() has been called. It is never NoSequence
+ */
+class DataPackStepSequence
+{
+    public:
+
+        /*!
+         * \brief Returns the sequence number of the data at the given simulation step count
+         *
+         * \param step Number of steps run by the simulation. Any change, e.g. after a reset, changes the sequence
+         */
+        uint64_t update(uint64_t step)
+        {
+            if(step != this->_step)
+            {
+                this->_step = step;
+                ++this->_sequence;
+            }
+
+            return this->_sequence;
+        }
+
+        /*!
+         * \brief Marks the data as modified outside of simulation steps, e.g. after handling incoming datapack data
+         */
+        void modified()
+        { ++this->_sequence; }
+
+    private:
+
+        /*! \brief Step count of the last update() call. No valid step count before the first call */
+        uint64_t _step = std::numeric_limits<uint64_t>::max();
+        /*! \brief Current sequence number. It starts at NoSequence, which is left on the first update() call */
+        uint64_t _sequence = 0;
 };
 
 #endif // DATA_DATAPACK_CONTROLLER_H
@@ -29,6 +29,14 @@ EngineClientInterface::EngineClientInterface(std::unique_ptr<ProcessLauncherInte
 EngineClientInterface::~EngineClientInterface() = default;
 
 pid_t EngineClientInterface::launchEngine()
+{
+    const auto enginePID = this->launchEngineProcess();
+    this->connectToEngine();
+
+    return enginePID;
+}
+
+pid_t EngineClientInterface::launchEngineProcess()
 {
     // Launch engine
     nlohmann::json procConf;
@@ -40,6 +48,20 @@ pid_t EngineClientInterface::launchEngine()
     return this->_process->launchProcess(procConf);
 }
 
+void EngineClientInterface::connectToEngine()
+{}
+
+void EngineClientInterface::setStepCompletionCallback(step_completion_callback_t callback)
+{
+    this->_stepCompletionCallback = std::move(callback);
+}
+
+void EngineClientInterface::notifyStepCompletion() const
+{
+    if(this->_stepCompletionCallback)
+        this->_stepCompletionCallback(this);
+}
+
 EngineLauncherInterface::EngineLauncherInterface(const EngineLauncherInterface::engine_type_t &engineType)
     : _engineType(engineType)
 {}
@@ -48,3 +70,8 @@ const EngineLauncherInterface::engine_type_t &EngineLauncherInterface::engineTyp
 {
     return this->_engineType;
 }
+
+EngineClientInterfaceSharedPtr EngineLauncherInterface::launchEngineProcess(nlohmann::json &engineConfig, ProcessLauncherInterface::unique_ptr &&launcher)
+{
+    return this->launchEngine(engineConfig, std::move(launcher));
+}
@@ -28,10 +28,12 @@
 #include "nrp_general_library/utils/time_utils.h"
 #include "nrp_general_library/utils/json_schema_utils.h"
 #include "nrp_general_library/datapack_interface/datapack_interface.h"
+#include "nrp_general_library/engine_interfaces/loop_step_worker.h"
 
 #include <set>
 #include <vector>
 #include <future>
+#include <functional>
 
 class EngineClientInterface;
 class EngineLauncherInterface;
@@ -44,6 +46,11 @@ class EngineClientInterface
         : public PtrTemplates<EngineClientInterface>
 {
     public:
+        /*!
+         * \brief Type of the callback invoked by an engine when its loop step has been completed
+         */
+        using step_completion_callback_t = std::function<void(const EngineClientInterface *)>;
+
         explicit EngineClientInterface(ProcessLauncherInterface::unique_ptr &&launcher);
         virtual ~EngineClientInterface();
 
@@ -69,11 +76,29 @@ class EngineClientInterface
         virtual const std::vector<std::string> engineProcStartParams() const = 0;
 
         /*!
-         * \brief Launch the engine
+         * \brief Launch the engine and wait until it is ready to receive commands
+         *
+         * Equivalent to calling launchEngineProcess() followed by connectToEngine()
+         *
          * \return Returns engine process ID on success, throws on failure
          */
         virtual pid_t launchEngine();
 
+        /*!
+         * \brief Launch the engine process without waiting for the engine to be ready
+         * \return Returns engine process ID on success, throws on failure
+         */
+        virtual pid_t launchEngineProcess();
+
+        /*!
+         * \brief Wait until the launched engine is ready to receive commands
+         *
+         * It may be called concurrently for different engines. By default it returns immediately
+         *
+         * \throw Throws if the engine doesn't get ready
+         */
+        virtual void connectToEngine();
+
         /*!
          * \brief Initialize engine
          * \return Returns SUCCESS if no error was encountered
@@ -150,12 +175,33 @@ class EngineClientInterface
          */
         virtual datapacks_vector_t getDataPacksFromEngine(const datapack_identifiers_set_t &datapackIdentifiers) = 0;
 
+        /*!
+         * \brief Sets a callback which will be invoked every time a loop step started with runLoopStepAsync() finishes
+         *
+         * The callback is invoked from the thread executing the loop step, both on success and on failure. It can be used
+         * to process engines in the order in which they complete their steps. The results of the step must still be
+         * retrieved with runLoopStepAsyncGet().
+         *
+         * \param callback Callback function. An empty function disables the notification
+         */
+        void setStepCompletionCallback(step_completion_callback_t callback);
+
 protected:
 
+        /*!
+         * \brief Invokes the step completion callback, if one has been set
+         */
+        void notifyStepCompletion() const;
+
         /*!
          * \brief Process Launcher. Will be used to stop process at end
          */
         ProcessLauncherInterface::unique_ptr _process;
+
+        /*!
+         * \brief Callback invoked when a loop step has been completed
+         */
+        step_completion_callback_t _stepCompletionCallback;
 };
 
 using EngineClientInterfaceSharedPtr = EngineClientInterface::shared_ptr;
@@ -173,6 +219,18 @@ class EngineLauncherInterface
         const engine_type_t &engineType() const;
         virtual EngineClientInterfaceSharedPtr launchEngine(nlohmann::json  &engineConfig, ProcessLauncherInterface::unique_ptr &&launcher) = 0;
 
+        /*!
+         * \brief Creates an engine and launches its process, without waiting for the engine to be ready
+         *
+         * EngineClientInterface::connectToEngine() must be called on the returned engine before using it.
+         * By default it calls launchEngine()
+         *
+         * \param engineConfig Engine Configuration
+         * \param launcher Process Forker
+         * \return Returns pointer to EngineClientInterface
+         */
+        virtual EngineClientInterfaceSharedPtr launchEngineProcess(nlohmann::json  &engineConfig, ProcessLauncherInterface::unique_ptr &&launcher);
+
     private:
         /*!
          * \brief Engine Type
@@ -220,10 +278,24 @@ class EngineClient
                  * \return Returns pointer to EngineClientInterface
                  */
                 EngineClientInterfaceSharedPtr launchEngine(nlohmann::json &engineConfig, ProcessLauncherInterface::unique_ptr &&launcher) override
+                {
+                    auto engine = this->launchEngineProcess(engineConfig, std::move(launcher));
+                    engine->connectToEngine();
+
+                    return engine;
+                }
+
+                /*!
+                 * \brief Launches an engine process without waiting for the engine to be ready
+                 * \param engineConfig Engine Configuration
+                 * \param launcher Process Forker
+                 * \return Returns pointer to EngineClientInterface
+                 */
+                EngineClientInterfaceSharedPtr launchEngineProcess(nlohmann::json &engineConfig, ProcessLauncherInterface::unique_ptr &&launcher) override
                 {
                     EngineClientInterfaceSharedPtr engine(new ENGINE(engineConfig, std::move(launcher)));
 
-                    switch (engine->launchEngine())
+                    switch (engine->launchEngineProcess())
                     {
                         case 0: { // TODO: process not forked (error)
                                 NRPLogger::error(
@@ -305,31 +377,31 @@ class EngineClient
         /*!
          * \brief Concrete implementation of EngineClientInterface::runLoopStepAsync()
          *
-         * The function starts EngineClient::runLoopStepCallback() asynchronously using std::async.
+         * The function requests the engine worker thread to execute EngineClient::runLoopStepCallback().
+         * The worker thread is created with the first step and reused for all subsequent ones.
          * The callback function should be provided by concrete engine implementation.
-         * The result of the callback is going to be retrieved using an std::future object
-         * in EngineClient::runLoopStepAsyncGet().
+         * The result of the callback is going to be retrieved in EngineClient::runLoopStepAsyncGet().
          *
          * \param[in] timeStep Requested duration of the simulation loop step.
-         * \throw NRPException If the future object is still valid (EngineClient::runLoopStepAsyncGet() was not called)
+         * \throw NRPException If the previous step is still pending (EngineClient::runLoopStepAsyncGet() was not called)
          */
         void runLoopStepAsync(SimulationTime timeStep) override
         {
-            if(this->_loopStepThread.valid())
+            if(this->_loopStepWorker.isPending())
             {
                 throw NRPException::logCreate("Engine \"" + this->engineName() + "\" runLoopStepAsync has overrun");
             }
 
-            this->_loopStepThread = std::async(std::launch::async, std::bind(&EngineClient::runLoopStepCallback, this, timeStep));
+            this->_loopStepWorker.start(timeStep);
         }
 
         /*!
          * \brief Concrete implementation of EngineClientInterface::runLoopStepAsyncGet()
          *
          * The function should be called after EngineClient::runLoopStepAsync(). It will wait for the
-         * worker thread to finish and retrieve the results from the future object. The value returned
-         * by the future should be the simulation (engine) time after running the loop step. It will
-         * be saved in the engine object, and can be accessed with EngineClient::getEngineTime().
+         * worker thread to finish the step and retrieve its result. The value returned by the step should
+         * be the simulation (engine) time after running the loop step. It will be saved in the engine object,
+         * and can be accessed with EngineClient::getEngineTime().
          *
          * \param[in] timeOut Timeout of the loop step. If it's less or equal to 0, the function will wait indefinitely.
          * \throw NRPException On timeout
@@ -338,20 +410,20 @@ class EngineClient
         {
             NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
-            // If thread state is invalid, loop thread has completed and runLoopStepAsyncGet was called once before
-            if(!this->_loopStepThread.valid())
+            // If no step is pending, loop step has completed and runLoopStepAsyncGet was called once before
+            if(!this->_loopStepWorker.isPending())
                 return;
 
             // Wait until timeOut has passed
             if(timeOut > SimulationTime::zero())
             {
-                if(this->_loopStepThread.wait_for(timeOut) != std::future_status::ready)
+                if(!this->_loopStepWorker.waitFor(timeOut))
                     throw NRPException::logCreate("Engine \"" + this->engineName() + "\" loop is taking too long to complete");
             }
 
             // Retrieve the engine time returned from the loop step
 
-            this->_engineTime = this->_loopStepThread.get();
+            this->_engineTime = this->_loopStepWorker.get();
         }
 
     protected:
@@ -361,6 +433,14 @@ class EngineClient
             this->_engineTime = SimulationTime(0);
         }
 
+        /*!
+         * \brief Sets the engine time. To be used by engines which override runLoopStepAsyncGet()
+         */
+        void setEngineTime(SimulationTime engineTime)
+        {
+            this->_engineTime = engineTime;
+        }
+
         /*!
         * \brief Attempts to set a default value for a property in the engine configuration. If the property has been already
          * set either in the engine configuration file or from the engine schema, its value is not overwritten.
@@ -376,9 +456,8 @@ class EngineClient
         /*!
          * \brief Executes a single loop step
          *
-         * This function is going to be called by runLoopStep using std::async.
-         * It will be executed by a worker thread, which allows for runLoopStepFunction
-         * from multiple engines to run simultaneously.
+         * This function is going to be called by runLoopStepAsync using the engine worker thread.
+         * It allows for runLoopStepFunction from multiple engines to run simultaneously.
          *
          * \param[in] timeStep A time step by which the simulation should be advanced
          * \return Engine time after loop step execution
@@ -387,17 +466,41 @@ class EngineClient
 
     private:
 
-        nlohmann::json engineConfig_;
-        std::string schema = std::string(SCHEMA);
         /*!
-         * \brief Future of thread running a single loop. Used by runLoopStep and waitForStepCompletion to execute the thread
+         * \brief Executes EngineClient::runLoopStepCallback() and notifies its completion
+         *
+         * The completion is notified also when the callback throws, the exception is then rethrown
+         * and retrieved by EngineClient::runLoopStepAsyncGet().
+         *
+         * \param[in] timeStep A time step by which the simulation should be advanced
+         * \return Engine time after loop step execution
          */
-        std::future<SimulationTime> _loopStepThread;
+        SimulationTime runLoopStepAndNotify(SimulationTime timeStep)
+        {
+            try
+            {
+                const auto engineTime = this->runLoopStepCallback(timeStep);
+                this->notifyStepCompletion();
+                return engineTime;
+            }
+            catch(...)
+            {
+                this->notifyStepCompletion();
+                throw;
+            }
+        }
 
+        nlohmann::json engineConfig_;
+        std::string schema = std::string(SCHEMA);
         /*!
          * \brief Engine Time
          */
         SimulationTime _engineTime = SimulationTime::zero();
+
+        /*!
+         * \brief Worker thread running loop steps. Used by runLoopStepAsync and runLoopStepAsyncGet
+         */
+        LoopStepWorker _loopStepWorker{[this] (SimulationTime timeStep) { return this->runLoopStepAndNotify(timeStep); }};
 };
 
 #endif // ENGINE_CLIENT_INTERFACE_H
@@ -0,0 +1,124 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_general_library/engine_interfaces/loop_step_worker.h"
+#include "nrp_general_library/utils/nrp_exceptions.h"
+
+LoopStepWorker::LoopStepWorker(step_function_t stepFunction)
+    : _stepFunction(std::move(stepFunction))
+{}
+
+LoopStepWorker::~LoopStepWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stop = true;
+    }
+
+    this->_requestCV.notify_one();
+
+    if(this->_thread.joinable())
+        this->_thread.join();
+}
+
+void LoopStepWorker::start(SimulationTime timeStep)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+
+        if(this->_state != State::IDLE)
+            throw NRPException::logCreate("Loop step requested while the previous one has not been retrieved");
+
+        this->_timeStep = timeStep;
+        this->_exception = nullptr;
+        this->_state = State::REQUESTED;
+
+        // Thread is started lazily, engines which never run a step don't need it
+        if(!this->_thread.joinable())
+            this->_thread = std::thread(&LoopStepWorker::run, this);
+    }
+
+    this->_requestCV.notify_one();
+}
+
+bool LoopStepWorker::isPending() const
+{
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_state != State::IDLE;
+}
+
+bool LoopStepWorker::waitFor(SimulationTime timeOut)
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    return this->_doneCV.wait_for(lock, timeOut, [this] { return this->_state != State::REQUESTED; });
+}
+
+SimulationTime LoopStepWorker::get()
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    this->_doneCV.wait(lock, [this] { return this->_state != State::REQUESTED; });
+
+    if(this->_state == State::IDLE)
+        throw NRPException::logCreate("Loop step result requested but no step was started");
+
+    this->_state = State::IDLE;
+
+    if(this->_exception)
+        std::rethrow_exception(std::exchange(this->_exception, nullptr));
+
+    return this->_result;
+}
+
+void LoopStepWorker::run()
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    while(true)
+    {
+        this->_requestCV.wait(lock, [this] { return this->_stop || this->_state == State::REQUESTED; });
+
+        // Pending requests are completed before stopping
+        if(this->_state != State::REQUESTED)
+            return;
+
+        const auto timeStep = this->_timeStep;
+        lock.unlock();
+
+        SimulationTime result = SimulationTime::zero();
+        std::exception_ptr exception;
+        try
+        {
+            result = this->_stepFunction(timeStep);
+        }
+        catch(...)
+        {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+        this->_result = result;
+        this->_exception = exception;
+        this->_state = State::DONE;
+
+        this->_doneCV.notify_all();
+    }
+}
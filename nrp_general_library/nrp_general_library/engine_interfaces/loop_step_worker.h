@@ -0,0 +1,112 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+#ifndef LOOP_STEP_WORKER_H
+#define LOOP_STEP_WORKER_H
+
+#include "nrp_general_library/utils/time_utils.h"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+/*!
+ * \brief Long-lived worker thread executing engine loop steps on request
+ *
+ * The worker thread is created on the first call to LoopStepWorker::start() and reused for all subsequent
+ * loop steps, avoiding to create a new thread for every step. A single step request can be in flight at a time.
+ * Its result is retrieved with LoopStepWorker::get(), which also rethrows exceptions thrown by the step function.
+ */
+class LoopStepWorker
+{
+    public:
+        using step_function_t = std::function<SimulationTime(SimulationTime)>;
+
+        /*!
+         * \brief Constructor
+         * \param stepFunction Function executed by the worker thread on each step request
+         */
+        explicit LoopStepWorker(step_function_t stepFunction);
+
+        /*!
+         * \brief Destructor. Waits for the step in execution, if any, and joins the worker thread
+         */
+        ~LoopStepWorker();
+
+        LoopStepWorker(const LoopStepWorker &) = delete;
+        LoopStepWorker &operator=(const LoopStepWorker &) = delete;
+
+        /*!
+         * \brief Requests the worker thread to execute a step
+         * \param timeStep Parameter passed to the step function
+         * \throw NRPException If the result of the previous step has not been retrieved yet
+         */
+        void start(SimulationTime timeStep);
+
+        /*!
+         * \brief Returns true if a step has been started and its result has not been retrieved yet
+         */
+        bool isPending() const;
+
+        /*!
+         * \brief Waits for the step in execution to complete
+         * \param timeOut Maximum time to wait
+         * \return True if the step has completed, false on timeout
+         */
+        bool waitFor(SimulationTime timeOut);
+
+        /*!
+         * \brief Waits for the step in execution to complete and returns its result
+         * \return Value returned by the step function
+         * \throw Rethrows any exception thrown by the step function
+         */
+        SimulationTime get();
+
+    private:
+
+        /*!
+         * \brief Worker thread main function
+         */
+        void run();
+
+        enum class State { IDLE, REQUESTED, DONE };
+
+        step_function_t _stepFunction;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _requestCV;
+        std::condition_variable _doneCV;
+
+        State _state = State::IDLE;
+        bool _stop = false;
+
+        SimulationTime _timeStep = SimulationTime::zero();
+        SimulationTime _result = SimulationTime::zero();
+        std::exception_ptr _exception;
+
+        std::thread _thread;
+};
+
+#endif // LOOP_STEP_WORKER_H
@@ -29,6 +29,7 @@
 EngineDataPack::EngineDataPack(const std::string &keyword, const DataPackIdentifier &datapackID, bool isPreprocessed)
     : _keyword(keyword),
       _datapackID(datapackID),
+      _datapackHandle(DataPackRegistry::getInstance().intern(datapackID)),
       _isPreprocessed(isPreprocessed)
 {
     assert(this->getFunctionManager() != nullptr);
@@ -47,11 +48,11 @@ datapack_identifiers_set_t EngineDataPack::getRequestedDataPackIDs() const
 }
 
 
-boost::python::object EngineDataPack::runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks)
+boost::python::object EngineDataPack::runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks)
 {
-    const auto dataPack = dataPacks.find(this->_datapackID);
+    const auto dataPack = dataPacks.find(this->_datapackHandle, this->_datapackID);
 
-    if(dataPack != dataPacks.end())
+    if(dataPack != nullptr)
     {
         if(this->_DataPackPassingPolicy == PASS_BY_VALUE)
             kwargs[this->_keyword] = std::shared_ptr<DataPackInterface>((*dataPack)->clone());
@@ -77,6 +78,7 @@ EngineDataPacks::EngineDataPacks(const std::string &keyword, const boost::python
         try
         {
             _datapacksIDs.push_back(DataPackIdentifier(boost::python::extract<std::string>(datapackListNames[i]),_engineName, std::string()));
+            _datapacksHandles.push_back(DataPackRegistry::getInstance().intern(_datapacksIDs.back()));
         }
         catch(boost::python::error_already_set &)
         {
@@ -107,26 +109,16 @@ datapack_identifiers_set_t EngineDataPacks::getRequestedDataPackIDs() const
     return _isPreprocessed ? datapack_identifiers_set_t() : datapackIdentifiersSet;
 }
 
-boost::python::object EngineDataPacks::runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks)
+boost::python::object EngineDataPacks::runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks)
 {
-    // Find all datapacks that belong to the requested engine
-
-    datapacks_set_t engineDataPacks;
-    for(auto dataPack: dataPacks)
-    {
-        if(dataPack->id().EngineName == this->_datapacksIDs.begin()->EngineName)
-        {
-            engineDataPacks.insert(dataPack);
-        }
-    }
-
-    // Find all requested datapacks
+    // Find all requested datapacks. They all belong to the requested engine
 
     boost::python::dict dataPackDict;
-    for(auto requestedId: this->_datapacksIDs)
+    for(size_t i = 0; i < this->_datapacksIDs.size(); ++i)
     {
-        auto dataPack = engineDataPacks.find(requestedId);
-        if(dataPack != engineDataPacks.end())
+        const auto &requestedId = this->_datapacksIDs[i];
+        const auto dataPack = dataPacks.find(this->_datapacksHandles[i], requestedId);
+        if(dataPack != nullptr)
         {
             if(this->_DataPackPassingPolicy == PASS_BY_VALUE)
                 dataPackDict[requestedId.Name] = std::shared_ptr<DataPackInterface>((*dataPack)->clone());
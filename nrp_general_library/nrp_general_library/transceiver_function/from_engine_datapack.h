@@ -44,12 +44,14 @@ class EngineDataPack
 
         datapack_identifiers_set_t getRequestedDataPackIDs() const override;
 
-        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks) override;
+        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks) override;
 
     private:
 
         std::string _keyword;
         DataPackIdentifier _datapackID;
+        /*! \brief Handle of _datapackID in DataPackRegistry, used to look up the datapack without comparing strings */
+        datapack_handle_t _datapackHandle;
         bool _isPreprocessed;
         DataPackPassingPolicy _DataPackPassingPolicy;
 };
@@ -66,12 +68,14 @@ public:
 
     datapack_identifiers_set_t getRequestedDataPackIDs() const override;
 
-    boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks) override;
+    boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks) override;
 
 private:
 
     std::string _keyword;
     std::vector<DataPackIdentifier> _datapacksIDs;
+    /*! \brief Handles of _datapacksIDs in DataPackRegistry, in the same order */
+    std::vector<datapack_handle_t> _datapacksHandles;
     std::string _engineName;
     bool _isPreprocessed;
     DataPackPassingPolicy _DataPackPassingPolicy;
@@ -80,7 +80,7 @@ datapack_identifiers_set_t FunctionManager::getRequestedDataPackIDs() const
 }
 
 
-std::vector<std::shared_ptr<DataPackInterface>> FunctionManager::runDataPackFunction(const std::string &tfName, datapacks_set_t dataPacks)
+std::vector<std::shared_ptr<DataPackInterface>> FunctionManager::runDataPackFunction(const std::string &tfName, const DataPacksView &dataPacks)
 {
     // Find associated TF
     auto tfDataIterator = this->findDataPackFunction(tfName);
@@ -141,7 +141,7 @@ std::vector<std::shared_ptr<DataPackInterface>> FunctionManager::runDataPackFunc
 }
 
 
-FunctionManager::status_function_results_t FunctionManager::executeStatusFunction(datapacks_set_t dataPacks)
+FunctionManager::status_function_results_t FunctionManager::executeStatusFunction(const DataPacksView &dataPacks)
 {
     // Early return in case status function is not registered
 
@@ -223,6 +223,12 @@ FunctionManager::linked_functions_t FunctionManager::getDataPackFunctions(const
     return this->_dataPackFunctions.equal_range(engineName);
 }
 
+
+bool FunctionManager::hasLinkedFunctions(const std::string &engineName) const
+{
+    return this->_dataPackFunctions.count(engineName) > 0;
+}
+
 void FunctionManager::loadStatusFunction(const std::string & statusFunctionName, const std::string & statusFunctionFilename)
 {
     if(this->_statusFunction != nullptr)
@@ -351,8 +357,8 @@ TransceiverDataPackInterfaceSharedPtr *FunctionManager::registerNewStatusFunctio
 }
 
 datapacks_vector_t FunctionManager::executeDataPackFunctions(const std::string &engineName,
-                                                             datapacks_set_t    dataPacks,
-                                                             const bool         preprocessing)
+                                                             const DataPacksView &dataPacks,
+                                                             const bool preprocessing)
 {
     datapacks_vector_t results;
 
@@ -373,12 +379,12 @@ datapacks_vector_t FunctionManager::executeDataPackFunctions(const std::string &
     return results;
 }
 
-datapacks_vector_t FunctionManager::executePreprocessingFunctions(const std::string &engineName, datapacks_set_t dataPacks)
+datapacks_vector_t FunctionManager::executePreprocessingFunctions(const std::string &engineName, const DataPacksView &dataPacks)
 {
     return executeDataPackFunctions(engineName, dataPacks, true);
 }
 
-datapacks_vector_t FunctionManager::executeTransceiverFunctions(const std::string &engineName, datapacks_set_t dataPacks)
+datapacks_vector_t FunctionManager::executeTransceiverFunctions(const std::string &engineName, const DataPacksView &dataPacks)
 {
     return executeDataPackFunctions(engineName, dataPacks, false);
 }
@@ -142,14 +142,21 @@ class FunctionManager
          * \param engineName Name of engine
          * \return Returns results of executed Preprocessing Functions
          */
-        datapacks_vector_t executePreprocessingFunctions(const std::string &engineName, datapacks_set_t dataPacks);
+        datapacks_vector_t executePreprocessingFunctions(const std::string &engineName, const DataPacksView &dataPacks);
 
         /*!
          * \brief Executes all Transceiver Functions linked to an engine
          * \param engineName Name of engine
          * \return Returns results of executed Preprocessing Functions
          */
-        datapacks_vector_t executeTransceiverFunctions(const std::string &engineName, datapacks_set_t dataPacks);
+        datapacks_vector_t executeTransceiverFunctions(const std::string &engineName, const DataPacksView &dataPacks);
+
+        /*!
+         * \brief Checks if any DataPack Processing Function is linked to an engine
+         * \param engineName Name of engine
+         * \return Returns true if at least one Preprocessing or Transceiver Function is linked to the engine
+         */
+        bool hasLinkedFunctions(const std::string &engineName) const;
 
         /*!
          * \brief Executes Status Function registered loaded by the manager
@@ -157,7 +164,7 @@ class FunctionManager
          *
          * This method will run the Status Function that was loaded using `loadStatusFunction` method.
          */
-        status_function_results_t executeStatusFunction(datapacks_set_t dataPacks);
+        status_function_results_t executeStatusFunction(const DataPacksView &dataPacks);
 
     private:
         /*!
@@ -220,7 +227,7 @@ class FunctionManager
          * \param tfName Name of function to execute
          * \return Returns result of execution. Contains a list of datapack commands
          */
-        std::vector<std::shared_ptr<DataPackInterface>> runDataPackFunction(const std::string &tfName, datapacks_set_t dataPacks);
+        std::vector<std::shared_ptr<DataPackInterface>> runDataPackFunction(const std::string &tfName, const DataPacksView &dataPacks);
 
         /*!
          * \brief Get TFs linked to specific engine
@@ -237,7 +244,7 @@ class FunctionManager
          * \return Returns results of executed DataPack Processing Functions
          */
         datapacks_vector_t executeDataPackFunctions(const std::string &engineName,
-                                                    datapacks_set_t dataPacks,
+                                                    const DataPacksView &dataPacks,
                                                     const bool preprocessing);
 
         // Give the function classes access to private methods,
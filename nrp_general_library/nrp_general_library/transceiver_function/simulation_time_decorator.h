@@ -42,7 +42,7 @@ class SimulationTimeDecorator
 
         }
 
-        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks) override
+        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks) override
         {
             kwargs[this->_keyword] = this->getFunctionManager()->getSimulationTime().count();
 
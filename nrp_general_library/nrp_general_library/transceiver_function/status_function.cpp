@@ -48,7 +48,7 @@ bool StatusFunction::isPreprocessing() const
     return false;
 }
 
-boost::python::object StatusFunction::runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t /*dataPacks*/)
+boost::python::object StatusFunction::runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &/*dataPacks*/)
 {
     boost::python::object retVal = this->_function(*args, **kwargs);
 
@@ -82,7 +82,7 @@ class StatusFunction
          * \param kwargs Python keywords
          * \return Result of status function execution
          */
-        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks) override;
+        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks) override;
 
     protected:
         datapack_identifiers_set_t getRequestedDataPackIDs() const override;
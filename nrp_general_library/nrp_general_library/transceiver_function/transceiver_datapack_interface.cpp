@@ -34,7 +34,7 @@ bool TransceiverDataPackInterface::isPreprocessing() const
     return this->_nextDecorator->isPreprocessing();
 }
 
-boost::python::object TransceiverDataPackInterface::runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks)
+boost::python::object TransceiverDataPackInterface::runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks)
 {
     return this->_nextDecorator->runTf(args, kwargs, dataPacks);
 }
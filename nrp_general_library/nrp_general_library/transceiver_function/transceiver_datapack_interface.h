@@ -23,6 +23,7 @@
 #define TRANSCEIVER_DATAPACK_INTERFACE_H
 
 #include "nrp_general_library/engine_interfaces/engine_client_interface.h"
+#include "nrp_general_library/datapack_interface/datapacks_view.h"
 #include "nrp_general_library/utils/ptr_templates.h"
 
 //#include "nrp_general_library/transceiver_function/transceiver_function_interpreter.h"
@@ -79,9 +80,10 @@ class TransceiverDataPackInterface
          * \brief Execute Transceiver Function. Base class will simply call runTf on _function
          * \param args Arguments for execution. Can be altered by any TransceiverDataPackInterfaces. Base class will only pass them along
          * \param kwargs Keyword arguments for execution. Can be altered by any TransceiverDataPackInterfaces. Base class will only pass them along
+         * \param dataPacks View over the DataPacks available to the function. It is passed along without copying
          * \return Returns result of TransceiverFunction execution.
          */
-        virtual boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks);
+        virtual boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks);
 
         /*!
          *  \brief Appends its own datapack requests onto datapackIDs. Uses getRequestedDataPackIDs to check which IDs are requested by this datapack
@@ -46,7 +46,7 @@ TransceiverDataPackInterface::shared_ptr TransceiverFunction::pySetup(boost::pyt
     return tf;
 }
 
-boost::python::object TransceiverFunction::runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t /*dataPacks*/)
+boost::python::object TransceiverFunction::runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &/*dataPacks*/)
 {
     boost::python::object retVal = this->_function(*args, **kwargs);
     this->checkTFOutputIsCorrectOrRaise(retVal);
@@ -63,7 +63,7 @@ class TransceiverFunction
          * \param kwargs Python keywords
          * \return Returns result of TF
          */
-        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, datapacks_set_t dataPacks) override;
+        boost::python::object runTf(boost::python::tuple &args, boost::python::dict &kwargs, const DataPacksView &dataPacks) override;
 
     protected:
         datapack_identifiers_set_t getRequestedDataPackIDs() const override;
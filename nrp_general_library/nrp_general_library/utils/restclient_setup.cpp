@@ -47,3 +47,18 @@ RestClientSetup *RestClientSetup::ensureInstance()
 
 RestClientSetup::RestClientSetup()
 {   RestClient::init(); }
+
+RestClientConnection::RestClientConnection()
+{
+    RestClientSetup::ensureInstance();
+    this->_connection.reset(new RestClient::Connection(""));
+}
+
+RestClient::Response RestClientConnection::post(const std::string &url, const std::string &contentType, const std::string &data)
+{
+    std::lock_guard<std::mutex> lock(this->_connectionLock);
+
+    // Headers are kept between requests, replace them
+    this->_connection->SetHeaders({{"Content-Type", contentType}});
+    return this->_connection->post(url, data);
+}
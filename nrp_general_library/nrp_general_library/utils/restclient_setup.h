@@ -23,6 +23,7 @@
 #define RESTCLIENT_SETUP_H
 
 #include <memory>
+#include <mutex>
 #include <restclient-cpp/connection.h>
 #include <restclient-cpp/restclient.h>
 
@@ -62,4 +63,41 @@ class RestClientSetup
         RestClientSetup();
 };
 
+/*!
+ * \brief Persistent HTTP connection. Requests sent through it reuse the same curl handle, and thus the TCP connections
+ * it keeps open (keep-alive), instead of connecting to the server on every request as RestClient::post does.
+ *
+ * Meant to be owned by a single client, e.g. an engine client. Requests are serialized, so it can be used from several
+ * threads
+ */
+class RestClientConnection
+{
+    public:
+        RestClientConnection();
+
+        // Delete copy constructor and operator
+        RestClientConnection(const RestClientConnection&) = delete;
+        RestClientConnection &operator=(const RestClientConnection&) = delete;
+
+        /*!
+         * \brief Sends a POST request
+         * \param url Request URL
+         * \param contentType Content type of the request body
+         * \param data Request body
+         * \return Returns the server response
+         */
+        RestClient::Response post(const std::string &url, const std::string &contentType, const std::string &data);
+
+    private:
+        /*!
+         * \brief Serializes requests sent through the connection
+         */
+        std::mutex _connectionLock;
+
+        /*!
+         * \brief Connection used for all requests. Its base URL is empty, request URLs must be complete
+         */
+        std::unique_ptr<RestClient::Connection> _connection;
+};
+
 #endif // RESTCLIENT_SETUP_H
@@ -0,0 +1,84 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_general_library/utils/thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t numThreads)
+{
+    numThreads = std::max<size_t>(numThreads, 1);
+
+    this->_threads.reserve(numThreads);
+    for(size_t i = 0; i < numThreads; ++i)
+        this->_threads.emplace_back(&ThreadPool::run, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_stop = true;
+    }
+
+    this->_cv.notify_all();
+
+    for(auto &thread : this->_threads)
+        thread.join();
+}
+
+size_t ThreadPool::size() const
+{
+    return this->_threads.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_tasks.push_back(std::move(task));
+    }
+
+    this->_cv.notify_one();
+}
+
+void ThreadPool::run()
+{
+    while(true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_cv.wait(lock, [this] { return this->_stop || !this->_tasks.empty(); });
+
+            // Queued tasks are executed before stopping
+            if(this->_tasks.empty())
+                return;
+
+            task = std::move(this->_tasks.front());
+            this->_tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,158 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "nrp_general_library/utils/ptr_templates.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*!
+ * \brief Fixed-size pool of worker threads executing tasks in submission order
+ */
+class ThreadPool
+        : public PtrTemplates<ThreadPool>
+{
+    public:
+
+        /*!
+         * \brief Constructor. Starts the worker threads
+         * \param numThreads Number of worker threads. At least one thread is always started
+         */
+        explicit ThreadPool(size_t numThreads);
+
+        /*!
+         * \brief Destructor. Executes the tasks which are still queued and joins the worker threads
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /*!
+         * \brief Queues a task for execution in one of the worker threads
+         * \param fcn Task to be executed
+         * \return Future holding the result of the task, or the exception thrown by it
+         */
+        template<class FCN>
+        std::future<std::invoke_result_t<FCN>> submit(FCN &&fcn)
+        {
+            using result_t = std::invoke_result_t<FCN>;
+
+            // std::function requires copyable targets, hence the task is held in a shared_ptr
+            auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<FCN>(fcn));
+            auto result = task->get_future();
+
+            this->enqueue([task] () { (*task)(); });
+
+            return result;
+        }
+
+        /*!
+         * \brief Executes fcn(i) for every i in [0, numCalls) concurrently and waits until all calls have finished
+         *
+         * One of the calls is executed in the calling thread. If any of the calls throws, the exception
+         * thrown by the call with lowest index is rethrown, but only after all calls have finished.
+         *
+         * \param numCalls Number of calls
+         * \param fcn Function to be called
+         */
+        template<class FCN>
+        void parallelFor(size_t numCalls, FCN &&fcn)
+        {
+            std::vector<std::future<void>> results;
+            results.reserve(numCalls);
+
+            for(size_t i = 1; i < numCalls; ++i)
+                results.push_back(this->submit([&fcn, i] () { fcn(i); }));
+
+            std::exception_ptr firstException;
+            if(numCalls > 0)
+            {
+                try
+                {
+                    fcn(0);
+                }
+                catch(...)
+                {
+                    firstException = std::current_exception();
+                }
+            }
+
+            // Wait for all calls before rethrowing, they reference objects in the calling scope
+            for(auto &result : results)
+                result.wait();
+
+            for(auto &result : results)
+            {
+                try
+                {
+                    result.get();
+                }
+                catch(...)
+                {
+                    if(!firstException)
+                        firstException = std::current_exception();
+                }
+            }
+
+            if(firstException)
+                std::rethrow_exception(firstException);
+        }
+
+        /*!
+         * \brief Returns the number of worker threads
+         */
+        size_t size() const;
+
+    private:
+
+        /*!
+         * \brief Adds a task to the queue and wakes up one worker thread
+         */
+        void enqueue(std::function<void()> task);
+
+        /*!
+         * \brief Worker thread main function
+         */
+        void run();
+
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::deque<std::function<void()>> _tasks;
+        bool _stop = false;
+
+        std::vector<std::thread> _threads;
+};
+
+using ThreadPoolSharedPtr = ThreadPool::shared_ptr;
+
+#endif // THREAD_POOL_H
@@ -54,3 +54,29 @@ TEST(DataDataPackTest, GetData)
     dev.getData();
     ASSERT_FALSE(dev.isEmpty());
 }
+
+TEST(DataDataPackTest, CloneCopyOnWrite)
+{
+    DataPack<std::vector<int>> dev("datapackName1", "engine1", new std::vector<int>({1, 2, 3}));
+
+    // Clones share data until write access is requested
+    std::unique_ptr<DataPack<std::vector<int>>> clone(dynamic_cast<DataPack<std::vector<int>>*>(dev.clone()));
+    ASSERT_EQ(&clone->getData(), &dev.getData());
+    ASSERT_EQ(clone->id(), dev.id());
+
+    clone->getMutableData().push_back(4);
+    ASSERT_NE(&clone->getData(), &dev.getData());
+    ASSERT_EQ(clone->getData().size(), 4);
+    ASSERT_EQ(dev.getData().size(), 3);
+
+    // Data which is not shared is not copied
+    const auto *data = &dev.getData();
+    ASSERT_EQ(&dev.getMutableData(), data);
+
+    // The original DataPack copies the data too when writing to it after clone()
+    std::unique_ptr<DataPackInterface> clone2(dev.clone());
+    dev.getMutableData().push_back(5);
+    ASSERT_NE(&dev.getData(), data);
+    ASSERT_EQ(&dynamic_cast<DataPack<std::vector<int>>*>(clone2.get())->getData(), data);
+    ASSERT_EQ(data->size(), 3);
+}
@@ -0,0 +1,197 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include <gtest/gtest.h>
+#include <type_traits>
+
+#include "nrp_general_library/datapack_interface/datapacks_view.h"
+
+using namespace testing;
+
+TEST(DataPackRegistryTest, Intern)
+{
+    auto &registry = DataPackRegistry::getInstance();
+
+    const auto handle1 = registry.intern(DataPackIdentifier("registry_datapack1", "registry_engine1", "type1"));
+    const auto handle2 = registry.intern(DataPackIdentifier("registry_datapack2", "registry_engine1", "type1"));
+    const auto handle3 = registry.intern(DataPackIdentifier("registry_datapack1", "registry_engine2", "type1"));
+
+    ASSERT_NE(handle1, handle2);
+    ASSERT_NE(handle1, handle3);
+    ASSERT_NE(handle2, handle3);
+
+    // Type is not part of the key, as in DataPackPointerComparator
+    ASSERT_EQ(registry.intern(DataPackIdentifier("registry_datapack1", "registry_engine1", "type2")), handle1);
+
+    ASSERT_EQ(registry.identifier(handle3).Name, "registry_datapack1");
+    ASSERT_EQ(registry.identifier(handle3).EngineName, "registry_engine2");
+    ASSERT_LT(handle3, registry.size());
+
+    datapack_handle_t handle;
+    ASSERT_TRUE(registry.find(DataPackIdentifier("registry_datapack2", "registry_engine1", ""), handle));
+    ASSERT_EQ(handle, handle2);
+    ASSERT_FALSE(registry.find(DataPackIdentifier("registry_datapack3", "registry_engine1", ""), handle));
+
+    // Creating DataPacks doesn't register their identifiers
+    const auto size = registry.size();
+    DataPackInterface dataPack("registry_datapack3", "registry_engine1", "type1");
+    dataPack.setName("registry_datapack4");
+    ASSERT_EQ(registry.size(), size);
+}
+
+TEST(DataPackRegistryTest, FindDataPack)
+{
+    auto &registry = DataPackRegistry::getInstance();
+
+    const DataPackInterface dataPack("registry_cached_datapack1", "registry_engine1", "type1");
+    datapack_handle_t handle;
+
+    // A cached miss is discarded when a new identifier is registered
+    ASSERT_FALSE(registry.find(dataPack, handle));
+    ASSERT_FALSE(registry.find(dataPack, handle));
+    const auto handle1 = registry.intern(dataPack.id());
+    ASSERT_TRUE(registry.find(dataPack, handle));
+    ASSERT_EQ(handle, handle1);
+
+    // Copies keep the cached handle, changing the identifier discards it
+    DataPackInterface dataPackCopy(dataPack);
+    ASSERT_TRUE(registry.find(dataPackCopy, handle));
+    ASSERT_EQ(handle, handle1);
+
+    dataPackCopy.setName("registry_cached_datapack2");
+    ASSERT_FALSE(registry.find(dataPackCopy, handle));
+
+    const auto handle2 = registry.intern(DataPackIdentifier("registry_cached_datapack2", "registry_engine2", ""));
+    dataPackCopy.setEngineName("registry_engine2");
+    ASSERT_TRUE(registry.find(dataPackCopy, handle));
+    ASSERT_EQ(handle, handle2);
+
+    dataPackCopy.setID(dataPack.id());
+    ASSERT_TRUE(registry.find(dataPackCopy, handle));
+    ASSERT_EQ(handle, handle1);
+}
+
+TEST(DataPackPoolTest, UpdateAndInsert)
+{
+    DataPackPool pool;
+    ASSERT_TRUE(pool.empty());
+
+    // Only the identifier of the first DataPack is registered, the pool handles both the same way
+    const auto handle1 = DataPackRegistry::getInstance().intern(DataPackIdentifier("pool_datapack1", "pool_engine1", ""));
+
+    DataPackInterfaceConstSharedPtr dataPack1(new DataPackInterface("pool_datapack1", "pool_engine1", "type"));
+    DataPackInterfaceConstSharedPtr dataPack2(new DataPackInterface("pool_datapack2", "pool_engine2", "type"));
+    DataPackInterfaceConstSharedPtr dataPack1New(new DataPackInterface("pool_datapack1", "pool_engine1", "type"));
+    DataPackInterfaceConstSharedPtr dataPack2New(new DataPackInterface("pool_datapack2", "pool_engine2", "type"));
+
+    pool.update(dataPack1);
+    pool.update(dataPack2);
+    ASSERT_EQ(pool.size(), 2);
+    ASSERT_EQ(pool.find(handle1, dataPack1->id()), dataPack1);
+    ASSERT_EQ(pool.find(dataPack1->id()), dataPack1);
+    ASSERT_EQ(pool.find(dataPack2->id()), dataPack2);
+
+    // Insert doesn't replace existing DataPacks, update does
+    ASSERT_FALSE(pool.insert(dataPack1New));
+    ASSERT_FALSE(pool.insert(dataPack2New));
+    ASSERT_EQ(pool.find(dataPack1->id()), dataPack1);
+    ASSERT_EQ(pool.find(dataPack2->id()), dataPack2);
+
+    const auto version = pool.version();
+    pool.update(dataPack1New);
+    pool.update(dataPack2New);
+    ASSERT_EQ(pool.size(), 2);
+    ASSERT_EQ(pool.find(dataPack1->id()), dataPack1New);
+    ASSERT_EQ(pool.find(dataPack2->id()), dataPack2New);
+    ASSERT_EQ(pool.find(*dataPack1), dataPack1New);
+    ASSERT_EQ(pool.find(*dataPack2), dataPack2New);
+
+    // DataPacks are filtered by engine and version
+    datapacks_vector_t engineDataPacks;
+    const auto pushBack = [&engineDataPacks] (const DataPackInterfaceConstSharedPtr &dataPack) {
+        engineDataPacks.push_back(dataPack);
+    };
+    pool.forEachOfEngine("pool_engine2", pushBack);
+    ASSERT_EQ(engineDataPacks, datapacks_vector_t({dataPack2New}));
+
+    engineDataPacks.clear();
+    pool.forEachUpdatedOfEngine("pool_engine1", version, pushBack);
+    ASSERT_EQ(engineDataPacks, datapacks_vector_t({dataPack1New}));
+
+    engineDataPacks.clear();
+    pool.forEachUpdatedOfEngine("pool_engine1", pool.version(), pushBack);
+    ASSERT_TRUE(engineDataPacks.empty());
+
+    const auto dataPacks = pool.toSet();
+    ASSERT_EQ(dataPacks.size(), 2);
+    ASSERT_EQ(*dataPacks.find(dataPack1New->id()), dataPack1New);
+
+    pool.clear();
+    ASSERT_TRUE(pool.empty());
+    ASSERT_EQ(pool.find(handle1, dataPack1->id()), nullptr);
+    ASSERT_EQ(pool.find(dataPack2->id()), nullptr);
+}
+
+TEST(DataPacksViewTest, Find)
+{
+    DataPackInterfaceConstSharedPtr dataPack1(new DataPackInterface("view_datapack1", "view_engine", "type"));
+    DataPackInterfaceConstSharedPtr dataPack2(new DataPackInterface("view_datapack2", "view_engine", "type"));
+    DataPackInterfaceConstSharedPtr dataPack1Low(new DataPackInterface("view_datapack1", "view_engine", "type"));
+
+    DataPackPool pool1;
+    pool1.update(dataPack1);
+
+    DataPackPool pool2;
+    pool2.update(dataPack1Low);
+    pool2.update(dataPack2);
+
+    // Pools are chained in order of precedence
+    const DataPacksView poolsView({&pool1, &pool2});
+    ASSERT_EQ(*poolsView.find(dataPack1->id()), dataPack1);
+    ASSERT_EQ(poolsView.find(DataPackIdentifier("view_datapack3", "view_engine", "type")), nullptr);
+    ASSERT_EQ(poolsView.toSet().size(), 2);
+
+    // DataPacks stored before their identifier was registered are still found, also after being updated
+    const auto handle2 = DataPackRegistry::getInstance().intern(dataPack2->id());
+    ASSERT_EQ(*poolsView.find(handle2, dataPack2->id()), dataPack2);
+
+    DataPackInterfaceConstSharedPtr dataPack2New(new DataPackInterface("view_datapack2", "view_engine", "type"));
+    pool2.update(dataPack2New);
+    ASSERT_EQ(*poolsView.find(handle2, dataPack2->id()), dataPack2New);
+    ASSERT_EQ(pool2.size(), 2);
+
+    // The view doesn't copy the pools
+    DataPackInterfaceConstSharedPtr dataPack3(new DataPackInterface("view_datapack3", "view_engine", "type"));
+    pool2.update(dataPack3);
+    ASSERT_EQ(*poolsView.find(dataPack3->id()), dataPack3);
+
+    // Views over sets must be created explicitly, and not from temporaries
+    static_assert(!std::is_convertible_v<const datapacks_set_t &, DataPacksView>);
+    static_assert(!std::is_constructible_v<DataPacksView, datapacks_set_t &&>);
+
+    const datapacks_set_t dataPacks({dataPack2});
+    const DataPacksView setView(dataPacks);
+    ASSERT_EQ(*setView.find(dataPack2->id()), dataPack2);
+    ASSERT_EQ(setView.find(dataPack1->id()), nullptr);
+}
+
+// EOF
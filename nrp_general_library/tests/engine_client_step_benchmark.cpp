@@ -0,0 +1,141 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+
+#include "nrp_general_library/engine_interfaces/engine_client_interface.h"
+
+using namespace std::chrono;
+
+namespace
+{
+    constexpr unsigned NUM_STEPS = 10000;
+
+    struct BenchmarkEngineConfigConst
+    {
+        static constexpr char EngineType[] = "benchmark_engine";
+        static constexpr char EngineSchema[] = "json://nrp-core/engines/engine_base.json#EngineBase";
+    };
+
+    /*!
+     * \brief Engine client whose steps do no work, so that only the overhead of running them asynchronously is measured
+     */
+    class BenchmarkEngine
+            : public EngineClient<BenchmarkEngine, BenchmarkEngineConfigConst::EngineSchema>
+    {
+    public:
+        BenchmarkEngine(nlohmann::json &configHolder, ProcessLauncherInterface::unique_ptr &&launcher)
+                : EngineClient(configHolder, std::move(launcher))
+        {}
+
+        void initialize() override
+        {}
+
+        void reset() override
+        {}
+
+        void shutdown() override
+        {}
+
+        const std::vector<std::string> engineProcStartParams() const override
+        { return std::vector<std::string>(); }
+
+        void sendDataPacksToEngine(const datapacks_set_t &) override
+        {}
+
+        SimulationTime runLoopStepCallback(SimulationTime timeStep) override
+        { return this->getEngineTime() + timeStep; }
+
+        datapacks_vector_t getDataPacksFromEngine(const datapack_identifiers_set_t &) override
+        { return datapacks_vector_t(); }
+    };
+
+    /*!
+     * \brief Mean duration in nanoseconds of a step run and retrieved on the engine worker thread
+     */
+    long workerStepNs(BenchmarkEngine &engine, SimulationTime timeStep)
+    {
+        const auto start = steady_clock::now();
+        for(unsigned i = 0; i < NUM_STEPS; ++i)
+        {
+            engine.runLoopStepAsync(timeStep);
+            engine.runLoopStepAsyncGet(SimulationTime::zero());
+        }
+        const auto duration = steady_clock::now() - start;
+
+        if(engine.getEngineTime() != NUM_STEPS*timeStep)
+            std::abort();
+
+        return duration_cast<nanoseconds>(duration).count() / NUM_STEPS;
+    }
+
+    /*!
+     * \brief Mean duration in nanoseconds of a step run on a new thread started with std::async
+     */
+    long asyncStepNs(SimulationTime timeStep)
+    {
+        SimulationTime engineTime = SimulationTime::zero();
+
+        const auto start = steady_clock::now();
+        for(unsigned i = 0; i < NUM_STEPS; ++i)
+        {
+            auto stepThread = std::async(std::launch::async, [engineTime, timeStep] () { return engineTime + timeStep; });
+            engineTime = stepThread.get();
+        }
+        const auto duration = steady_clock::now() - start;
+
+        if(engineTime != NUM_STEPS*timeStep)
+            std::abort();
+
+        return duration_cast<nanoseconds>(duration).count() / NUM_STEPS;
+    }
+}
+
+/*!
+ * \brief Compares the per-step overhead of the engine worker thread with the overhead of starting a new thread with
+ * std::async on every step
+ *
+ * The benchmark isn't part of the test suite, it must be run manually.
+ */
+int main()
+{
+    nlohmann::json config;
+    config["EngineName"] = "Name";
+    config["EngineType"] = "EngineType";
+
+    BenchmarkEngine engine(config, nullptr);
+    const SimulationTime timeStep(1);
+
+    const auto workerNs = workerStepNs(engine, timeStep);
+    const auto asyncNs  = asyncStepNs(timeStep);
+
+    std::cout << "Per-step overhead, mean of " << NUM_STEPS << " steps:\n"
+              << "  Engine worker thread: " << workerNs << " ns\n"
+              << "  std::async:           " << asyncNs << " ns\n";
+
+    return EXIT_SUCCESS;
+}
+
+// EOF
@@ -57,9 +57,9 @@ public:
     virtual void sendDataPacksToEngine(const datapacks_set_t &) override
     {}
 
-    virtual SimulationTime runLoopStepCallback(SimulationTime) override
+    virtual SimulationTime runLoopStepCallback(SimulationTime timeStep) override
     {
-        return SimulationTime::zero();
+        return this->getEngineTime() + timeStep;
     }
 
 
@@ -117,3 +117,50 @@ TEST(EngineClientTest, EngineExtraConfigs)
 }
 
 
+
+TEST(EngineClientTest, RunLoopStepAsync)
+{
+    nlohmann::json config;
+    config["EngineName"] = "Name";
+    config["EngineType"] = "EngineType";
+
+    TestEngine engine(config, nullptr);
+
+    const SimulationTime timeStep(1000);
+    ASSERT_NO_THROW(engine.runLoopStepAsync(timeStep));
+    ASSERT_THROW(engine.runLoopStepAsync(timeStep), NRPException);
+    ASSERT_NO_THROW(engine.runLoopStepAsyncGet(SimulationTime::zero()));
+    ASSERT_EQ(engine.getEngineTime(), timeStep);
+
+    // The result can be retrieved only once
+    ASSERT_NO_THROW(engine.runLoopStepAsyncGet(SimulationTime::zero()));
+    ASSERT_EQ(engine.getEngineTime(), timeStep);
+
+    // The same worker thread is reused for the following steps
+    ASSERT_NO_THROW(engine.runLoopStepAsync(timeStep));
+    ASSERT_NO_THROW(engine.runLoopStepAsyncGet(std::chrono::seconds(1)));
+    ASSERT_EQ(engine.getEngineTime(), timeStep + timeStep);
+}
+
+TEST(EngineClientTest, RunLoopStepAsyncRepeated)
+{
+    // All the steps run on the same worker thread, which must be ready for the next step as soon as the
+    // previous one is retrieved
+
+    nlohmann::json config;
+    config["EngineName"] = "Name";
+    config["EngineType"] = "EngineType";
+
+    TestEngine engine(config, nullptr);
+
+    constexpr unsigned numSteps = 10000;
+    const SimulationTime timeStep(1);
+
+    for(unsigned i = 0; i < numSteps; ++i)
+    {
+        ASSERT_NO_THROW(engine.runLoopStepAsync(timeStep));
+        ASSERT_NO_THROW(engine.runLoopStepAsyncGet(SimulationTime::zero()));
+    }
+
+    ASSERT_EQ(engine.getEngineTime(), numSteps*timeStep);
+}
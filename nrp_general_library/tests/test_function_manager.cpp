@@ -115,7 +115,7 @@ TEST_F(FunctionManagerTest, TestTransceiverFunction)
     ASSERT_EQ(reqIDs.size(), 1);
     ASSERT_EQ(*(reqIDs.begin()), DataPackIdentifier(devName, this->engineName, ""));
 
-    auto results = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test execution result
 
@@ -139,7 +139,7 @@ TEST_F(FunctionManagerTest, TestTransceiverFunctionUnregistered)
 
     // Try to run a TF without any TFs registered in the functionManager
 
-    auto results = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
     ASSERT_EQ(results.size(), 0);
 }
 
@@ -191,7 +191,7 @@ TEST_F(FunctionManagerTest, TestTransceiverFunctionInvalid)
     const std::string tfFilename = TEST_INVALID_TRANSCEIVER_FCN_FILE_NAME;
 
     functionManager->loadDataPackFunction(tfName, tfFilename);
-    ASSERT_THROW(functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks), NRPException);
+    ASSERT_THROW(functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks)), NRPException);
 }
 
 
@@ -217,7 +217,7 @@ TEST_F(FunctionManagerTest, TestDataPackPassingByValue)
     this->prepareInputDataPack("preprocessed_datapack", testValuePreprocessed);
     functionManager->loadDataPackFunction(tfName, tfFilename);
 
-    auto results = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test content of the engine datapack (retrieved using EngineDataPack decorator)
     // Content of the original DataPack should not be changed, the TF was working with a copy of the original DataPack
@@ -237,6 +237,39 @@ TEST_F(FunctionManagerTest, TestDataPackPassingByValue)
 }
 
 
+/*
+ * Setup:
+ * - One transceiver function that takes one EngineDataPack and only reads its data
+ * - The DataPack is passed to the TF using PASS_BY_VALUE method
+ * - The data of the DataPack is not modified, so it should not be copied
+ */
+TEST_F(FunctionManagerTest, TestDataPackPassingByValueReadOnly)
+{
+    const std::string tfName     = "testTF";
+    const std::string tfFilename = TEST_TRANSCEIVER_FCN_READ_ONLY_FILE_NAME;
+
+    const int testValueEngine = 4;
+
+    functionManager->setDataPackPassingPolicy(PASS_BY_VALUE);
+
+    this->prepareInputDataPack("engine_datapack", testValueEngine);
+    functionManager->loadDataPackFunction(tfName, tfFilename);
+
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
+
+    ASSERT_EQ(results.size(), 2);
+
+    // The returned copy of the input DataPack still shares its data with the original DataPack
+
+    auto resultDataPack   = castToJsonDataPack(results.at(0));
+    auto originalDataPack = castToJsonDataPack(*dataPacks.find(resultDataPack->id()));
+    ASSERT_EQ(&originalDataPack->getData(), &resultDataPack->getData());
+
+    resultDataPack = castToJsonDataPack(results.at(1));
+    ASSERT_EQ(resultDataPack->getData()["testValue"], testValueEngine + 1);
+}
+
+
 /*
  * Setup:
  * - One transceiver function that takes two DataPacks - one EngineDataPack and one PreprocessedDataPack
@@ -259,7 +292,7 @@ TEST_F(FunctionManagerTest, TestDataPackPassingByReference)
     this->prepareInputDataPack("preprocessed_datapack", testValuePreprocessed);
     functionManager->loadDataPackFunction(tfName, tfFilename);
 
-    auto results = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test content of the engine datapack (retrieved using EngineDataPack decorator)
     // Content of the original DataPack should be modified
@@ -301,7 +334,7 @@ TEST_F(FunctionManagerTest, TestDataPackPassingByValueList)
     this->prepareInputDataPack("engine_datapack2", testValueEngine2);
     functionManager->loadDataPackFunction(tfName, tfFilename);
 
-    auto results = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test content of the first engine datapack
     // Content of the original DataPack should not be changed, the TF was working with a copy of the original DataPack
@@ -343,7 +376,7 @@ TEST_F(FunctionManagerTest, TestDataPackPassingByReferenceList)
     this->prepareInputDataPack("engine_datapack2", testValueEngine2);
     functionManager->loadDataPackFunction(tfName, tfFilename);
 
-    auto results = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test content of the first engine datapack
     // Content of the original DataPack should be modified
@@ -385,7 +418,7 @@ TEST_F(FunctionManagerTest, TestPreprocessingFunction)
 
     // Run the preprocessing funtion
 
-    auto results = functionManager->executePreprocessingFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executePreprocessingFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test execution result
     // Results are a list of DataPackFunctionResult objects
@@ -409,7 +442,7 @@ TEST_F(FunctionManagerTest, TestPreprocessingFunctionUnregistered)
 
     // Try to run a PF without any PFs registered in the functionManager
 
-    auto results = functionManager->executePreprocessingFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executePreprocessingFunctions(this->engineName, DataPacksView(this->dataPacks));
     ASSERT_EQ(results.size(), 0);
 }
 
@@ -443,7 +476,7 @@ TEST_F(FunctionManagerTest, TestPreprocessingFunctionMultipleDataPacks)
 
     // Run the preprocessing funtion
 
-    auto results = functionManager->executePreprocessingFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executePreprocessingFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test execution result
 
@@ -491,7 +524,7 @@ TEST_F(FunctionManagerTest, TestPreprocessingFunctionWrongOutputDataPack)
 
     // Run the preprocessing function and fail
 
-    ASSERT_THROW(functionManager->executePreprocessingFunctions(this->engineName, this->dataPacks), NRPException);
+    ASSERT_THROW(functionManager->executePreprocessingFunctions(this->engineName, DataPacksView(this->dataPacks)), NRPException);
 }
 
 /*
@@ -530,7 +563,7 @@ TEST_F(FunctionManagerTest, TestFunctionChain)
 
     // Run the preprocessing funtion
 
-    auto resultsPf = functionManager->executePreprocessingFunctions(this->engineName, this->dataPacks);
+    auto resultsPf = functionManager->executePreprocessingFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test execution result
     // Results are a list of DataPackFunctionResult objects
@@ -546,7 +579,7 @@ TEST_F(FunctionManagerTest, TestFunctionChain)
 
     // Run the transceiver function
 
-    auto resultsTf = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto resultsTf = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test the results
 
@@ -560,7 +593,7 @@ TEST_F(FunctionManagerTest, TestFunctionChain)
     this->insertInputDataPack(resultDataPack);
 
     functionManager->loadStatusFunction(statusFuntionName, statusFuntionFilename);
-    auto results = functionManager->executeStatusFunction(this->dataPacks);
+    auto results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
 
     bool doneFlag = std::get<0>(results);
     ASSERT_TRUE(doneFlag);
@@ -586,14 +619,14 @@ TEST_F(FunctionManagerTest, TestStatusFunctionDoneFlag)
     auto requestedIds = functionManager->getRequestedDataPackIDs();
     ASSERT_EQ(requestedIds.size(), 1);
     ASSERT_EQ(requestedIds.begin()->Name, devName);
-    auto results = functionManager->executeStatusFunction(this->dataPacks);
+    auto results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
 
     bool doneFlag = std::get<0>(results);
     ASSERT_TRUE(doneFlag);
 
     this->dataPacks.begin()->get()->resetIsUpdated();
 
-    results = functionManager->executeStatusFunction(this->dataPacks);
+    results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
 
     doneFlag = std::get<0>(results);
     ASSERT_FALSE(doneFlag);
@@ -609,19 +642,19 @@ TEST_F(FunctionManagerTest, TestStatusFunctionData)
 
     // First execution - there should be no DataPacks in the results
 
-    auto results = functionManager->executeStatusFunction(this->dataPacks);
+    auto results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
     datapacks_vector_t dataPacks = std::get<1>(results);
     ASSERT_EQ(dataPacks.size(), 0);
 
     // Second execution - there should be a single DataPack in the results
 
-    results = functionManager->executeStatusFunction(this->dataPacks);
+    results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
     dataPacks = std::get<1>(results);
     ASSERT_EQ(dataPacks.size(), 1);
 
     // Third execution - there should be two DataPacks in the results
 
-    results = functionManager->executeStatusFunction(this->dataPacks);
+    results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
     dataPacks = std::get<1>(results);
     ASSERT_EQ(dataPacks.size(), 2);
 }
@@ -636,7 +669,7 @@ TEST_F(FunctionManagerTest, TestSimulationTimeAndIter)
 
     // First execution - test what happens when the time was never set
 
-    auto results = functionManager->executeStatusFunction(this->dataPacks);
+    auto results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
     datapacks_vector_t dataPacks = std::get<1>(results);
     ASSERT_EQ(dataPacks.size(), 1);
     ASSERT_EQ(castToJsonDataPack(dataPacks.at(0))->getData()["sim_time"], 0);
@@ -649,7 +682,7 @@ TEST_F(FunctionManagerTest, TestSimulationTimeAndIter)
     functionManager->setSimulationTime(toSimulationTime<int, std::ratio<1>>(1));
     functionManager->setSimulationIteration(1);
 
-    results = functionManager->executeStatusFunction(this->dataPacks);
+    results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
     dataPacks = std::get<1>(results);
     ASSERT_EQ(dataPacks.size(), 1);
     ASSERT_EQ(castToJsonDataPack(dataPacks.at(0))->getData()["sim_time"], 1000000000);
@@ -687,7 +720,7 @@ TEST_F(FunctionManagerTest, TestStatusFunctionInvalid)
     const std::string statusFuntionFilename = TEST_INVALID_STATUS_FCN_FILE_NAME;
 
     functionManager->loadStatusFunction(statusFuntionName, statusFuntionFilename);
-    ASSERT_THROW(functionManager->executeStatusFunction(this->dataPacks), NRPException);
+    ASSERT_THROW(functionManager->executeStatusFunction(DataPacksView(this->dataPacks)), NRPException);
 }
 
 
@@ -712,7 +745,7 @@ TEST_F(FunctionManagerTest, TestStatusFunctionNoFile)
  */
 TEST_F(FunctionManagerTest, TestStatusFunctionUndefined)
 {
-    auto results = functionManager->executeStatusFunction(this->dataPacks);
+    auto results = functionManager->executeStatusFunction(DataPacksView(this->dataPacks));
     bool doneFlag = std::get<0>(results);
 
     ASSERT_EQ(doneFlag, false);
@@ -745,7 +778,7 @@ TEST_F(FunctionManagerTest, TestMultiDataPacksTf)
     // Test execution result
     // Results are a list of DataPackFunctionResult objects
 
-    auto results = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto results = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     ASSERT_EQ(results.size(), 1);
 
@@ -783,7 +816,7 @@ TEST_F(FunctionManagerTest, TestMultiDataPacksTfInvalid)
     ASSERT_EQ(reqIDs.size(), 2);
 
     // Test execution result
-    ASSERT_THROW(functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks), NRPException);
+    ASSERT_THROW(functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks)), NRPException);
 }
 
 /*
@@ -817,7 +850,7 @@ TEST_F(FunctionManagerTest, TestFunctionChainMultiDataPacks)
 
     // Run the preprocessing function
 
-    auto resultsPf = functionManager->executePreprocessingFunctions(this->engineName, this->dataPacks);
+    auto resultsPf = functionManager->executePreprocessingFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test execution result
     // Results are a list of DataPackFunctionResult objects
@@ -833,7 +866,7 @@ TEST_F(FunctionManagerTest, TestFunctionChainMultiDataPacks)
 
     // Run the transceiver function
 
-    auto resultsTf = functionManager->executeTransceiverFunctions(this->engineName, this->dataPacks);
+    auto resultsTf = functionManager->executeTransceiverFunctions(this->engineName, DataPacksView(this->dataPacks));
 
     // Test the results
 
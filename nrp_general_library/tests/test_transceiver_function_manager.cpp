@@ -37,7 +37,7 @@ const std::string &TestSimpleTransceiverDataPack::linkedEngineName() const
     return this->_linkedEngine;
 }
 
-boost::python::object TestSimpleTransceiverDataPack::runTf(python::tuple &args, python::dict &kwargs, datapacks_set_t/* dataPacks*/)
+boost::python::object TestSimpleTransceiverDataPack::runTf(python::tuple &args, python::dict &kwargs, const DataPacksView &/*dataPacks*/)
 {   return this->_fcn(*args, **kwargs); }
 
 datapack_identifiers_set_t TestSimpleTransceiverDataPack::updateRequestedDataPackIDs(datapack_identifiers_set_t &&datapackIDs) const
@@ -177,15 +177,16 @@ namespace
     /*!
      * \brief Generic REST call function
      *
+     * \param connection Connection to the NEST server
      * \param url   URL to query
      * \param ctype Content type as string
      * \param data  HTTP POST body
      * \throws NRPException On response code different from 200
      * \return Response body as string
      */
-    std::string nestGenericCall(const std::string & url, const std::string & ctype, const std::string & data)
+    std::string nestGenericCall(RestClientConnection & connection, const std::string & url, const std::string & ctype, const std::string & data)
     {
-        auto resp = RestClient::post(url, ctype, data);
+        auto resp = connection.post(url, ctype, data);
 
         if(resp.code != 200)
         {
@@ -198,28 +199,30 @@ namespace
     /*!
      * \brief Sends SetStatus request to NEST server
      *
+     * \param connection Connection to the NEST server
      * \param serverAddress Address of the NEST server
      * \param argsStr Comma-separated arguments list to SetStatus as string (e.g. "arg1, arg2")
      * \param kwargsStr Comma-separated keyword arguments to SetStatus as string (e.g. (" "key1": value1, "key2": value2 "))
 
      */
-    void nestSetStatus(const std::string & serverAddress, const std::string & argsStr, const std::string & kwargsStr)
+    void nestSetStatus(RestClientConnection & connection, const std::string & serverAddress, const std::string & argsStr, const std::string & kwargsStr)
     {
         // equivalent to a NESTClient call client.SetStatus(arg1, arg2, key1=value1, key2=value2})
         std::stringstream data;
         data << "{" << R"("args": )" << "[" << argsStr << "], " << kwargsStr << "}";
 
-        nestGenericCall(serverAddress + "/api/SetStatus","application/json", data.str());
+        nestGenericCall(connection, serverAddress + "/api/SetStatus","application/json", data.str());
     }
 
     /*!
      * \brief Sends GetStatus request to NEST server
      *
+     * \param connection Connection to the NEST server
      * \param serverAddress Address of the NEST server
      * \param argsStr Comma-separated arguments list to GetStatus as string (e.g. "arg1, arg2"))
      * \return Response from GetStatus as string
      */
-    std::string nestGetStatus(const std::string & serverAddress, const std::string & argsStr)
+    std::string nestGetStatus(RestClientConnection & connection, const std::string & serverAddress, const std::string & argsStr)
     {
         //TODO kwargs support so to select keys to get.
         // Datapacks can't pass that info to engine clients yet.
@@ -227,69 +230,74 @@ namespace
         std::stringstream data;
         data << "{" << R"("args": )" << "[" << argsStr << "]" << "}";
 
-        return nestGenericCall(serverAddress + "/api/GetStatus", "application/json", data.str());
+        return nestGenericCall(connection, serverAddress + "/api/GetStatus", "application/json", data.str());
     }
 
     /*!
      * \brief Sends GetConnections request to NEST server
      *
+     * \param connection Connection to the NEST server
      * \param serverAddress Address of the NEST server
      * \param source_ids_str The IDs of the pre-synaptic population as a JSON list
      * \param target_ids_str The IDs of the post-synaptic population as a JSON list
      * \return Response from GetConnections as string
      */
-    std::string nestGetConnections(const std::string & serverAddress, const std::string & source_ids_str, const std::string & target_ids_str)
+    std::string nestGetConnections(RestClientConnection & connection, const std::string & serverAddress, const std::string & source_ids_str, const std::string & target_ids_str)
     {
         //TODO kwargs support so to select keys to get.
         // Datapacks can't pass that info to engine clients yet.
         // equivalent to a NESTClient call client.GetConnections(source=source_ids_str, target=target_ids_str})
         std::stringstream data;
         data << "{ " << R"("source": )" << source_ids_str << ", " << R"("target": )" << target_ids_str << " }";
-        return nestGenericCall(serverAddress + "/api/GetConnections", "application/json", data.str());
+        return nestGenericCall(connection, serverAddress + "/api/GetConnections", "application/json", data.str());
     }
 
     /*!
      * \brief Sends ResetKernel request to NEST server
      *
+     * \param connection Connection to the NEST server
      * \param serverAddress Address of the NEST server
      */
-    void nestResetKernel(const std::string & serverAddress)
+    void nestResetKernel(RestClientConnection & connection, const std::string & serverAddress)
     {
-        nestGenericCall(serverAddress + "/api/ResetKernel", "text/plain", "");
+        nestGenericCall(connection, serverAddress + "/api/ResetKernel", "text/plain", "");
     }
 
     /*!
      * \brief Sends Run request to NEST server
      *
+     * \param connection Connection to the NEST server
      * \param serverAddress Address of the NEST server
      * \param timeStep Step of the simulation in milliseconds
      */
-    void nestSimulate(const std::string & serverAddress, const float timeStep)
+    void nestSimulate(RestClientConnection & connection, const std::string & serverAddress, const float timeStep)
     {
-        nestGenericCall(serverAddress + "/api/Simulate", "application/json", "[" + std::to_string(timeStep) + "]");
+        nestGenericCall(connection, serverAddress + "/api/Simulate", "application/json", "[" + std::to_string(timeStep) + "]");
     }
 
     /*!
      * \brief Sends GetKernelStatus request to NEST server
      *
+     * \param connection Connection to the NEST server
      * \param serverAddress Address of the NEST server
      * \param data Arguments for GetKernelStatus
      * \return Response from GetKernelStatus as string
      */
-    std::string nestGetKernelStatus(const std::string & serverAddress, const std::string & data)
+    std::string nestGetKernelStatus(RestClientConnection & connection, const std::string & serverAddress, const std::string & data)
     {
-        return nestGenericCall(serverAddress + "/api/GetKernelStatus", "application/json", data);
+        return nestGenericCall(connection, serverAddress + "/api/GetKernelStatus", "application/json", data);
     }
 
     /*!
      * \brief Sends exec request to NEST server
      *
+     * \param connection Connection to the NEST server
      * \param serverAddress Address of the NEST server
      * \param data Python code to be executed by the server
      */
-    std::string nestExec(const std::string & serverAddress, const std::string & data)
+    std::string nestExec(RestClientConnection & connection, const std::string & serverAddress, const std::string & data)
     {
-        return nestGenericCall(serverAddress + "/exec", "application/json", data);
+        return nestGenericCall(connection, serverAddress + "/exec", "application/json", data);
     }
 }
 
@@ -342,7 +350,7 @@ void NestEngineServerNRPClient::initialize()
         std::string response;
         try
         {
-            response = nestExec(this->serverAddress(), nlohmann::json({{"source", initCode}, {"return", {"populations", "connections"}}}).dump());
+            response = nestExec(this->_connection, this->serverAddress(), nlohmann::json({{"source", initCode}, {"return", {"populations", "connections"}}}).dump());
         }
         catch(NRPException &e)
         {
@@ -393,7 +401,7 @@ void NestEngineServerNRPClient::initialize()
 
     // Get simulation resolution and cache it
 
-    this->_simulationResolution = std::stof(nestGetKernelStatus(this->serverAddress(), "[\"resolution\"]"));
+    this->_simulationResolution = std::stof(nestGetKernelStatus(this->_connection, this->serverAddress(), "[\"resolution\"]"));
 
     NRPLogger::debug("NestEngineServerNRPClient::initialize(...) completed with no errors.");
 }
@@ -402,7 +410,7 @@ void NestEngineServerNRPClient::reset(){
 
     try
     {
-        nestResetKernel(this->serverAddress());
+        nestResetKernel(this->_connection, this->serverAddress());
     }
     catch (std::exception &e)
     {
@@ -463,14 +471,14 @@ datapacks_vector_t NestEngineServerNRPClient::getDataPacksFromEngine(const datap
             try {
                 if (this->_populations.count(datapackName) > 0) {
                     // it's a population use GetStatus
-                    response = nestGetStatus(this->serverAddress(), getDataPackIdList(datapackName));
+                    response = nestGetStatus(this->_connection, this->serverAddress(), getDataPackIdList(datapackName));
 
                 } else if (this->_getConnectionsPopulationToArgs.count(datapackName) > 0) {
                         // it's a connection use GetConnection
                         // fetch the parameters, i.e. "source" and "target" population IDs
                         auto getConnectionArgs = this->_getConnectionsPopulationToArgs.at(datapackName);
 
-                        response = nestGetConnections(this->serverAddress(),
+                        response = nestGetConnections(this->_connection, this->serverAddress(),
                                                       getDataPackIdList(getConnectionArgs.first),
                                                       getDataPackIdList(getConnectionArgs.second));
                 } else {
@@ -508,7 +516,7 @@ void NestEngineServerNRPClient::sendDataPacksToEngine(const datapacks_set_t &dat
             try
             {
                 // SetStatus(args, kwargs)
-                nestSetStatus(this->serverAddress(), getDataPackIdList(datapackName), kwargsStr);
+                nestSetStatus(this->_connection, this->serverAddress(), getDataPackIdList(datapackName), kwargsStr);
             }
             catch(std::exception& e)
             {
@@ -523,9 +531,9 @@ SimulationTime NestEngineServerNRPClient::runLoopStepCallback(SimulationTime tim
     // According to the NEST API documentation, Run accepts time to simulate in milliseconds and floating-point format
     const double runTimeMsRounded = getRoundedRunTimeMs(timeStep, this->_simulationResolution);
 
-    nestSimulate(this->serverAddress(), runTimeMsRounded);
+    nestSimulate(this->_connection, this->serverAddress(), runTimeMsRounded);
 
-    return toSimulationTime<float, std::milli>(std::stof(nestGetKernelStatus(this->serverAddress(), "[\"biological_time\"]")));
+    return toSimulationTime<float, std::milli>(std::stof(nestGetKernelStatus(this->_connection, this->serverAddress(), "[\"biological_time\"]")));
 }
 
 std::string NestEngineServerNRPClient::serverAddress() const
@@ -25,6 +25,7 @@
 #include "nrp_nest_server_engine/config/nest_server_config.h"
 #include "nrp_general_library/engine_interfaces/engine_client_interface.h"
 #include "nrp_general_library/plugin_system/plugin.h"
+#include "nrp_general_library/utils/restclient_setup.h"
 
 #include <future>
 #include <string>
@@ -94,6 +95,11 @@ class NestEngineServerNRPClient
          */
         std::string _serverAddress;
 
+        /*!
+         * \brief Connection to the NEST server, kept open between requests
+         */
+        RestClientConnection _connection;
+
         /*!
          * \brief Contains connections returned by server after loading the brain file as
          * a JSON dictionary with the following format:
@@ -0,0 +1,64 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#ifndef ARENA_DATAPACK_CONTROLLER_H
+#define ARENA_DATAPACK_CONTROLLER_H
+
+#include "google/protobuf/arena.h"
+#include "google/protobuf/message.h"
+
+#include "nrp_general_library/engine_interfaces/datapack_controller.h"
+
+using ProtoDataPackController = DataPackController<google::protobuf::Message>;
+
+/*!
+ * \brief DataPack controller which allocates the messages returned by getDataPackInformation() in a protobuf arena
+ *
+ * The arena is owned by the EngineProtoWrapper in which the controller is registered. Each controller gets its own
+ * arena, which is reset every time the controller's datapack is requested from the engine. Messages created with
+ * createMessage() must therefore be returned by getDataPackInformation() and not kept by the controller. If the
+ * controller isn't registered in a wrapper, messages are allocated in the heap and owned by the caller.
+ */
+class ArenaDataPackController : public ProtoDataPackController
+{
+    public:
+
+        /*!
+         * \brief Sets the arena in which messages are allocated
+         */
+        void setArena(google::protobuf::Arena * arena)
+        { this->_arena = arena; }
+
+    protected:
+
+        /*!
+         * \brief Creates a protobuf message in the arena
+         */
+        template<class MSG_TYPE>
+        MSG_TYPE * createMessage()
+        { return google::protobuf::Arena::CreateMessage<MSG_TYPE>(this->_arena); }
+
+    private:
+
+        google::protobuf::Arena * _arena = nullptr;
+};
+
+#endif // ARENA_DATAPACK_CONTROLLER_H
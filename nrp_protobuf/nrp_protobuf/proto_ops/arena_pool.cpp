@@ -0,0 +1,97 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_protobuf/proto_ops/arena_pool.h"
+
+#include <algorithm>
+
+namespace
+{
+    /*!
+     * \brief Protobuf arena together with its initial memory block
+     */
+    struct ArenaBlock
+    {
+        explicit ArenaBlock(size_t size)
+            : initialBlock(new char[size]),
+              arena(options(initialBlock.get(), size))
+        {}
+
+        static google::protobuf::ArenaOptions options(char * block, size_t size)
+        {
+            google::protobuf::ArenaOptions arenaOptions;
+            arenaOptions.initial_block = block;
+            arenaOptions.initial_block_size = size;
+
+            return arenaOptions;
+        }
+
+        std::unique_ptr<char[]> initialBlock;
+        google::protobuf::Arena arena;
+    };
+}
+
+ArenaPool::ArenaPool(size_t initialBlockSize, size_t maxArenas)
+    : _initialBlockSize(initialBlockSize),
+      _maxArenas(std::max<size_t>(maxArenas, 1))
+{}
+
+std::shared_ptr<google::protobuf::Arena> ArenaPool::acquire()
+{
+    for(auto & arena : this->_arenas)
+    {
+        // Only referenced by the pool, none of its messages is alive
+        if(arena.use_count() == 1)
+        {
+            const size_t spaceAllocated = arena->SpaceAllocated();
+
+            if(spaceAllocated <= this->_initialBlockSize)
+            {
+                arena->Reset();
+                return arena;
+            }
+
+            // The arena needed more memory than its initial block. Replace it with a bigger one
+            this->_initialBlockSize = spaceAllocated;
+            arena = createArena(this->_initialBlockSize);
+
+            return arena;
+        }
+
+        this->_initialBlockSize = std::max<size_t>(this->_initialBlockSize, arena->SpaceAllocated());
+    }
+
+    if(this->_arenas.size() >= this->_maxArenas)
+        this->_arenas.erase(this->_arenas.begin());
+
+    this->_arenas.push_back(createArena(this->_initialBlockSize));
+
+    return this->_arenas.back();
+}
+
+std::shared_ptr<google::protobuf::Arena> ArenaPool::createArena(size_t initialBlockSize)
+{
+    auto block = std::make_shared<ArenaBlock>(initialBlockSize);
+    return std::shared_ptr<google::protobuf::Arena>(block, &block->arena);
+}
+
+// EOF
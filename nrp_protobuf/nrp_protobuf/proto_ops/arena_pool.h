@@ -0,0 +1,99 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+#ifndef ARENA_POOL_H
+#define ARENA_POOL_H
+
+#include <memory>
+#include <vector>
+
+#include "google/protobuf/arena.h"
+
+/*!
+ * \brief Pool of protobuf arenas used to allocate the messages received from an engine in each simulation step
+ *
+ * Arenas are handed out as shared pointers. A message allocated in an arena can be wrapped in a shared pointer
+ * aliasing the arena's one, so that the arena stays alive as long as any of its messages is in use.
+ *
+ * acquire() returns an arena which is not in use anymore, after resetting it. Arenas keep their initial memory block
+ * across resets, and its size grows up to the memory used in the previous step. Once the pool has settled, allocating
+ * the messages of a step requires no calls to the system allocator.
+ *
+ * The datapacks of a step are usually referenced until the next step replaces them in the datapack pool, so the pool
+ * keeps a few arenas alive. If all of them are still in use, e.g. because datapacks are stored in the simulation
+ * trajectory, a new arena is created. The oldest arena in the pool is then released, it will be destroyed along with
+ * its last message.
+ */
+class ArenaPool
+{
+    public:
+
+        /*!
+         * \brief Constructor
+         *
+         * \param initialBlockSize Minimum size of the initial memory block of the arenas
+         * \param maxArenas Maximum number of arenas kept in the pool
+         */
+        explicit ArenaPool(size_t initialBlockSize = 64*1024, size_t maxArenas = 4);
+
+        ArenaPool(const ArenaPool &) = delete;
+        ArenaPool &operator=(const ArenaPool &) = delete;
+
+        /*!
+         * \brief Returns an arena with no allocated messages
+         */
+        std::shared_ptr<google::protobuf::Arena> acquire();
+
+        /*!
+         * \brief Number of arenas currently in the pool
+         */
+        size_t size() const
+        { return this->_arenas.size(); }
+
+        /*!
+         * \brief Creates an arena with an initial memory block of the given size
+         *
+         * The initial block is kept when the arena is reset, and released along with the arena
+         */
+        static std::shared_ptr<google::protobuf::Arena> createArena(size_t initialBlockSize);
+
+    private:
+
+        /*!
+         * \brief Arenas in the pool, ordered by creation time
+         */
+        std::vector<std::shared_ptr<google::protobuf::Arena>> _arenas;
+
+        /*!
+         * \brief Size of the initial memory block of new arenas
+         */
+        size_t _initialBlockSize;
+
+        /*!
+         * \brief Maximum number of arenas in the pool
+         */
+        size_t _maxArenas;
+};
+
+#endif // ARENA_POOL_H
+
+// EOF
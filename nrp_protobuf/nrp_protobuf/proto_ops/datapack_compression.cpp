@@ -0,0 +1,151 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_protobuf/proto_ops/datapack_compression.h"
+
+#include "nrp_general_library/utils/nrp_exceptions.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+namespace
+{
+    // Fastest zstd level. Datapacks are compressed once per step, on the critical path of the simulation loop
+    constexpr int ZSTD_LEVEL = 1;
+
+    bool compress(EngineGrpc::CompressionCodec codec, const std::string &src, std::string *dst)
+    {
+        switch(codec)
+        {
+            case EngineGrpc::COMPRESSION_LZ4:
+            {
+                if(src.size() > LZ4_MAX_INPUT_SIZE)
+                    return false;
+
+                dst->resize(LZ4_compressBound(static_cast<int>(src.size())));
+                const int size = LZ4_compress_default(src.data(), dst->data(), static_cast<int>(src.size()),
+                                                      static_cast<int>(dst->size()));
+                if(size <= 0)
+                    return false;
+
+                dst->resize(size);
+                return true;
+            }
+            case EngineGrpc::COMPRESSION_ZSTD:
+            {
+                dst->resize(ZSTD_compressBound(src.size()));
+                const size_t size = ZSTD_compress(dst->data(), dst->size(), src.data(), src.size(), ZSTD_LEVEL);
+                if(ZSTD_isError(size))
+                    return false;
+
+                dst->resize(size);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    bool decompress(EngineGrpc::CompressionCodec codec, const std::string &src, size_t size, std::string *dst)
+    {
+        dst->resize(size);
+
+        switch(codec)
+        {
+            case EngineGrpc::COMPRESSION_LZ4:
+                return size <= LZ4_MAX_INPUT_SIZE &&
+                       LZ4_decompress_safe(src.data(), dst->data(), static_cast<int>(src.size()), static_cast<int>(size)) ==
+                       static_cast<int>(size);
+            case EngineGrpc::COMPRESSION_ZSTD:
+                return ZSTD_decompress(dst->data(), size, src.data(), src.size()) == size;
+            default:
+                return false;
+        }
+    }
+}
+
+EngineGrpc::CompressionCodec protobuf_ops::compressionCodecFromName(const std::string &name)
+{
+    if(name == "none")
+        return EngineGrpc::COMPRESSION_NONE;
+    else if(name == "lz4")
+        return EngineGrpc::COMPRESSION_LZ4;
+    else if(name == "zstd")
+        return EngineGrpc::COMPRESSION_ZSTD;
+
+    throw NRPException::logCreate("Unknown datapack compression codec \"" + name + "\"");
+}
+
+std::string protobuf_ops::compressionCodecName(EngineGrpc::CompressionCodec codec)
+{
+    switch(codec)
+    {
+        case EngineGrpc::COMPRESSION_LZ4:
+            return "lz4";
+        case EngineGrpc::COMPRESSION_ZSTD:
+            return "zstd";
+        default:
+            return "none";
+    }
+}
+
+bool protobuf_ops::compressDataPackMessage(EngineGrpc::DataPackMessage *dpMsg, EngineGrpc::CompressionCodec codec,
+                                           size_t minCompressedSize)
+{
+    if(codec == EngineGrpc::COMPRESSION_NONE || !dpMsg->has_data() || dpMsg->data().value().size() < minCompressedSize)
+        return false;
+
+    EngineGrpc::CompressedData compressed;
+    if(!compress(codec, dpMsg->data().value(), compressed.mutable_data()) ||
+       compressed.data().size() >= dpMsg->data().value().size())
+        return false;
+
+    compressed.set_codec(codec);
+    compressed.set_typeurl(dpMsg->data().type_url());
+    compressed.set_uncompressedsize(dpMsg->data().value().size());
+
+    dpMsg->mutable_data()->PackFrom(compressed);
+    return true;
+}
+
+bool protobuf_ops::decompressDataPackMessage(const EngineGrpc::DataPackMessage &from, EngineGrpc::DataPackMessage *to)
+{
+    if(!from.has_data() || !from.data().Is<EngineGrpc::CompressedData>())
+        return false;
+
+    EngineGrpc::CompressedData compressed;
+    if(!from.data().UnpackTo(&compressed))
+        throw NRPException::logCreate("Failed to unpack compressed data of datapack \"" +
+                                      from.datapackid().datapackname() + "\"");
+
+    to->mutable_datapackid()->CopyFrom(from.datapackid());
+
+    auto * data = to->mutable_data();
+    data->set_type_url(compressed.typeurl());
+    if(!decompress(compressed.codec(), compressed.data(), compressed.uncompressedsize(), data->mutable_value()))
+        throw NRPException::logCreate("Failed to decompress " + compressionCodecName(compressed.codec()) +
+                                      " data of datapack \"" + from.datapackid().datapackname() + "\"");
+
+    return true;
+}
+
+// EOF
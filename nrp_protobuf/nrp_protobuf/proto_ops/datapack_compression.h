@@ -0,0 +1,79 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+
+#ifndef DATAPACK_COMPRESSION_H
+#define DATAPACK_COMPRESSION_H
+
+#include <string>
+
+#include "nrp_protobuf/engine_grpc.pb.h"
+#include "nrp_protobuf/engine_grpc_compression.pb.h"
+
+namespace protobuf_ops {
+
+    /*!
+     * \brief Default minimum size of the datapack data compressed by compressDataPackMessage
+     */
+    constexpr size_t DEFAULT_MIN_COMPRESSED_SIZE = 16384;
+
+    /*!
+     * \brief Returns the compression codec with the given name, "none", "lz4" or "zstd". Throws if the name is unknown
+     */
+    EngineGrpc::CompressionCodec compressionCodecFromName(const std::string &name);
+
+    /*!
+     * \brief Returns the name of a compression codec, as accepted by compressionCodecFromName
+     */
+    std::string compressionCodecName(EngineGrpc::CompressionCodec codec);
+
+    /*!
+     * \brief Compresses the data of a datapack message
+     *
+     * The data is replaced by a CompressedData message if its serialized size is at least 'minCompressedSize' and the
+     * codec makes it smaller. Otherwise the message is left unchanged
+     *
+     * \param[in,out] dpMsg Datapack message to be sent
+     * \param[in] codec Compression codec
+     * \param[in] minCompressedSize Minimum size of the compressed data
+     *
+     * \return True if the data was compressed
+     */
+    bool compressDataPackMessage(EngineGrpc::DataPackMessage *dpMsg, EngineGrpc::CompressionCodec codec,
+                                 size_t minCompressedSize = DEFAULT_MIN_COMPRESSED_SIZE);
+
+    /*!
+     * \brief Decompresses the data of a datapack message compressed with compressDataPackMessage
+     *
+     * Throws if the data can't be decompressed
+     *
+     * \param[in] from Received datapack message
+     * \param[out] to Datapack message with the decompressed data. Only set if 'from' is compressed
+     *
+     * \return False if the data of 'from' isn't compressed
+     */
+    bool decompressDataPackMessage(const EngineGrpc::DataPackMessage &from, EngineGrpc::DataPackMessage *to);
+}
+
+#endif // DATAPACK_COMPRESSION_H
+
+// EOF
@@ -23,10 +23,15 @@
 #define PROTO_OPS_H
 
 #include <dlfcn.h>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+#include "google/protobuf/arena.h"
 #include "google/protobuf/message.h"
 
 #include "nrp_protobuf/engine_grpc.pb.h"
 #include "nrp_protobuf/nrp_server.pb.h"
+#include "nrp_protobuf/proto_ops/segmented_message.h"
 #include "nrp_general_library/datapack_interface/datapack.h"
 #include "nrp_general_library/utils/nrp_exceptions.h"
 
@@ -36,172 +41,147 @@ namespace gpb = google::protobuf;
 namespace protobuf_ops {
 
     /*!
-     * @brief Attempts to unpack an Any protobuf msg to any of the template parameter classes
-     *
-     * @tparam MSG_TYPE template param containing the list of protobuf types that will be check in the conversion
-     * @tparam REMAINING_MSG_TYPES
-     * @param from Any protobuf msg
-     * @return protobuf msg unpacked from 'from'
+     * @brief Returns the full name of the protobuf message type contained in an Any protobuf msg
      */
-    template<class MSG_TYPE, class ...REMAINING_MSG_TYPES>
-    std::unique_ptr<gpb::Message> unpackProtoAnySubset(const gpb::Any & from)
+    inline std::string_view anyTypeName(const gpb::Any & from)
     {
-        // If data is of MSG_TYPE type, unpack
-        if(from.Is<MSG_TYPE>())
-        {
-            MSG_TYPE * dataPack = new MSG_TYPE();
-            from.UnpackTo(dataPack);
-            return std::unique_ptr<gpb::Message>(dataPack);
-        }
+        const std::string_view typeUrl = from.type_url();
+        const auto pos = typeUrl.rfind('/');
 
-        // Try with the remaining types or throw
-        if constexpr (sizeof...(REMAINING_MSG_TYPES) > 0)
-            return unpackProtoAnySubset<REMAINING_MSG_TYPES...>(from);
-        else
-            return std::unique_ptr<gpb::Message>();
+        return pos == std::string_view::npos ? typeUrl : typeUrl.substr(pos + 1);
     }
 
     /*!
-     * @brief Set a protobuf datapack msg data field from a protobuf message
+     * @brief Conversion operations between protobuf messages of type MSG_TYPE and datapacks
      *
-     * @tparam MSG_TYPE template param containing the list of protobuf types that will be check in the conversion
-     * @tparam REMAINING_MSG_TYPES
-     * @param from Protobuf message
-     * @param to Protobuf datapack message which data will be set
+     * The operations assume that the type of their input has already been checked, see NRPProtobufOps
+     *
+     * @tparam MSG_TYPE protobuf message type
      */
-    template<class MSG_TYPE, class ...REMAINING_MSG_TYPES>
-    void setDataPackMessageDataSubset(const gpb::Message & from, EngineGrpc::DataPackMessage * to)
+    template<class MSG_TYPE>
+    struct MessageTypeOps
     {
-        // TODO datapackname and enginename are set outside of this function, should we do it here?
-        //  To be considered as part of https://hbpneurorobotics.atlassian.net/browse/NRRPLT-8340
-        // Try to cast 'from' to MSG_TYPE
-        try
+        /*!
+         * @brief Unpacks an Any protobuf msg containing a MSG_TYPE message
+         */
+        static std::unique_ptr<gpb::Message> unpackProtoAny(const gpb::Any & from)
         {
-            const auto& message = dynamic_cast<const MSG_TYPE &>(from);
-            to->mutable_data()->PackFrom(message);
-            return;
+            auto message = std::make_unique<MSG_TYPE>();
+            from.UnpackTo(message.get());
+            return message;
         }
-        catch(const std::bad_cast& e)
+
+        /*!
+         * @brief Sets a protobuf datapack msg data field from a MSG_TYPE message
+         */
+        static void setDataPackMessageData(const gpb::Message & from, EngineGrpc::DataPackMessage * to)
         {
-            // Do not process the exception.
-            // Bad casts aren't 'bad' in this case, they simply mean that
-            // we haven't found the right message type yet.
+            // TODO datapackname and enginename are set outside of this function, should we do it here?
+            //  To be considered as part of https://hbpneurorobotics.atlassian.net/browse/NRRPLT-8340
+            to->mutable_data()->PackFrom(static_cast<const MSG_TYPE &>(from));
         }
 
-        // Try with the remaining types or throw
-        if constexpr (sizeof...(REMAINING_MSG_TYPES) > 0)
-            return setDataPackMessageDataSubset<REMAINING_MSG_TYPES...>(from, to);
-        else
+        /*!
+         * @brief Creates a datapack from a datapack protobuf msg containing a MSG_TYPE message
+         *
+         * If 'arena' is not null, the data is allocated in it and the datapack shares the arena ownership
+         */
+        static DataPackInterfaceConstSharedPtr getDataPackInterfaceFromMessage(const std::string &engineName, const EngineGrpc::DataPackMessage & from,
+                                                                               const std::shared_ptr<gpb::Arena> & arena)
         {
-            const auto errorMessage = "Unable to pack data into DataPack '" +
-                                      to->datapackid().datapackname() +
-                                      "' in engine '" +
-                                      to->datapackid().enginename() + "'";
-
-            throw NRPException(errorMessage);
-        }
-    }
+            if(!arena)
+            {
+                MSG_TYPE * data = new MSG_TYPE();
+                from.data().UnpackTo(data);
 
+                return DataPackInterfaceConstSharedPtr(new DataPack<MSG_TYPE>(from.datapackid().datapackname(), engineName, data));
+            }
 
-    /*!
-     * @brief Finds the type of protobuf msg contained in 'from' data field and creates a datapack from it
-     *
-     * @tparam MSG_TYPE template param containing the list of protobuf types that will be check in the conversion
-     * @tparam REMAINING_MSG_TYPES
-     * @param engineName owner of 'from'
-     * @param from datapack protobuf msg
-     * @return the instantiated datapack
-     */
-    template<class MSG_TYPE, class ...REMAINING_MSG_TYPES>
-    // TODO: use engine name from 'from' after https://hbpneurorobotics.atlassian.net/browse/NRRPLT-8340 is resolved
-    DataPackInterfaceConstSharedPtr getDataPackInterfaceFromMessageSubset(const std::string &engineName, const EngineGrpc::DataPackMessage & from)
-    {
-        const auto & dataPackId = from.datapackid();
-
-        if(!from.has_data())
-            return DataPackInterfaceConstSharedPtr(new DataPackInterface(dataPackId.datapackname(),
-                                                                         engineName, dataPackId.datapacktype()));
-        else if(from.data().Is<MSG_TYPE>())
-        {
-            MSG_TYPE * data = new MSG_TYPE();
+            MSG_TYPE * data = gpb::Arena::CreateMessage<MSG_TYPE>(arena.get());
             from.data().UnpackTo(data);
 
-            return DataPackInterfaceConstSharedPtr(
-                    new DataPack<MSG_TYPE>(dataPackId.datapackname(), engineName, data));
+            return DataPackInterfaceConstSharedPtr(new DataPack<MSG_TYPE>(from.datapackid().datapackname(), engineName,
+                                                                          std::shared_ptr<MSG_TYPE>(arena, data)));
         }
 
-        if constexpr (sizeof...(REMAINING_MSG_TYPES) > 0)
-            return getDataPackInterfaceFromMessageSubset<REMAINING_MSG_TYPES...>(engineName, from);
-        else
-            return nullptr;
-    }
+        /*!
+         * @brief Creates a datapack from a segmented datapack msg containing a MSG_TYPE message
+         *
+         * The segments of 'from' are moved into the datapack data. If 'arena' is not null, the data is allocated in it
+         *
+         * @return nullptr if the message couldn't be parsed
+         */
+        static DataPackInterfaceConstSharedPtr getDataPackInterfaceFromSegmentedMessage(const std::string &engineName, EngineGrpc::SegmentedDataPackMessage & from,
+                                                                                        const std::shared_ptr<gpb::Arena> & arena)
+        {
+            std::shared_ptr<MSG_TYPE> data = arena ?
+                    std::shared_ptr<MSG_TYPE>(arena, gpb::Arena::CreateMessage<MSG_TYPE>(arena.get())) :
+                    std::make_shared<MSG_TYPE>();
 
+            if(!moveFromSegmentedMessage(from, data.get()))
+                return nullptr;
 
-    /*!
-     * @brief Sets the data field of a datapack protobuf message from a datapack interface
-     *
-     * @tparam MSG_TYPE template param containing the list of protobuf types that will be check in the conversion
-     * @tparam REMAINING_MSG_TYPES
-     * @param from input datapack containing data
-     * @param to protobuf msg pointer which data field will be set to 'from'
-     */
-    template<class MSG_TYPE, class ...REMAINING_MSG_TYPES>
-    void setDataPackMessageFromInterfaceSubset(const DataPackInterface & from, EngineGrpc::DataPackMessage * to)
-    {
-        // Try to cast 'from' to DataPack<MSG_TYPE>
-        try
+            return DataPackInterfaceConstSharedPtr(new DataPack<MSG_TYPE>(from.datapackid().datapackname(), engineName, std::move(data)));
+        }
+
+        /*!
+         * @brief Sets a datapack protobuf msg from a DataPack<MSG_TYPE>
+         *
+         * @return false if 'from' isn't a DataPack<MSG_TYPE>, e.g. an empty DataPackInterface with the same type
+         */
+        static bool setDataPackMessageFromInterface(const DataPackInterface & from, EngineGrpc::DataPackMessage * to)
         {
-            const auto& message = dynamic_cast<const DataPack<MSG_TYPE> &>(from);
-            to->mutable_datapackid()->set_datapackname(message.name());
-            to->mutable_datapackid()->set_datapacktype(message.type());
-            to->mutable_datapackid()->set_enginename(message.engineName());
-            to->mutable_data()->PackFrom(message.getData());
+            const auto * dataPack = dynamic_cast<const DataPack<MSG_TYPE> *>(&from);
+            if(dataPack == nullptr)
+                return false;
+
+            to->mutable_datapackid()->set_datapackname(dataPack->name());
+            to->mutable_datapackid()->set_datapacktype(dataPack->type());
+            to->mutable_datapackid()->set_enginename(dataPack->engineName());
+            to->mutable_data()->PackFrom(dataPack->getData());
 
-            return;
+            return true;
         }
-        catch(const std::bad_cast& e)
+
+        /*!
+         * @brief Sets the data field of a trajectory protobuf msg from a DataPack<MSG_TYPE>
+         *
+         * @return false if 'from' isn't a DataPack<MSG_TYPE>
+         */
+        static bool setTrajectoryMessageFromInterface(const DataPackInterface & from, NrpCore::TrajectoryMessage * to)
         {
-            // Do not process the exception.
-            // Bad casts aren't 'bad' in this case, they simply mean that
-            // we haven't found the right message type yet.
-        }
+            const auto * dataPack = dynamic_cast<const DataPack<MSG_TYPE> *>(&from);
+            if(dataPack == nullptr)
+                return false;
 
-        // Try with the remaining types or throw
-        if constexpr (sizeof...(REMAINING_MSG_TYPES) > 0)
-            return setDataPackMessageFromInterfaceSubset<REMAINING_MSG_TYPES...>(from, to);
-        else
-            throw NRPException("Failed to set DataPackMessage from DataPackInterface with name \"" + from.name() + "\"");
-    }
+            to->mutable_data()->PackFrom(dataPack->getData());
 
+            return true;
+        }
+    };
 
     /*!
-     * @brief Sets the data field of a datapack protobuf message from a datapack interface
-     *
-     * @tparam MSG_TYPE template param containing the list of protobuf types that will be check in the conversion
-     * @tparam REMAINING_MSG_TYPES
-     * @param from input datapack containing data
-     * @param to protobuf msg pointer which data field will be set to 'from'
+     * @brief Table of conversion operations of a protobuf message type
      */
-    template<class MSG_TYPE, class ...REMAINING_MSG_TYPES>
-    void setTrajectoryMessageFromInterfaceSubset(const DataPackInterface & from, NrpCore::TrajectoryMessage * to)
+    struct MessageTypeOpsEntry
     {
-        try
-        {
-            const auto& message = dynamic_cast<const DataPack<MSG_TYPE> &>(from);
-            to->mutable_data()->PackFrom(message.getData());
-            return;
-        }
-        catch(const std::bad_cast& e)
-        {
-            // Do not process the exception.
-            // Bad casts aren't 'bad' in this case, they simply mean that
-            // we haven't found the right message type yet.
-        }
+        std::unique_ptr<gpb::Message> (*unpackProtoAny)(const gpb::Any &);
+        void (*setDataPackMessageData)(const gpb::Message &, EngineGrpc::DataPackMessage *);
+        DataPackInterfaceConstSharedPtr (*getDataPackInterfaceFromMessage)(const std::string &, const EngineGrpc::DataPackMessage &, const std::shared_ptr<gpb::Arena> &);
+        DataPackInterfaceConstSharedPtr (*getDataPackInterfaceFromSegmentedMessage)(const std::string &, EngineGrpc::SegmentedDataPackMessage &, const std::shared_ptr<gpb::Arena> &);
+        bool (*setDataPackMessageFromInterface)(const DataPackInterface &, EngineGrpc::DataPackMessage *);
+        bool (*setTrajectoryMessageFromInterface)(const DataPackInterface &, NrpCore::TrajectoryMessage *);
+    };
 
-        if constexpr (sizeof...(REMAINING_MSG_TYPES) > 0)
-            return setTrajectoryMessageFromInterfaceSubset<REMAINING_MSG_TYPES...>(from, to);
-        else
-            throw NRPException::logCreate("DataPack \"" + from.name() + "\" is not supported by engine '" + from.engineName() + "'");
+    template<class MSG_TYPE>
+    constexpr MessageTypeOpsEntry messageTypeOpsEntry()
+    {
+        return { &MessageTypeOps<MSG_TYPE>::unpackProtoAny,
+                 &MessageTypeOps<MSG_TYPE>::setDataPackMessageData,
+                 &MessageTypeOps<MSG_TYPE>::getDataPackInterfaceFromMessage,
+                 &MessageTypeOps<MSG_TYPE>::getDataPackInterfaceFromSegmentedMessage,
+                 &MessageTypeOps<MSG_TYPE>::setDataPackMessageFromInterface,
+                 &MessageTypeOps<MSG_TYPE>::setTrajectoryMessageFromInterface };
     }
 
 
@@ -209,6 +189,8 @@ namespace protobuf_ops {
     class NRPProtobufOpsIface {
     public:
 
+        virtual ~NRPProtobufOpsIface() = default;
+
         virtual std::unique_ptr<gpb::Message> unpackProtoAny(const gpb::Any &from) = 0;
 
         virtual void setDataPackMessageData(const gpb::Message &from, EngineGrpc::DataPackMessage *to) = 0;
@@ -216,33 +198,159 @@ namespace protobuf_ops {
         virtual DataPackInterfaceConstSharedPtr
         getDataPackInterfaceFromMessage(const std::string &engineName, const EngineGrpc::DataPackMessage &from) = 0;
 
+        /*!
+         * @brief Same as getDataPackInterfaceFromMessage, but the datapack data is allocated in 'arena'
+         *
+         * The returned datapack shares the ownership of the arena, which stays alive as long as the datapack does
+         */
+        virtual DataPackInterfaceConstSharedPtr
+        getDataPackInterfaceFromMessage(const std::string &engineName, const EngineGrpc::DataPackMessage &from,
+                                        const std::shared_ptr<gpb::Arena> &arena) = 0;
+
+        /*!
+         * @brief Creates a datapack from a segmented datapack msg. Its segments are moved into the datapack data
+         *
+         * @return nullptr if the data type of 'from' isn't supported
+         */
+        virtual DataPackInterfaceConstSharedPtr
+        getDataPackInterfaceFromSegmentedMessage(const std::string &engineName, EngineGrpc::SegmentedDataPackMessage &from,
+                                                 const std::shared_ptr<gpb::Arena> &arena) = 0;
+
         virtual void
         setDataPackMessageFromInterface(const DataPackInterface &from, EngineGrpc::DataPackMessage *to) = 0;
 
         virtual void setTrajectoryMessageFromInterface(const DataPackInterface & from, NrpCore::TrajectoryMessage * to) = 0;
+
+        /*!
+         * @brief Same as setDataPackMessageData, but returns false instead of throwing if the message type isn't supported
+         */
+        virtual bool trySetDataPackMessageData(const gpb::Message &from, EngineGrpc::DataPackMessage *to) = 0;
+
+        /*!
+         * @brief Same as setDataPackMessageFromInterface, but returns false instead of throwing if the datapack type isn't supported
+         */
+        virtual bool trySetDataPackMessageFromInterface(const DataPackInterface &from, EngineGrpc::DataPackMessage *to) = 0;
+
+        /*!
+         * @brief Same as setTrajectoryMessageFromInterface, but returns false instead of throwing if the datapack type isn't supported
+         */
+        virtual bool trySetTrajectoryMessageFromInterface(const DataPackInterface & from, NrpCore::TrajectoryMessage * to) = 0;
     };
 
-    // Template class implementing NRPProtobufOpsIface
+    /*!
+     * @brief Template class implementing NRPProtobufOpsIface
+     *
+     * The operations of each message type are stored in hash maps built when the object is created, ie. when the
+     * plugin is loaded. They are looked up by:
+     * - the dynamic type of protobuf messages (std::type_index)
+     * - the type of datapacks, which is the implementation-defined name of the message type (DataPack::getType())
+     * - the full name of the message type contained in Any protobuf msgs
+     *
+     * @tparam MSG_TYPES list of protobuf types supported by the plugin
+     */
     template<class ...MSG_TYPES>
     class NRPProtobufOps : public NRPProtobufOpsIface {
     public:
 
+        NRPProtobufOps()
+        {
+            (this->registerMessageType<MSG_TYPES>(), ...);
+        }
+
         std::unique_ptr<gpb::Message> unpackProtoAny(const gpb::Any& from) override
-        { return unpackProtoAnySubset<MSG_TYPES...>(from); }
+        {
+            const auto * ops = this->findByFullName(anyTypeName(from));
+            return ops ? ops->unpackProtoAny(from) : std::unique_ptr<gpb::Message>();
+        }
 
         void setDataPackMessageData(const gpb::Message &from, EngineGrpc::DataPackMessage *to) override
-        { setDataPackMessageDataSubset<MSG_TYPES...>(from, to); }
+        {
+            if(!this->trySetDataPackMessageData(from, to))
+                throw NRPException("Unable to pack data into DataPack '" + to->datapackid().datapackname() +
+                                   "' in engine '" + to->datapackid().enginename() + "'");
+        }
 
         DataPackInterfaceConstSharedPtr getDataPackInterfaceFromMessage(const std::string &engineName, const EngineGrpc::DataPackMessage &from) override
-        { return getDataPackInterfaceFromMessageSubset<MSG_TYPES...>(engineName, from); }
+        { return this->getDataPackInterfaceFromMessage(engineName, from, nullptr); }
+
+        DataPackInterfaceConstSharedPtr getDataPackInterfaceFromMessage(const std::string &engineName, const EngineGrpc::DataPackMessage &from,
+                                                                        const std::shared_ptr<gpb::Arena> &arena) override
+        {
+            // TODO: use engine name from 'from' after https://hbpneurorobotics.atlassian.net/browse/NRRPLT-8340 is resolved
+            if(!from.has_data())
+                return DataPackInterfaceConstSharedPtr(new DataPackInterface(from.datapackid().datapackname(),
+                                                                             engineName, from.datapackid().datapacktype()));
+
+            const auto * ops = this->findByFullName(anyTypeName(from.data()));
+            return ops ? ops->getDataPackInterfaceFromMessage(engineName, from, arena) : nullptr;
+        }
+
+        DataPackInterfaceConstSharedPtr getDataPackInterfaceFromSegmentedMessage(const std::string &engineName, EngineGrpc::SegmentedDataPackMessage &from,
+                                                                                 const std::shared_ptr<gpb::Arena> &arena) override
+        {
+            if(from.datatype().empty())
+                return DataPackInterfaceConstSharedPtr(new DataPackInterface(from.datapackid().datapackname(),
+                                                                             engineName, from.datapackid().datapacktype()));
+
+            const auto * ops = this->findByFullName(from.datatype());
+            return ops ? ops->getDataPackInterfaceFromSegmentedMessage(engineName, from, arena) : nullptr;
+        }
 
         void setDataPackMessageFromInterface(const DataPackInterface & from, EngineGrpc::DataPackMessage * to) override
-        { setDataPackMessageFromInterfaceSubset<MSG_TYPES...>(from, to); }
+        {
+            if(!this->trySetDataPackMessageFromInterface(from, to))
+                throw NRPException("Failed to set DataPackMessage from DataPackInterface with name \"" + from.name() + "\"");
+        }
 
         void setTrajectoryMessageFromInterface(const DataPackInterface & from, NrpCore::TrajectoryMessage * to) override
         {
-            setTrajectoryMessageFromInterfaceSubset<MSG_TYPES...>(from, to);
+            if(!this->trySetTrajectoryMessageFromInterface(from, to))
+                throw NRPException::logCreate("DataPack \"" + from.name() + "\" is not supported by engine '" + from.engineName() + "'");
+        }
+
+        bool trySetDataPackMessageData(const gpb::Message &from, EngineGrpc::DataPackMessage *to) override
+        {
+            const auto ops = this->_opsByMessageType.find(std::type_index(typeid(from)));
+            if(ops == this->_opsByMessageType.end())
+                return false;
+
+            ops->second->setDataPackMessageData(from, to);
+            return true;
+        }
+
+        bool trySetDataPackMessageFromInterface(const DataPackInterface &from, EngineGrpc::DataPackMessage *to) override
+        {
+            const auto ops = this->_opsByDataPackType.find(from.type());
+            return ops != this->_opsByDataPackType.end() && ops->second->setDataPackMessageFromInterface(from, to);
+        }
+
+        bool trySetTrajectoryMessageFromInterface(const DataPackInterface & from, NrpCore::TrajectoryMessage * to) override
+        {
+            const auto ops = this->_opsByDataPackType.find(from.type());
+            return ops != this->_opsByDataPackType.end() && ops->second->setTrajectoryMessageFromInterface(from, to);
+        }
+
+    private:
+
+        template<class MSG_TYPE>
+        void registerMessageType()
+        {
+            static constexpr MessageTypeOpsEntry entry = messageTypeOpsEntry<MSG_TYPE>();
+
+            this->_opsByMessageType.emplace(std::type_index(typeid(MSG_TYPE)), &entry);
+            this->_opsByDataPackType.emplace(DataPack<MSG_TYPE>::getType(), &entry);
+            this->_opsByFullName.emplace(MSG_TYPE::descriptor()->full_name(), &entry);
         }
+
+        const MessageTypeOpsEntry * findByFullName(std::string_view fullName) const
+        {
+            const auto ops = this->_opsByFullName.find(std::string(fullName));
+            return ops == this->_opsByFullName.end() ? nullptr : ops->second;
+        }
+
+        std::unordered_map<std::type_index, const MessageTypeOpsEntry *> _opsByMessageType;
+        std::unordered_map<std::string, const MessageTypeOpsEntry *>     _opsByDataPackType;
+        std::unordered_map<std::string, const MessageTypeOpsEntry *>     _opsByFullName;
     };
 }
 
@@ -0,0 +1,89 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_protobuf/proto_ops/segmented_message.h"
+
+#include <utility>
+
+namespace gpb = google::protobuf;
+
+namespace
+{
+    bool isSegmentable(const gpb::FieldDescriptor * field)
+    {
+        return field != nullptr && !field->is_repeated() && field->cpp_type() == gpb::FieldDescriptor::CPPTYPE_STRING;
+    }
+}
+
+void protobuf_ops::moveToSegmentedMessage(gpb::Message &data, EngineGrpc::SegmentedDataPackMessage *to, size_t minSegmentSize)
+{
+    const auto * descriptor = data.GetDescriptor();
+    const auto * reflection = data.GetReflection();
+
+    to->set_datatype(descriptor->full_name());
+
+    for(int i = 0; i < descriptor->field_count(); ++i)
+    {
+        const auto * field = descriptor->field(i);
+        if(!isSegmentable(field) || !reflection->HasField(data, field))
+            continue;
+
+        std::string scratch;
+        const std::string & value = reflection->GetStringReference(data, field, &scratch);
+        if(value.size() < minSegmentSize)
+            continue;
+
+        auto * segment = to->add_segments();
+        segment->set_fieldnumber(field->number());
+
+        // Reflection has no mutable accessor for singular string fields. The returned reference is either 'scratch' or
+        // the field's own string, which is owned by 'data' and not const, so its bytes can be moved into the segment.
+        // The moved-from field is cleared afterwards
+        auto & owned = (&value == &scratch) ? scratch : const_cast<std::string &>(value);
+        segment->set_data(std::move(owned));
+        reflection->ClearField(&data, field);
+    }
+
+    data.SerializeToString(to->mutable_data());
+}
+
+bool protobuf_ops::moveFromSegmentedMessage(EngineGrpc::SegmentedDataPackMessage &from, gpb::Message *data)
+{
+    if(!data->ParseFromString(from.data()))
+        return false;
+
+    const auto * descriptor = data->GetDescriptor();
+    const auto * reflection = data->GetReflection();
+
+    for(auto & segment : *from.mutable_segments())
+    {
+        const auto * field = descriptor->FindFieldByNumber(static_cast<int>(segment.fieldnumber()));
+        if(!isSegmentable(field))
+            return false;
+
+        reflection->SetString(data, field, std::move(*segment.mutable_data()));
+    }
+
+    return true;
+}
+
+// EOF
@@ -0,0 +1,64 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+
+#ifndef SEGMENTED_MESSAGE_H
+#define SEGMENTED_MESSAGE_H
+
+#include "google/protobuf/message.h"
+
+#include "nrp_protobuf/engine_grpc_segments.pb.h"
+
+namespace protobuf_ops {
+
+    /*!
+     * \brief Default minimum size of the bytes and string fields sent as separate segments
+     */
+    constexpr size_t DEFAULT_MIN_SEGMENT_SIZE = 4096;
+
+    /*!
+     * \brief Sets a segmented datapack message from a protobuf message, moving its large fields into segments
+     *
+     * Singular bytes and string fields of 'data' with at least 'minSegmentSize' bytes are moved into the segments of
+     * 'to', without copying or serializing them, and cleared in 'data'. The rest of 'data' is serialized into the data field of 'to'.
+     * Fields of nested messages are not segmented.
+     *
+     * \param[in,out] data Message to be sent. Its large fields are left empty
+     * \param[out] to Segmented datapack message. Its datapack id is not set
+     * \param[in] minSegmentSize Minimum size of the fields moved into segments
+     */
+    void moveToSegmentedMessage(google::protobuf::Message &data, EngineGrpc::SegmentedDataPackMessage *to,
+                                size_t minSegmentSize = DEFAULT_MIN_SEGMENT_SIZE);
+
+    /*!
+     * \brief Parses a protobuf message from a segmented datapack message, moving the segments into their fields
+     *
+     * \param[in,out] from Segmented datapack message. Its segments are left empty
+     * \param[out] data Message of the type given by from.datatype()
+     *
+     * \return False if 'from' couldn't be parsed into 'data'
+     */
+    bool moveFromSegmentedMessage(EngineGrpc::SegmentedDataPackMessage &from, google::protobuf::Message *data);
+}
+
+#endif // SEGMENTED_MESSAGE_H
+
+// EOF
@@ -22,8 +22,86 @@
 
 #include "nrp_protobuf/proto_python_bindings/proto_field_ops.h"
 
+namespace
+{
+    template<class T, T (gpb::Reflection::*GET)(const gpb::Message &, const gpb::FieldDescriptor *) const>
+    bpy::object getScalar(gpb::Message &m, const gpb::FieldDescriptor *field) {
+        return bpy::object((m.GetReflection()->*GET)(m, field));
+    }
+
+    bpy::object getString(gpb::Message &m, const gpb::FieldDescriptor *field) {
+        std::string scratch;
+        return bpy::object(m.GetReflection()->GetStringReference(m, field, &scratch));
+    }
+
+    bpy::object getBytes(gpb::Message &m, const gpb::FieldDescriptor *field) {
+        std::string scratch;
+        const std::string &s = m.GetReflection()->GetStringReference(m, field, &scratch);
+        return bpy::object(bpy::handle<>(PyBytes_FromStringAndSize(s.c_str(), s.length())));
+    }
+
+    template<class T, void (gpb::Reflection::*SET)(gpb::Message *, const gpb::FieldDescriptor *, T) const>
+    void setScalar(gpb::Message &m, const gpb::FieldDescriptor *field, const bpy::object &value) {
+        (m.GetReflection()->*SET)(&m, field, bpy::extract<T>(value));
+    }
+
+    void setString(gpb::Message &m, const gpb::FieldDescriptor *field, const bpy::object &value) {
+        m.GetReflection()->SetString(&m, field, bpy::extract<std::string>(value));
+    }
+}
+
 namespace proto_field_ops {
 
+    field_getter_t ScalarFieldGetter(const gpb::FieldDescriptor *field) {
+        switch(field->cpp_type()) {
+            case gpb::FieldDescriptor::CPPTYPE_INT32: // TYPE_INT32, TYPE_SINT32, TYPE_SFIXED32
+                return &getScalar<int32_t, &gpb::Reflection::GetInt32>;
+            case gpb::FieldDescriptor::CPPTYPE_INT64: // TYPE_INT64, TYPE_SINT64, TYPE_SFIXED64
+                return &getScalar<int64_t, &gpb::Reflection::GetInt64>;
+            case gpb::FieldDescriptor::CPPTYPE_UINT32: // TYPE_UINT32, TYPE_FIXED32
+                return &getScalar<uint32_t, &gpb::Reflection::GetUInt32>;
+            case gpb::FieldDescriptor::CPPTYPE_UINT64: // TYPE_UINT64, TYPE_FIXED64
+                return &getScalar<uint64_t, &gpb::Reflection::GetUInt64>;
+            case gpb::FieldDescriptor::CPPTYPE_DOUBLE: // TYPE_DOUBLE
+                return &getScalar<double, &gpb::Reflection::GetDouble>;
+            case gpb::FieldDescriptor::CPPTYPE_FLOAT: // TYPE_FLOAT
+                return &getScalar<float, &gpb::Reflection::GetFloat>;
+            case gpb::FieldDescriptor::CPPTYPE_BOOL: // TYPE_BOOL
+                return &getScalar<bool, &gpb::Reflection::GetBool>;
+            case gpb::FieldDescriptor::CPPTYPE_ENUM: // TYPE_ENUM
+                return &getScalar<int, &gpb::Reflection::GetEnumValue>;
+            case gpb::FieldDescriptor::CPPTYPE_STRING: // TYPE_STRING, TYPE_BYTES
+                return field->type() == gpb::FieldDescriptor::TYPE_BYTES ? &getBytes : &getString;
+            default:
+                throw NRPException::logCreate("Getting value from a field of non scalar type");
+        }
+    }
+
+    field_setter_t ScalarFieldSetter(const gpb::FieldDescriptor *field) {
+        switch(field->cpp_type()) {
+            case gpb::FieldDescriptor::CPPTYPE_INT32: // TYPE_INT32, TYPE_SINT32, TYPE_SFIXED32
+                return &setScalar<int32_t, &gpb::Reflection::SetInt32>;
+            case gpb::FieldDescriptor::CPPTYPE_INT64: // TYPE_INT64, TYPE_SINT64, TYPE_SFIXED64
+                return &setScalar<int64_t, &gpb::Reflection::SetInt64>;
+            case gpb::FieldDescriptor::CPPTYPE_UINT32: // TYPE_UINT32, TYPE_FIXED32
+                return &setScalar<uint32_t, &gpb::Reflection::SetUInt32>;
+            case gpb::FieldDescriptor::CPPTYPE_UINT64: // TYPE_UINT64, TYPE_FIXED64
+                return &setScalar<uint64_t, &gpb::Reflection::SetUInt64>;
+            case gpb::FieldDescriptor::CPPTYPE_DOUBLE: // TYPE_DOUBLE
+                return &setScalar<double, &gpb::Reflection::SetDouble>;
+            case gpb::FieldDescriptor::CPPTYPE_FLOAT: // TYPE_FLOAT
+                return &setScalar<float, &gpb::Reflection::SetFloat>;
+            case gpb::FieldDescriptor::CPPTYPE_BOOL: // TYPE_BOOL
+                return &setScalar<bool, &gpb::Reflection::SetBool>;
+            case gpb::FieldDescriptor::CPPTYPE_ENUM: // TYPE_ENUM
+                return &setScalar<int, &gpb::Reflection::SetEnumValue>;
+            case gpb::FieldDescriptor::CPPTYPE_STRING: // TYPE_STRING, TYPE_BYTES
+                return &setString;
+            default:
+                throw NRPException::logCreate("Setting value for a field of non scalar type");
+        }
+    }
+
     bpy::object GetScalarField(gpb::Message &m, const gpb::FieldDescriptor *field) {
         switch(field->cpp_type()) {
             case gpb::FieldDescriptor::CPPTYPE_INT32: // TYPE_INT32, TYPE_SINT32, TYPE_SFIXED32
@@ -35,6 +35,12 @@ namespace gpb = google::protobuf;
  */
 namespace proto_field_ops {
 
+    /*!
+     * \brief Get and set operations of a single field, as selected once from its descriptor
+     */
+    using field_getter_t = bpy::object (*)(gpb::Message &m, const gpb::FieldDescriptor *field);
+    using field_setter_t = void (*)(gpb::Message &m, const gpb::FieldDescriptor *field, const bpy::object &value);
+
     /*!
      * \brief Get scalar field. Returns a copy of the field value
      */
@@ -70,6 +76,42 @@ namespace proto_field_ops {
             throw NRPException::logCreate("Unable to get composite field with name " + field->name());
     }
 
+    /*!
+     * \brief Get message field of type MSG. Returns a reference of the field value
+     *
+     * The type of the field must have been checked beforehand, e.g. by MessageFieldGetter
+     */
+    template<class MSG>
+    bpy::object GetTypedMessageField(gpb::Message &m, const gpb::FieldDescriptor *field) {
+        MSG *msg_field = static_cast<MSG *>(m.GetReflection()->MutableMessage(&m, field));
+        typename bpy::reference_existing_object::apply<MSG *>::type convert;
+        return bpy::object(bpy::handle<>(convert(msg_field)));
+    }
+
+    /*!
+     * \brief Returns the getter of a message field whose type is one of MSG, REMAINING_MSGS. Null if it is none of them
+     */
+    template<class MSG, class ...REMAINING_MSGS>
+    field_getter_t MessageFieldGetter(const gpb::FieldDescriptor *field) {
+        if(field->message_type() == MSG::descriptor())
+            return &GetTypedMessageField<MSG>;
+
+        if constexpr (sizeof...(REMAINING_MSGS) > 0)
+            return MessageFieldGetter<REMAINING_MSGS...>(field);
+        else
+            return nullptr;
+    }
+
+    /*!
+     * \brief Returns the getter of a singular scalar field, specialized for its type
+     */
+    field_getter_t ScalarFieldGetter(const gpb::FieldDescriptor *field);
+
+    /*!
+     * \brief Returns the setter of a singular scalar field, specialized for its type
+     */
+    field_setter_t ScalarFieldSetter(const gpb::FieldDescriptor *field);
+
     /*!
      * \brief Set scalar field
      */
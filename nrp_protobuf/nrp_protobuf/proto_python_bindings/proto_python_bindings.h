@@ -25,8 +25,11 @@
 #include "google/protobuf/message.h"
 #include <boost/python.hpp>
 #include <algorithm>
+#include <string_view>
+#include <unordered_map>
 
 #include "nrp_general_library/utils/nrp_exceptions.h"
+#include "nrp_general_library/datapack_interface/datapack_data.h"
 #include "nrp_protobuf/proto_python_bindings/proto_field_ops.h"
 #include "nrp_protobuf/proto_python_bindings/repeated_field_proxy.h"
 
@@ -50,6 +53,14 @@ using namespace proto_field_ops;
  *  - 4. Basic Enum support. Enum fields get/set works with int. Enum constants can't be accessed from python https://developers.google.com/protocol-buffers/docs/reference/python-generated#enum
  *  - 5. Message Python wrapper supports only the a subset of the methods listed here https://googleapis.dev/python/protobuf/latest/google/protobuf/message.html
  *       (see "create" method)
+ *
+ * Field access operations are selected once per field when the bindings are created, and stored in a table indexed by
+ * field name (see "fieldAccessors"). Fields are exposed as properties of the Python class, so that reading them doesn't
+ * go through a failed attribute lookup and "__getattr__". Assignments take a single lookup in the table.
+ *
+ * Modifications of MSG_TYPE objects go through extractForWrite, so that the data of DataPacks accessed from python is
+ * only copied when it is modified (see DataPackPythonWrites). Message fields are returned by reference, and thus
+ * treated as modifications after which the data is no longer shared (see extractForReference).
  */
 template<class MSG_TYPE, class ...FIELD_MSG_TYPES>
 class proto_python_bindings
@@ -66,60 +77,81 @@ public:
         boost::python::throw_error_already_set();
     }
 
+    /*!
+     * \brief Field descriptor and get/set operations of a field of MSG_TYPE
+     */
+    struct FieldAccessor
+    {
+        const gpb::FieldDescriptor *field;
+        field_getter_t              get; // Null for repeated scalar fields, accessed through RepeatedScalarFieldProxy
+        field_setter_t              set; // Null if assignment to the field is not allowed
+        bool                        returnsReference; // If the value returned by 'get' refers to the message
+    };
+
+    using field_accessors_t = std::unordered_map<std::string_view, FieldAccessor>;
+
+    /*!
+     * \brief Returns the accessors of the fields of MSG_TYPE, indexed by field name
+     *
+     * They are created on first use, i.e. when the bindings are created. Keys refer to the field names stored in the
+     * descriptors, which live as long as the program
+     */
+    static const field_accessors_t & fieldAccessors()
+    {
+        static const field_accessors_t accessors = createFieldAccessors();
+        return accessors;
+    }
+
+    /*!
+     * \brief Returns the accessor of a field, or null if MSG_TYPE has no field with the given name
+     */
+    static const FieldAccessor * findFieldAccessor(char const* name)
+    {
+        const auto & accessors = fieldAccessors();
+        const auto accessor = accessors.find(name);
+        return accessor != accessors.end() ? &accessor->second : nullptr;
+    }
+
     /*!
      * \brief __getattr__
+     *
+     * Fields are read through their properties, it is only called for unknown attributes
      */
-    static bpy::object GetAttribute(MSG_TYPE& m, char const* name)
+    static bpy::object GetAttribute(const bpy::object& self, char const* name)
     {
-        const gpb::FieldDescriptor *field = m.GetDescriptor()->FindFieldByName(name);
-        if(!field) {
+        const FieldAccessor *accessor = findFieldAccessor(name);
+        if(!accessor) {
             std::stringstream s;
-            s << m.GetDescriptor()->name() << "\" object has no attribute \"" << name << "\"";
+            s << MSG_TYPE::descriptor()->name() << "\" object has no attribute \"" << name << "\"";
             throw_python_error(PyExc_AttributeError, s.str());
             return bpy::object();
         }
 
-        if(field->is_map())
-            return bpy::object();
-        else if(field->is_repeated())
-        {
-            if(field->cpp_type() == gpb::FieldDescriptor::CPPTYPE_MESSAGE)
-                return bpy::object();
-            else
-                return bpy::object(RepeatedScalarFieldProxy(m, field));
-        }
-        else if(field->cpp_type() == gpb::FieldDescriptor::CPPTYPE_MESSAGE) // TYPE_MESSAGE, TYPE_GROUP
-        {
-            if constexpr (sizeof...(FIELD_MSG_TYPES) > 0)
-                return GetMessageField<FIELD_MSG_TYPES...>(m, field);
-            else
-                throw NRPException::logCreate("Can't get composite field with name " + field->name());
-        }
-        else
-            return GetScalarField(m, field);
+        return GetField(self, *accessor);
     }
 
     /*!
      * \brief __setattr__
      */
-    static void SetAttribute(MSG_TYPE& m, char const* name, const bpy::object& value)
+    static void SetAttribute(const bpy::object& self, char const* name, const bpy::object& value)
     {
-        const gpb::FieldDescriptor *field = m.GetDescriptor()->FindFieldByName(name);
-        if(!field) {
+        const FieldAccessor *accessor = findFieldAccessor(name);
+        if(!accessor) {
             std::stringstream s;
-            s << m.GetDescriptor()->name() << "\" object has no attribute \"" << name << "\"";
+            s << MSG_TYPE::descriptor()->name() << "\" object has no attribute \"" << name << "\"";
             throw_python_error(PyExc_AttributeError, s.str());
             return;
         }
 
-        if(field->is_repeated() || field->is_map())
+        const gpb::FieldDescriptor *field = accessor->field;
+        if(accessor->set)
+            accessor->set(extractForWrite<MSG_TYPE>(self), field, value);
+        else if(field->is_repeated() || field->is_map())
             throw_python_error(PyExc_AttributeError,
                                "Assignment not allowed to repeated field \"" + field->name() + "\" in protocol message object.");
-        else if(field->cpp_type() == gpb::FieldDescriptor::CPPTYPE_MESSAGE) // TYPE_MESSAGE, TYPE_GROUP
+        else // TYPE_MESSAGE, TYPE_GROUP
             throw_python_error(PyExc_AttributeError,
                                "Assignment not allowed to field \"" + field->name() + "\" in protocol message object.");
-        else
-            SetScalarField(m, field, value);
     }
 
     /*!
@@ -146,16 +178,18 @@ public:
     /*!
      * \brief ClearField
      */
-    static void ClearField(MSG_TYPE& m, char const* name)
+    static void ClearField(const bpy::object& self, char const* name)
     {
-        const gpb::FieldDescriptor *field = m.GetDescriptor()->FindFieldByName(name);
-        if(field) {
-            m.GetReflection()->ClearField(&m, field);
+        const FieldAccessor *accessor = findFieldAccessor(name);
+        if(accessor) {
+            MSG_TYPE& m = extractForWrite<MSG_TYPE>(self);
+            m.GetReflection()->ClearField(&m, accessor->field);
             return;
         }
 
-        const gpb::OneofDescriptor *fieldOne = m.GetDescriptor()->FindOneofByName(name);
+        const gpb::OneofDescriptor *fieldOne = MSG_TYPE::descriptor()->FindOneofByName(name);
         if(fieldOne) {
+            MSG_TYPE& m = extractForWrite<MSG_TYPE>(self);
             m.GetReflection()->ClearOneof(&m, fieldOne);
             return;
         }
@@ -166,14 +200,22 @@ public:
         boost::python::throw_error_already_set();
     }
 
+    /*!
+     * \brief Clear
+     */
+    static void Clear(const bpy::object& self)
+    {
+        extractForWrite<MSG_TYPE>(self).Clear();
+    }
+
     /*!
      * \brief HasField
      */
     static bool HasField(MSG_TYPE& m, char const* name)
     {
-        const gpb::FieldDescriptor *field = m.GetDescriptor()->FindFieldByName(name);
-        if(field)
-            return m.GetReflection()->HasField(m, field);
+        const FieldAccessor *accessor = findFieldAccessor(name);
+        if(accessor)
+            return m.GetReflection()->HasField(m, accessor->field);
 
         std::stringstream s;
         s << "Unknown field " << name;
@@ -196,11 +238,11 @@ public:
     /*!
      * \brief GetFieldTypeName
      */
-    static bpy::str GetFieldTypeName(MSG_TYPE& m, char const* name)
+    static bpy::str GetFieldTypeName(MSG_TYPE& /*m*/, char const* name)
     {
-        const gpb::FieldDescriptor *field = m.GetDescriptor()->FindFieldByName(name);
-        if(field)
-            return bpy::str(field->type_name());
+        const FieldAccessor *accessor = findFieldAccessor(name);
+        if(accessor)
+            return bpy::str(accessor->field->type_name());
 
         std::stringstream s;
         s << "Unknown field " << name;
@@ -213,6 +255,8 @@ public:
      * \brief Creates bindings for Protobuf Message type MSG_TYPE
      */
     static bpy::class_<MSG_TYPE> create() {
+        DataPackPythonWrites<MSG_TYPE>::enableTracking();
+
         std::shared_ptr<gpb::Message> m(new MSG_TYPE());
         const gpb::Descriptor *desc = m->GetDescriptor();
 
@@ -220,6 +264,13 @@ public:
         py_name.erase(std::remove(py_name.begin(), py_name.end(), '.'), py_name.end());
 
         bpy::class_<MSG_TYPE> binder(py_name.c_str());
+
+        // Added first, so that methods take precedence over fields with the same name, as with "__getattr__"
+        for(const auto & accessor : fieldAccessors())
+            binder.add_property(std::string(accessor.first).c_str(),
+                                bpy::make_function(FieldGetter{ &accessor.second }, bpy::default_call_policies(),
+                                                   boost::mpl::vector<bpy::object, const bpy::object &>()));
+
         binder.def(bpy::init<const MSG_TYPE &>(py_name.c_str()));
         binder.def("__str__", &MSG_TYPE::DebugString);
         binder.def("__getattr__", GetAttribute);
@@ -230,10 +281,104 @@ public:
         binder.def("GetFieldTypeName", GetFieldTypeName);
         binder.def("WhichOneof",WhichOneof);
         binder.def("IsInitialized", &MSG_TYPE::IsInitialized);
-        binder.def("Clear", &MSG_TYPE::Clear);
+        binder.def("Clear", Clear);
 
         return binder;
     }
+
+private:
+
+    /*!
+     * \brief Getter of the Python property of a field
+     */
+    struct FieldGetter
+    {
+        const FieldAccessor *accessor;
+
+        bpy::object operator()(const bpy::object& self) const
+        {
+            return GetField(self, *accessor);
+        }
+    };
+
+    /*!
+     * \brief Returns the message wrapped by a python object, see RepeatedScalarFieldProxy::message_getter_t
+     */
+    static gpb::Message & GetMessage(const bpy::object& self, bool forWrite)
+    {
+        if(forWrite)
+            return extractForWrite<MSG_TYPE>(self);
+        else
+            return bpy::extract<MSG_TYPE&>(self)();
+    }
+
+    /*!
+     * \brief Returns the value of a field of the message wrapped by 'self'
+     *
+     * Values referring to the message keep 'self' alive
+     */
+    static bpy::object GetField(const bpy::object& self, const FieldAccessor& accessor)
+    {
+        if(!accessor.get)
+            return bpy::object(RepeatedScalarFieldProxy(self, &GetMessage, accessor.field));
+        else if(!accessor.returnsReference)
+            return accessor.get(bpy::extract<MSG_TYPE&>(self)(), accessor.field);
+
+        bpy::object value = accessor.get(extractForReference<MSG_TYPE>(self), accessor.field);
+        bpy::objects::make_nurse_and_patient(value.ptr(), self.ptr());
+        return value;
+    }
+
+    static bpy::object GetNone(gpb::Message &, const gpb::FieldDescriptor *)
+    {
+        return bpy::object();
+    }
+
+    static bpy::object GetUnsupportedMessageField(gpb::Message &, const gpb::FieldDescriptor *field)
+    {
+        throw NRPException::logCreate("Can't get composite field with name " + field->name());
+    }
+
+    /*!
+     * \brief Selects the get/set operations of a field from its descriptor
+     */
+    static FieldAccessor createFieldAccessor(const gpb::FieldDescriptor *field)
+    {
+        if(field->is_map())
+            return { field, &GetNone, nullptr, false };
+        else if(field->is_repeated())
+        {
+            if(field->cpp_type() == gpb::FieldDescriptor::CPPTYPE_MESSAGE)
+                return { field, &GetNone, nullptr, false };
+            else
+                return { field, nullptr, nullptr, false };
+        }
+        else if(field->cpp_type() == gpb::FieldDescriptor::CPPTYPE_MESSAGE) // TYPE_MESSAGE, TYPE_GROUP
+        {
+            if constexpr (sizeof...(FIELD_MSG_TYPES) > 0)
+            {
+                // Fields whose type is none of FIELD_MSG_TYPES are resolved on access, as without the table
+                const field_getter_t getter = MessageFieldGetter<FIELD_MSG_TYPES...>(field);
+                return { field, getter ? getter : &GetMessageField<FIELD_MSG_TYPES...>, nullptr, true };
+            }
+            else
+                return { field, &GetUnsupportedMessageField, nullptr, false };
+        }
+        else
+            return { field, ScalarFieldGetter(field), ScalarFieldSetter(field), false };
+    }
+
+    static field_accessors_t createFieldAccessors()
+    {
+        const gpb::Descriptor *desc = MSG_TYPE::descriptor();
+
+        field_accessors_t accessors;
+        accessors.reserve(desc->field_count());
+        for(int i = 0; i < desc->field_count(); ++i)
+            accessors.emplace(desc->field(i)->name(), createFieldAccessor(desc->field(i)));
+
+        return accessors;
+    }
 };
 
 #endif // PROTO_PYTHON_BINDINGS_H
@@ -20,6 +20,57 @@
 // Agreement No. 945539 (Human Brain Project SGA3).
 //
 #include "nrp_protobuf/proto_python_bindings/repeated_field_proxy.h"
+#include "nrp_general_library/datapack_interface/datapack_data.h"
+
+#include <cstring>
+#include <boost/python/numpy.hpp>
+
+namespace np = boost::python::numpy;
+
+namespace
+{
+    template<class T>
+    gpb::RepeatedField<T> * MutableRepeatedField(gpb::Message &m, const gpb::FieldDescriptor *field)
+    {
+        // The contiguous storage of the field is only accessible through this function, which is deprecated in favor
+        // of MutableRepeatedFieldRef. The latter only gives element-wise access
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+        return m.GetReflection()->MutableRepeatedField<T>(&m, field);
+#pragma GCC diagnostic pop
+    }
+
+    /*!
+     * \brief Calls 'fcn' with a value of the C++ type of a numeric repeated field. Raises a Python TypeError for
+     * other fields
+     */
+    template<class FUNCTION>
+    auto VisitNumericField(const gpb::FieldDescriptor *field, FUNCTION &&fcn)
+    {
+        switch(field->cpp_type()) {
+            case gpb::FieldDescriptor::CPPTYPE_INT32: // TYPE_INT32, TYPE_SINT32, TYPE_SFIXED32
+                return fcn(int32_t());
+            case gpb::FieldDescriptor::CPPTYPE_INT64: // TYPE_INT64, TYPE_SINT64, TYPE_SFIXED64
+                return fcn(int64_t());
+            case gpb::FieldDescriptor::CPPTYPE_UINT32: // TYPE_UINT32, TYPE_FIXED32
+                return fcn(uint32_t());
+            case gpb::FieldDescriptor::CPPTYPE_UINT64: // TYPE_UINT64, TYPE_FIXED64
+                return fcn(uint64_t());
+            case gpb::FieldDescriptor::CPPTYPE_DOUBLE: // TYPE_DOUBLE
+                return fcn(double());
+            case gpb::FieldDescriptor::CPPTYPE_FLOAT: // TYPE_FLOAT
+                return fcn(float());
+            case gpb::FieldDescriptor::CPPTYPE_BOOL: // TYPE_BOOL
+                return fcn(bool());
+            default:
+                break;
+        }
+
+        PyErr_SetString(PyExc_TypeError, ("Repeated field \"" + field->name() + "\" is not of numeric type").c_str());
+        boost::python::throw_error_already_set();
+        return fcn(int32_t());
+    }
+}
 
 Py_ssize_t ExtractIndices(PyObject* indices, Py_ssize_t& from, Py_ssize_t& to, Py_ssize_t& step, Py_ssize_t length)
 {
@@ -46,20 +97,21 @@ bpy::object RepeatedScalarFieldProxy::GetItem(PyObject* indices)
     Py_ssize_t from, to, step;
     Py_ssize_t length = Len();
     Py_ssize_t slicelength = ExtractIndices(indices, from, to, step, length);
+    gpb::Message &m = message();
 
     if(slicelength == -1)
-        return GetRepeatedScalarField(_m, _f, from);
+        return GetRepeatedScalarField(m, _f, from);
     else if(slicelength == 0)
         return bpy::list();
     else {
         bpy::list items;
         if(from <= to) {
             for(Py_ssize_t index = from; index < to; index += step)
-                items.append(GetRepeatedScalarField(_m, _f, index));
+                items.append(GetRepeatedScalarField(m, _f, index));
         }
         else {
             for(Py_ssize_t index = from; index > to; index += step)
-                items.append(GetRepeatedScalarField(_m, _f, index));
+                items.append(GetRepeatedScalarField(m, _f, index));
         }
 
         return std::move(items);
@@ -71,9 +123,10 @@ void RepeatedScalarFieldProxy::SetItem(PyObject* indices, PyObject* value)
     Py_ssize_t from, to, step;
     Py_ssize_t length = Len();
     Py_ssize_t slicelength = ExtractIndices(indices, from, to, step, length);
+    gpb::Message &m = mutableMessage();
 
     if(slicelength == -1) {
-        SetRepeatedScalarField(_m, _f, bpy::object(boost::python::handle<>(boost::python::borrowed(value))), from);
+        SetRepeatedScalarField(m, _f, bpy::object(boost::python::handle<>(boost::python::borrowed(value))), from);
         return;
     }
     else if( !PySequence_Check(value) ) {
@@ -92,12 +145,12 @@ void RepeatedScalarFieldProxy::SetItem(PyObject* indices, PyObject* value)
         Py_ssize_t n = 0;
         if(from <= to) {
             for(Py_ssize_t index = from; index < to; index += step)
-                SetRepeatedScalarField(_m, _f,bpy::object(boost::python::handle<>(boost::python::borrowed(
+                SetRepeatedScalarField(m, _f,bpy::object(boost::python::handle<>(boost::python::borrowed(
                         PySequence_GetItem(value, n++)))), index);
         }
         else {
             for(Py_ssize_t index = from; index > to; index += step)
-                SetRepeatedScalarField(_m, _f,bpy::object(boost::python::handle<>(boost::python::borrowed(
+                SetRepeatedScalarField(m, _f,bpy::object(boost::python::handle<>(boost::python::borrowed(
                         PySequence_GetItem(value, n++)))), index);
         }
     }
@@ -110,15 +163,54 @@ void RepeatedScalarFieldProxy::SetItem(PyObject* indices, PyObject* value)
         Clear();
 
         for(int i=0;i<from;++i)
-            AddRepeatedScalarField(_m, _f, old_items[i]);
+            AddRepeatedScalarField(m, _f, old_items[i]);
         for(int i=0;i<PySequence_Length(value);++i)
-            AddRepeatedScalarField(_m, _f,
+            AddRepeatedScalarField(m, _f,
                                    bpy::object(boost::python::handle<>(boost::python::borrowed(PySequence_GetItem(value, i)))));
         for(int i=to;i<length;++i)
-            AddRepeatedScalarField(_m, _f, old_items[i]);
+            AddRepeatedScalarField(m, _f, old_items[i]);
     }
 }
 
 bpy::object RepeatedScalarFieldProxy::Iter()
-{ return  bpy::object(RepeatedScalarFieldIterProxy(_m, _f)); }
+{ return  bpy::object(RepeatedScalarFieldIterProxy(*this)); }
 
+bpy::object RepeatedScalarFieldProxy::AsNumpy()
+{
+    return VisitNumericField(_f, [&](auto value) -> bpy::object {
+        using T = decltype(value);
+
+        // The array refers to the field for as long as it lives. If the message is DataPack data, it must not be
+        // shared with other DataPacks afterwards, otherwise they would see the changes made through the array
+        auto * holder = DataPackDataHolderBase::find(_owner.ptr());
+        if(holder)
+            holder->pin();
+
+        auto * field = MutableRepeatedField<T>(mutableMessage(), _f);
+
+        return np::from_data(field->mutable_data(), np::dtype::get_builtin<T>(), bpy::make_tuple(field->size()),
+                             bpy::make_tuple(sizeof(T)), _owner);
+    });
+}
+
+void RepeatedScalarFieldProxy::AssignFrom(const bpy::object& value)
+{
+    VisitNumericField(_f, [&](auto typeValue) {
+        using T = decltype(typeValue);
+        const np::dtype dtype = np::dtype::get_builtin<T>();
+
+        // Elements are converted as in NumPy assignments, e.g. from float64 to float32, which from_object doesn't do
+        np::ndarray array = np::from_object(value, 1, 1);
+        if(!np::equivalent(array.get_dtype(), dtype))
+            array = array.astype(dtype);
+        if(!(array.get_flags() & np::ndarray::C_CONTIGUOUS))
+            array = array.copy();
+
+        const auto size = static_cast<int>(array.shape(0));
+
+        auto * field = MutableRepeatedField<T>(mutableMessage(), _f);
+        field->Resize(size, T());
+        if(size > 0)
+            std::memcpy(field->mutable_data(), array.get_data(), size * sizeof(T));
+    });
+}
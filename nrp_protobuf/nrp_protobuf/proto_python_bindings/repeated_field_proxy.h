@@ -52,6 +52,7 @@ public:
      * The python wrapper supports the usual python "list" index get/set operations and iteration.
      * It does not support the next list methods: '__delitem__', 'copy', 'count', 'index', 'insert', 'remove', 'reverse', 'sort'.
      * It does not support comparison with a list.
+     * Numeric fields can be accessed in bulk with 'as_numpy' and 'assign_from'.
      */
     static void create() {
         bpy::class_<RepeatedScalarFieldProxy> binder("RepeatedScalarField", bpy::no_init);
@@ -63,16 +64,28 @@ public:
         binder.def("extend", &RepeatedScalarFieldProxy::Extend);
         binder.def("pop", &RepeatedScalarFieldProxy::Pop);
         binder.def("clear", &RepeatedScalarFieldProxy::Clear);
+        binder.def("as_numpy", &RepeatedScalarFieldProxy::AsNumpy);
+        binder.def("assign_from", &RepeatedScalarFieldProxy::AssignFrom);
     }
 
+    /*!
+     * \brief Function returning the message wrapped by a python object. 'forWrite' is true if the message is going
+     * to be modified
+     */
+    using message_getter_t = gpb::Message & (*)(const bpy::object &owner, bool forWrite);
+
     /*!
      * \brief Constructor
      *
-     * @param msg Message storing the wrapped field
+     * The message is retrieved from its python object on every operation, so that the proxy stays valid as long as
+     * it exists, and modifications are notified to the python object (see DataPackDataHolder)
+     *
+     * @param owner Python object of the message storing the wrapped field
+     * @param getMessage Function returning the message from 'owner'
      * @param field Field descriptor
      */
-    RepeatedScalarFieldProxy(gpb::Message & msg, const gpb::FieldDescriptor *field)
-            : _m(msg), _f(field) {
+    RepeatedScalarFieldProxy(bpy::object owner, message_getter_t getMessage, const gpb::FieldDescriptor *field)
+            : _owner(std::move(owner)), _getMessage(getMessage), _f(field) {
         if(!field->is_repeated())
             throw NRPException::logCreate("Accessing RepeatedScalarFieldProxy from a non-repeating field");
         else if(field->cpp_type() == gpb::FieldDescriptor::CPPTYPE_MESSAGE)
@@ -83,7 +96,10 @@ public:
      * /brief __len__
      */
     int Len()
-    { return _m.GetReflection()->FieldSize(_m, _f); }
+    {
+        const gpb::Message &m = message();
+        return m.GetReflection()->FieldSize(m, _f);
+    }
 
     /*!
      * /brief __getitem__
@@ -104,31 +120,63 @@ public:
      * /brief append
      */
     void Append(const bpy::object& value)
-    { AddRepeatedScalarField(_m, _f, value); }
+    { AddRepeatedScalarField(mutableMessage(), _f, value); }
 
     /*!
      * /brief __extend__
      */
     void Extend(const bpy::object& value) {
+        gpb::Message &m = mutableMessage();
         for(int i=0; i<bpy::len(value); ++i)
-            AddRepeatedScalarField(_m, _f, value[i]);
+            AddRepeatedScalarField(m, _f, value[i]);
     }
 
     /*!
      * /brief clear
      */
     void Clear()
-    { _m.GetReflection()->ClearField(&_m,_f); }
+    {
+        gpb::Message &m = mutableMessage();
+        m.GetReflection()->ClearField(&m,_f);
+    }
 
     /*!
      * /brief pop
      */
     void Pop()
-    { _m.GetReflection()->RemoveLast(&_m, _f); }
+    {
+        gpb::Message &m = mutableMessage();
+        m.GetReflection()->RemoveLast(&m, _f);
+    }
+
+    /*!
+     * /brief as_numpy
+     *
+     * Returns a NumPy array which shares its data with the field, without copying it. Changes to the array are
+     * changes to the field. The array keeps the python object of the message alive, and is valid as long as the
+     * field is not resized. Only numeric and bool fields are supported
+     */
+    bpy::object AsNumpy();
+
+    /*!
+     * /brief assign_from
+     *
+     * Replaces the content of the field with 'value', a NumPy array or any sequence convertible into one. The data is
+     * copied at once, after being converted to the type of the field if needed.
+     * Only numeric and bool fields are supported
+     */
+    void AssignFrom(const bpy::object& value);
 
 private:
 
-    gpb::Message & _m;
+    gpb::Message & message() const
+    { return _getMessage(_owner, false); }
+
+    gpb::Message & mutableMessage() const
+    { return _getMessage(_owner, true); }
+
+    bpy::object _owner;
+    message_getter_t _getMessage;
     const gpb::FieldDescriptor * _f;
 };
 
@@ -151,8 +199,8 @@ public:
     /*!
      * \brief Constructor
      */
-    RepeatedScalarFieldIterProxy(gpb::Message & msg, const gpb::FieldDescriptor *field)
-            : _p(msg, field), _ind(0) { }
+    explicit RepeatedScalarFieldIterProxy(RepeatedScalarFieldProxy proxy)
+            : _p(std::move(proxy)), _ind(0) { }
 
     /*!
      * \brief Implementation of __next__
@@ -0,0 +1,86 @@
+# NRP Core - Backend infrastructure to synchronize simulations
+#
+# Copyright 2020-2023 NRP Team
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# This project has received funding from the European Union’s Horizon 2020
+# Framework Programme for Research and Innovation under the Specific Grant
+# Agreement No. 945539 (Human Brain Project SGA3).
+
+
+import gc
+import unittest
+
+import numpy as np
+from nrp_core.data.nrp_protobuf import *
+
+
+class TestRepeatedFieldProxy(unittest.TestCase):
+
+    def test_as_numpy_shares_data(self):
+        datapack = NrpGenericProtoArrayFloatDataPack("test_datapack", "test_engine")
+        datapack.data.array[:] = [1.0, 2.0, 3.0]
+
+        values = datapack.data.array.as_numpy()
+        self.assertEqual(values.dtype, np.float32)
+        np.testing.assert_array_equal(values, [1.0, 2.0, 3.0])
+
+        values += 1.0
+        self.assertEqual(list(datapack.data.array), [2.0, 3.0, 4.0])
+
+        datapack.data.array[0] = 5.0
+        self.assertEqual(values[0], 5.0)
+
+    def test_as_numpy_keeps_message_alive(self):
+        datapack = NrpGenericProtoArrayInt32DataPack("test_datapack", "test_engine")
+        datapack.data.array[:] = [1, 2, 3]
+
+        values = datapack.data.array.as_numpy()
+        del datapack
+        gc.collect()
+
+        values[1] = 7
+        np.testing.assert_array_equal(values, [1, 7, 3])
+        self.assertIsNotNone(values.base)
+
+    def test_assign_from(self):
+        datapack = NrpGenericProtoArrayFloatDataPack("test_datapack", "test_engine")
+
+        # float64 elements are converted to the field type
+        datapack.data.array.assign_from(np.array([0.5, 1.5, 2.5], dtype=np.float64))
+        self.assertEqual(list(datapack.data.array), [0.5, 1.5, 2.5])
+
+        # Any sequence convertible to an array is accepted
+        datapack.data.array.assign_from([3.0, 4.0])
+        self.assertEqual(list(datapack.data.array), [3.0, 4.0])
+
+        # Non contiguous arrays are accepted
+        datapack.data.array.assign_from(np.arange(6, dtype=np.float32)[::2])
+        self.assertEqual(list(datapack.data.array), [0.0, 2.0, 4.0])
+
+    def test_string_field_not_supported(self):
+        datapack = NrpGenericProtoArrayStringDataPack("test_datapack", "test_engine")
+        datapack.data.array.append("test")
+
+        with self.assertRaises(TypeError):
+            datapack.data.array.as_numpy()
+
+        with self.assertRaises(TypeError):
+            datapack.data.array.assign_from(["a", "b"])
+
+        self.assertEqual(list(datapack.data.array), ["test"])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -40,6 +40,9 @@ import time
 DEFAULT_TIMEOUT = 90
 DEFAULT_WORKERS = 1
 
+CBOR_CONTENT_TYPE = "application/cbor"
+MSGPACK_CONTENT_TYPE = "application/msgpack"
+
 # Disable debug printouts
 
 import logging
@@ -75,34 +78,61 @@ def all_exception_handler(error):
     return jsonify(str(error)), 500
 
 
+def decode_request():
+    """
+    Decodes the body of the current request according to its content type.
+    Besides JSON, CBOR and MessagePack bodies are accepted, see the WireFormat engine configuration parameter.
+    """
+    if request.mimetype == CBOR_CONTENT_TYPE:
+        import cbor2
+        return cbor2.loads(request.get_data())
+    elif request.mimetype == MSGPACK_CONTENT_TYPE:
+        import msgpack
+        return msgpack.unpackb(request.get_data(), raw=False)
+
+    return request.json
+
+
+def encode_response(data):
+    """Encodes the response data in the same format as the current request"""
+    if request.mimetype == CBOR_CONTENT_TYPE:
+        import cbor2
+        return flask.Response(cbor2.dumps(data), mimetype=CBOR_CONTENT_TYPE)
+    elif request.mimetype == MSGPACK_CONTENT_TYPE:
+        import msgpack
+        return flask.Response(msgpack.packb(data, use_bin_type=True), mimetype=MSGPACK_CONTENT_TYPE)
+
+    return jsonify(data)
+
+
 @app.route('/initialize', methods=["POST"])
 def initialize():
-    return jsonify(server_callbacks.initialize(request.json))
+    return encode_response(server_callbacks.initialize(decode_request()))
 
 
 @app.route('/run_loop', methods=["POST"])
 def run_loop():
-    return jsonify(server_callbacks.run_loop(request.json))
+    return encode_response(server_callbacks.run_loop(decode_request()))
 
 
 @app.route('/set_datapacks', methods=["POST"])
 def set_datapack():
-    return jsonify(server_callbacks.set_datapacks(request.json))
+    return encode_response(server_callbacks.set_datapacks(decode_request()))
 
 
 @app.route('/get_datapacks', methods=["POST"])
 def get_datapack():
-    return jsonify(server_callbacks.get_datapacks(request.json))
+    return encode_response(server_callbacks.get_datapacks(decode_request()))
 
 
 @app.route('/reset', methods=["POST"])
 def reset():
-    return jsonify(server_callbacks.reset(request.json))
+    return encode_response(server_callbacks.reset(decode_request()))
 
 
 @app.route('/shutdown', methods=["POST"])
 def shutdown():
-    return jsonify(server_callbacks.shutdown(request.json))
+    return encode_response(server_callbacks.shutdown(decode_request()))
 
 
 def parse_arguments() -> Namespace:
@@ -100,20 +100,31 @@ struct ComputationalGraphHandle : public DataPackProcessor {
 
         // Find Clock and Iteration nodes
         std::tie(_clock, _iteration) = findTimeNodes();
+
+        // Engines with linked input or output nodes exchange datapacks with the graph
+        this->initDecoupledEngines(engines, [this] (const std::string &engineName) {
+            return _inputs.count(engineName) || _outputs.count(engineName);
+        });
     }
 
     void updateDataPacksFromEngines(const std::vector<EngineClientInterfaceSharedPtr> &engines) override
     {
-        if(_slaveMode)
-            _pyGILState = PyGILState_Ensure();
+        // Find engines with linked input nodes
+        std::vector<EngineClientInterfaceSharedPtr> inputEngines;
+        std::vector<InputEngineNode*> inputNodes;
+        for(auto &engine : engines)
+            if(_inputs.count(engine->engineName())) {
+                inputEngines.push_back(engine);
+                inputNodes.push_back(_inputs[engine->engineName()]);
+            }
 
+        // Request datapacks concurrently, they are passed to the nodes afterwards in engines order
+        std::vector<datapacks_vector_t> engineDataPacks(inputEngines.size());
         try
         {
-            for(auto &engine : engines)
-                if(_inputs.count(engine->engineName())) {
-                    _inputs[engine->engineName()]->setDataPacks(
-                            engine->getDataPacksFromEngine(_inputs[engine->engineName()]->requestedDataPacks()));
-                }
+            this->forEachEngineConcurrently(inputEngines, [&] (size_t i) {
+                engineDataPacks[i] = inputEngines[i]->getDataPacksFromEngine(inputNodes[i]->requestedDataPacks());
+            });
         }
         catch(std::exception &)
         {
@@ -121,6 +132,12 @@ struct ComputationalGraphHandle : public DataPackProcessor {
             throw;
         }
 
+        if(_slaveMode)
+            _pyGILState = PyGILState_Ensure();
+
+        for(size_t i = 0; i < inputNodes.size(); ++i)
+            inputNodes[i]->setDataPacks(engineDataPacks[i]);
+
         if(_slaveMode)
             PyGILState_Release(_pyGILState);
     }
@@ -151,20 +168,28 @@ struct ComputationalGraphHandle : public DataPackProcessor {
         if(_slaveMode)
             _pyGILState = PyGILState_Ensure();
 
+        // Collect datapacks from output nodes
+        std::vector<EngineClientInterfaceSharedPtr> outputEngines;
+        std::vector<datapacks_set_t> engineDataPacks;
         for(const auto &engine : engines)
             if(_outputs.count(engine->engineName())) {
-                try {
-                    auto devs = _outputs[engine->engineName()]->getDataPacks();
-                    engine->sendDataPacksToEngine(devs);
-                }
-                catch (std::exception &e) {
-                    throw NRPException::logCreate(e,
-                                                  "Failed to send datapacks to engine \"" + engine->engineName() + "\"");
-                }
+                outputEngines.push_back(engine);
+                engineDataPacks.push_back(_outputs[engine->engineName()]->getDataPacks());
             }
 
         if(_slaveMode)
             PyGILState_Release(_pyGILState);
+
+        // Send datapacks to all engines concurrently
+        this->forEachEngineConcurrently(outputEngines, [&] (size_t i) {
+            try {
+                outputEngines[i]->sendDataPacksToEngine(engineDataPacks[i]);
+            }
+            catch (std::exception &e) {
+                throw NRPException::logCreate(e,
+                                              "Failed to send datapacks to engine \"" + outputEngines[i]->engineName() + "\"");
+            }
+        });
     }
 };
 
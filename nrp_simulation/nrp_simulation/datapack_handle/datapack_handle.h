@@ -25,6 +25,7 @@
 #include "nrp_general_library/engine_interfaces/engine_client_interface.h"
 #include "nrp_general_library/utils/json_schema_utils.h"
 #include "nrp_general_library/utils/time_utils.h"
+#include "nrp_general_library/utils/thread_pool.h"
 #include "nrp_general_library/transceiver_function/function_manager.h"
 #include "nrp_simulation/datapack_handle/simulation_data_manager.h"
 
@@ -59,6 +60,17 @@ public:
      */
     virtual void updateDataPacksFromEngines(const std::vector<EngineClientInterfaceSharedPtr> &engines) = 0;
 
+    /*!
+     * \brief Perform computations which only depend on the datapacks of the given engines
+     *
+     * It is called after updateDataPacksFromEngines() and before compute(). Since it doesn't depend on
+     * datapacks from other engines, it can be executed as soon as the given engines complete their step.
+     *
+     * \param engines Engines that are been synchronize in the current loop
+     */
+    virtual void preprocess(const std::vector<EngineClientInterfaceSharedPtr> &/*engines*/)
+    {}
+
     /*!
      * \brief Perform computations on datapacks
      *
@@ -73,6 +85,18 @@ public:
      */
     virtual void sendDataPacksToEngines(const std::vector<EngineClientInterfaceSharedPtr> &engines) = 0;
 
+    /*!
+     * \brief Checks if the given engine is decoupled from the rest of the simulation
+     *
+     * An engine is decoupled if it is configured with "EngineDecoupled" set to true, i.e. it doesn't need to be
+     * synchronized with other engines. It is set once in init() and doesn't change during the simulation.
+     *
+     * \param engine Engine to be checked
+     * \return True if the engine is decoupled
+     */
+    bool isEngineDecoupled(const EngineClientInterfaceSharedPtr &engine) const
+    { return this->_decoupledEngines.count(engine->engineName()) > 0; }
+
     /*!
      * \brief Performs post-engine-initialization DataPack operations
      *
@@ -98,15 +122,41 @@ public:
     {}
 
     /*!
-     * \brief Execute sequentially the update, compute and send operations
+     * \brief Execute sequentially the update, preprocess, compute and send operations
      *
      * \param engines Engines that are been synchronize in the current loop
-     * \param clientData Extra data coming from the NRP Client, will be passed to the status function
      */
     void datapackCycle(const std::vector<EngineClientInterfaceSharedPtr> &engines)
+    {
+        engineDataPackCycle(engines);
+        barrierDataPackCycle(engines);
+    }
+
+    /*!
+     * \brief Execute sequentially the update and preprocess operations
+     *
+     * This is the part of the datapack cycle which can be executed for each engine as soon as it completes its step
+     *
+     * \param engines Engines which have completed their step
+     */
+    void engineDataPackCycle(const std::vector<EngineClientInterfaceSharedPtr> &engines)
     {
         updateDataPacksFromEngines(engines);
         NRP_LOG_TIME("after_get_datapacks");
+        preprocess(engines);
+        NRP_LOG_TIME("after_run_pfs");
+    }
+
+    /*!
+     * \brief Execute sequentially the compute and send operations
+     *
+     * This is the part of the datapack cycle which requires all engines synchronized in the current loop
+     * to have completed their step and engineDataPackCycle() to have been executed for all of them
+     *
+     * \param engines Engines that are been synchronize in the current loop
+     */
+    void barrierDataPackCycle(const std::vector<EngineClientInterfaceSharedPtr> &engines)
+    {
         compute(engines);
         NRP_LOG_TIME("after_run_tfs");
         sendDataPacksToEngines(engines);
@@ -126,9 +176,77 @@ public:
 
 protected:
 
+    /*!
+     * \brief Stores the engines configured as decoupled, checking that no datapacks are exchanged with them
+     *
+     * Meant to be called from init(), once the datapacks exchanged with each engine are known
+     *
+     * \param engines Engines participating in the simulation
+     * \param exchangesDataPacks Function returning true if datapacks are requested from or sent to the given engine name
+     */
+    template<class FCN>
+    void initDecoupledEngines(const engine_interfaces_t &engines, FCN &&exchangesDataPacks)
+    {
+        this->_decoupledEngines.clear();
+
+        for(const auto &engine : engines)
+        {
+            if(!engine->engineConfig().value("EngineDecoupled", false))
+                continue;
+
+            if(exchangesDataPacks(engine->engineName()))
+                throw NRPException::logCreate("Engine \"" + engine->engineName() + "\" is configured with "
+                                              "\"EngineDecoupled\" set to true, but datapacks are exchanged with it");
+
+            this->_decoupledEngines.insert(engine->engineName());
+        }
+    }
+
+    /*!
+     * \brief Calls fcn(i) for the i-th engine in engines, concurrently for all engines
+     *
+     * It is meant to overlap blocking requests to different engines, e.g. datapack exchanges. The function
+     * returns when all calls have finished. Results should be stored by index and processed afterwards in
+     * engines order, so that they are merged deterministically.
+     *
+     * \param engines Engines for which fcn will be called
+     * \param fcn Function to be called with the index of each engine
+     */
+    template<class FCN>
+    void forEachEngineConcurrently(const std::vector<EngineClientInterfaceSharedPtr> &engines, FCN &&fcn)
+    {
+        if(engines.size() <= 1)
+        {
+            for(size_t i = 0; i < engines.size(); ++i)
+                fcn(i);
+
+            return;
+        }
+
+        // Every call with more than one engine runs concurrently. The pool is created by the first of them, with one
+        // thread less than its number of engines since the calling thread also runs one call. Later calls with more
+        // engines queue the extra calls on the same threads
+        if(!this->_engineRequestsPool)
+            this->_engineRequestsPool.reset(new ThreadPool(engines.size() - 1));
+
+        this->_engineRequestsPool->parallelFor(engines.size(), std::forward<FCN>(fcn));
+    }
+
     SimulationDataManager * _simulationDataManager;
     SimulationTime _simulationTime = SimulationTime::zero();
     unsigned long _simulationIteration = 0L;
+
+private:
+
+    /*!
+     * \brief Threads used to run requests to engines concurrently
+     */
+    std::unique_ptr<ThreadPool> _engineRequestsPool;
+
+    /*!
+     * \brief Names of the engines configured as decoupled
+     */
+    std::set<std::string> _decoupledEngines;
 };
 
 #endif // DATAPACK_HANDLE_H
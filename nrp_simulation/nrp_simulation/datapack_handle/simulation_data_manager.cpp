@@ -25,28 +25,43 @@
 #include "nrp_json_engine_protocol/datapack_interfaces/json_datapack.h"
 
 
-static void resetIsUpdateFlags(datapacks_set_t & dataPacks)
+static void resetIsUpdateFlags(const DataPackPool & dataPacks)
 {
-    for(auto &dataPack: dataPacks)
-    {
+    dataPacks.forEach([] (const DataPackInterfaceConstSharedPtr &dataPack) {
         dataPack->resetIsUpdated();
+    });
+}
+
+
+static void updateDataPackPool(const datapacks_vector_t & dataPacks, DataPackPool & pool)
+{
+    for(const auto &dataPack : dataPacks)
+    {
+        pool.update(dataPack);
     }
 }
 
 
-static void updateDataPackPool(datapacks_vector_t dataPacks, datapacks_set_t & pool)
+/*!
+ * \brief Merges the given pools into a set. When several pools contain a DataPack with the same ID,
+ *        the DataPack from the first of them is used
+ */
+static datapacks_set_t mergePools(std::initializer_list<const DataPackPool *> pools)
 {
-    for(auto it = dataPacks.begin(); it != dataPacks.end(); it++)
+    datapacks_set_t dataPacks;
+
+    for(const auto pool : pools)
     {
-        pool.erase(*it);
-        pool.insert(*it);
+        pool->mergeInto(dataPacks);
     }
+
+    return dataPacks;
 }
 
 
 void SimulationDataManager::pushToTrajectory(datapacks_vector_t dataPackVector)
 {
-    this->_trajectory.insert(this->_trajectory.end(), dataPackVector.begin(), dataPackVector.end());
+    this->_trajectory.push(dataPackVector);
 }
 
 
@@ -56,7 +71,13 @@ void SimulationDataManager::clearTrajectory()
 }
 
 
-const datapacks_vector_t & SimulationDataManager::getTrajectory() const
+const TrajectoryStore & SimulationDataManager::getTrajectory() const
+{
+    return this->_trajectory;
+}
+
+
+TrajectoryStore & SimulationDataManager::getTrajectory()
 {
     return this->_trajectory;
 }
@@ -105,16 +126,14 @@ void SimulationDataManager::updateTransceiverPool(datapacks_vector_t dataPacks)
 
 void SimulationDataManager::updateEnginePool(datapacks_vector_t dataPacks)
 {
-    for(auto it = dataPacks.begin(); it != dataPacks.end(); it++)
+    for(const auto &dataPack : dataPacks)
     {
         // If there's no datapack with the name in the cache - insert it
         // It there already is one - replace it, but only with a non-empty datapack
 
-        const int count = this->_enginePool.count(*it);
-        if(count == 0 || (count > 0 && !(*it)->isEmpty()))
+        if(!this->_enginePool.insert(dataPack) && !dataPack->isEmpty())
         {
-            this->_enginePool.erase(*it);
-            this->_enginePool.insert(*it);
+            this->_enginePool.update(dataPack);
         }
     }
 }
@@ -124,48 +143,71 @@ datapacks_set_t SimulationDataManager::getEngineDataPacks(const std::string & en
 {
     datapacks_set_t dataPacks;
 
-    for(auto dataPack = this->_transceiverPool.begin(); dataPack != this->_transceiverPool.end(); dataPack++)
-    {
-        if(dataPack->get()->id().EngineName == engineName)
-        {
-            dataPacks.insert(*dataPack);
-        }
-    }
-
-    for(auto dataPack = this->_externalPool.begin(); dataPack != this->_externalPool.end(); dataPack++)
-    {
-        if(dataPack->get()->id().EngineName == engineName)
-        {
-            dataPacks.insert(*dataPack);
-        }
-    }
+    // DataPacks from the Transceiver pool take precedence over DataPacks from the External pool
+    const auto insert = [&dataPacks] (const DataPackInterfaceConstSharedPtr &dataPack) {
+        dataPacks.insert(dataPack);
+    };
+    this->_transceiverPool.forEachOfEngine(engineName, insert);
+    this->_externalPool.forEachOfEngine(engineName, insert);
 
     return dataPacks;
 }
 
 
-datapacks_set_t SimulationDataManager::getTransceiverDataPacks() const
+datapacks_set_t SimulationDataManager::getUpdatedEngineDataPacks(const std::string & engineName)
 {
-    datapacks_set_t dataPacks = this->_enginePool;
-    dataPacks.insert(this->_preprocessingPool.begin(), this->_preprocessingPool.end());
+    auto &sentVersions = this->_sentVersions[engineName];
+    datapacks_set_t dataPacks;
+
+    // A DataPack is sent if it has been updated in any of the pools
+    // DataPacks from the Transceiver pool take precedence over DataPacks from the External pool
+    this->_transceiverPool.forEachUpdatedOfEngine(engineName, sentVersions.first, [&dataPacks] (const DataPackInterfaceConstSharedPtr &dataPack) {
+        dataPacks.insert(dataPack);
+    });
+    this->_externalPool.forEachUpdatedOfEngine(engineName, sentVersions.second, [&] (const DataPackInterfaceConstSharedPtr &dataPack) {
+        const auto &transceiverDataPack = this->_transceiverPool.find(*dataPack);
+        dataPacks.insert(transceiverDataPack != nullptr ? transceiverDataPack : dataPack);
+    });
+
+    sentVersions = std::make_pair(this->_transceiverPool.version(), this->_externalPool.version());
 
     return dataPacks;
 }
 
 
+datapacks_set_t SimulationDataManager::getTransceiverDataPacks() const
+{
+    return mergePools({&this->_enginePool, &this->_preprocessingPool});
+}
+
+
 datapacks_set_t SimulationDataManager::getPreprocessingDataPacks() const
 {
-    return this->_enginePool;
+    return this->_enginePool.toSet();
 }
 
 
 datapacks_set_t SimulationDataManager::getStatusDataPacks() const
 {
-    datapacks_set_t dataPacks = this->_enginePool;
-    dataPacks.insert(this->_preprocessingPool.begin(), this->_preprocessingPool.end());
-    dataPacks.insert(this->_transceiverPool.begin(), this->_transceiverPool.end());
+    return mergePools({&this->_enginePool, &this->_preprocessingPool, &this->_transceiverPool});
+}
 
-    return dataPacks;
+
+DataPacksView SimulationDataManager::getTransceiverDataPacksView() const
+{
+    return DataPacksView({&this->_enginePool, &this->_preprocessingPool});
+}
+
+
+DataPacksView SimulationDataManager::getPreprocessingDataPacksView() const
+{
+    return DataPacksView({&this->_enginePool});
+}
+
+
+DataPacksView SimulationDataManager::getStatusDataPacksView() const
+{
+    return DataPacksView({&this->_enginePool, &this->_preprocessingPool, &this->_transceiverPool});
 }
 
 
@@ -25,6 +25,8 @@
 
 
 #include "nrp_general_library/transceiver_function/function_manager.h"
+#include "nrp_general_library/datapack_interface/datapacks_view.h"
+#include "nrp_simulation/datapack_handle/trajectory_store.h"
 #include "nrp_protobuf/nrp_server.grpc.pb.h"
 
 
@@ -42,11 +44,13 @@
  * - Trajectory for DataPacks coming from the Status Function
  *
  * The first four pools are meant to store the most recent simulation data coming from various sources.
- * They are implemented as sets, so he DataPacks stored in these pools are overwritten
- * (updated) whenever a new DataPack with matching ID is inserted.
+ * They are implemented as DataPackPools, which index DataPacks by the DataPackRegistry handle of their IDs,
+ * so the DataPacks stored in these pools are overwritten (updated) whenever a new DataPack with matching ID
+ * is inserted. The getters return sets of DataPacks, which is the format expected by the Functions.
  *
  * The Trajectory is used to store a history of observations produced by the Status Function.
- * It is implemented using a vector, so the order of DataPacks is preserved.
+ * It is implemented using a TrajectoryStore, so the order of DataPacks is preserved. It can be given a memory budget,
+ * in which case older DataPacks are spilled to disk.
  * The DataPacks from this pool is intended to be sent back to the Master Script whenever
  * the done flag coming from the Status Function is set.
  */
@@ -61,12 +65,17 @@ public:
     void pushToTrajectory(datapacks_vector_t dataPacks);
 
     /*!
-     * \brief Returns the trajectory vector
+     * \brief Returns the trajectory
      */
-    const datapacks_vector_t & getTrajectory() const;
+    const TrajectoryStore & getTrajectory() const;
 
     /*!
-     * \brief Clears the trajectory vector
+     * \brief Returns the trajectory, allowing to configure it
+     */
+    TrajectoryStore & getTrajectory();
+
+    /*!
+     * \brief Clears the trajectory
      */
     void clearTrajectory();
 
@@ -133,6 +142,16 @@ public:
      */
     datapacks_set_t getEngineDataPacks(const std::string & engineName) const;
 
+    /*!
+     * \brief Returns the DataPacks intended to be sent to the Engine with given name which have been updated
+     *        since the last call to this method for the same Engine
+     *
+     * The returned DataPacks are a subset of those returned by getEngineDataPacks(). A DataPack is returned if it
+     * has been updated in the Transceiver or External pools, even if it has been replaced by the same object.
+     * The first call for an Engine returns all its DataPacks.
+     */
+    datapacks_set_t getUpdatedEngineDataPacks(const std::string & engineName);
+
     /*!
      * \brief Returns a set of DataPacks that are intended to be accessed by the Transceiver Functions
      *
@@ -154,6 +173,30 @@ public:
      */
     datapacks_set_t getStatusDataPacks() const;
 
+    /*!
+     * \brief Returns a view over the DataPacks intended to be accessed by the Transceiver Functions
+     *
+     * The view contains the same DataPacks as getTransceiverDataPacks(), but chains the Engine and
+     * Preprocessing pools instead of copying them. It must not be used after these pools are updated.
+     */
+    DataPacksView getTransceiverDataPacksView() const;
+
+    /*!
+     * \brief Returns a view over the DataPacks intended to be accessed by the Preprocessing Functions
+     *
+     * The view contains the same DataPacks as getPreprocessingDataPacks(), without copying them.
+     * It must not be used after the Engine pool is updated.
+     */
+    DataPacksView getPreprocessingDataPacksView() const;
+
+    /*!
+     * \brief Returns a view over the DataPacks intended to be accessed by the Status Function
+     *
+     * The view contains the same DataPacks as getStatusDataPacks(), but chains the Engine, Preprocessing
+     * and Transceiver pools instead of copying them. It must not be used after these pools are updated.
+     */
+    DataPacksView getStatusDataPacksView() const;
+
     /*!
      * \brief Performs bookkeeping at start of the simulation iteration
      *
@@ -169,27 +212,32 @@ private:
     /*!
      * \brief DataPacks produced by the Preprocessing Functions
      */
-    datapacks_set_t _preprocessingPool;
+    DataPackPool _preprocessingPool;
 
     /*!
      * \brief DataPacks produced by the Transceiver Functions
      */
-    datapacks_set_t _transceiverPool;
+    DataPackPool _transceiverPool;
 
     /*!
      * \brief DataPacks produced by the Engines
      */
-    datapacks_set_t _enginePool;
+    DataPackPool _enginePool;
 
     /*!
      * \brief DataPacks produced by the Status Function
      */
-    datapacks_vector_t _trajectory;
+    TrajectoryStore _trajectory;
 
     /*!
      * \brief DataPacks produced by external processes, for example a Master Script
      */
-    datapacks_set_t _externalPool;
+    DataPackPool _externalPool;
+
+    /*!
+     * \brief Versions of the Transceiver and External pools when getUpdatedEngineDataPacks() was last called for each Engine
+     */
+    std::map<std::string, std::pair<uint64_t, uint64_t>> _sentVersions;
 };
 
 
@@ -21,6 +21,7 @@
 //
 
 #include "nrp_simulation/datapack_handle/tf_manager_handle.h"
+#include "nrp_general_library/datapack_interface/datapack_registry.h"
 
 
 void TFManagerHandle::loadDataPackFunctions(const jsonSharedPtr &simConfig)
@@ -67,7 +68,7 @@ void TFManagerHandle::loadStatusFunction(const jsonSharedPtr &simConfig)
 }
 
 
-void TFManagerHandle::init(const jsonSharedPtr &simConfig, const engine_interfaces_t &/*engines*/)
+void TFManagerHandle::init(const jsonSharedPtr &simConfig, const engine_interfaces_t &engines)
 {
     NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
@@ -76,26 +77,51 @@ void TFManagerHandle::init(const jsonSharedPtr &simConfig, const engine_interfac
     auto DataPackPassingPolicy = ((*simConfig)["DataPackPassingPolicy"] == "value") ? PASS_BY_VALUE : PASS_BY_REFERENCE;
     this->_functionManager.setDataPackPassingPolicy(DataPackPassingPolicy);
 
+    this->_sendUpdatedDataPacksOnly = simConfig->value("DataPackSendingPolicy", "all") == "updated";
+
     this->loadDataPackFunctions(simConfig);
     this->loadStatusFunction(simConfig);
+
+    // Datapacks used by the functions are registered at configuration time, the loop only looks up their handles
+    for(const auto &dataPackID : this->_functionManager.getRequestedDataPackIDs())
+    {
+        this->_requestedEngines.insert(dataPackID.EngineName);
+        DataPackRegistry::getInstance().intern(dataPackID);
+    }
+
+    // Datapacks returned by Transceiver Functions are only known after they are executed, only requested datapacks
+    // and linked functions can be checked
+    this->initDecoupledEngines(engines, [this] (const std::string &engineName) {
+        return this->_requestedEngines.count(engineName) || this->_functionManager.hasLinkedFunctions(engineName);
+    });
 }
 
 void TFManagerHandle::postEngineActivityHelper(const std::vector<EngineClientInterfaceSharedPtr> &engines)
+{
+    const auto engineDataPacks = this->getDataPacksFromEngines(engines);
+
+    for(const auto &dataPacks : engineDataPacks)
+        this->_simulationDataManager->pushToTrajectory(dataPacks);
+}
+
+std::vector<datapacks_vector_t> TFManagerHandle::getDataPacksFromEngines(const std::vector<EngineClientInterfaceSharedPtr> &engines)
 {
     const auto requestedDataPackIDs = this->_functionManager.getRequestedDataPackIDs();
 
-    for(auto &engine : engines)
-    {
+    std::vector<datapacks_vector_t> engineDataPacks(engines.size());
+
+    this->forEachEngineConcurrently(engines, [&] (size_t i) {
         try
         {
-            auto dataPacks = engine->getDataPacksFromEngine(requestedDataPackIDs);
-            this->_simulationDataManager->pushToTrajectory(dataPacks);
+            engineDataPacks[i] = engines[i]->getDataPacksFromEngine(requestedDataPackIDs);
         }
         catch(std::exception &e)
         {
-            throw NRPException::logCreate(e, "Failed to get datapacks from engine \"" + engine->engineName() + "\"");
+            throw NRPException::logCreate(e, "Failed to get datapacks from engine \"" + engines[i]->engineName() + "\"");
         }
-    }
+    });
+
+    return engineDataPacks;
 }
 
 void TFManagerHandle::postEngineInit(const std::vector<EngineClientInterfaceSharedPtr> &engines)
@@ -134,20 +160,21 @@ void TFManagerHandle::updateDataPacksFromEngines(const std::vector<EngineClientI
 {
     NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
-    const auto requestedDataPackIDs = this->_functionManager.getRequestedDataPackIDs();
+    // Datapacks are requested concurrently, but merged in engines order
+    const auto engineDataPacks = this->getDataPacksFromEngines(engines);
 
-    for(auto &engine : engines)
-    {
-        try
-        {
-            auto dataPacks = engine->getDataPacksFromEngine(requestedDataPackIDs);
-            this->_simulationDataManager->updateEnginePool(dataPacks);
-        }
-        catch(std::exception &e)
-        {
-            throw NRPException::logCreate(e, "Failed to get datapacks from engine \"" + engine->engineName() + "\"");
-        }
-    }
+    for(const auto &dataPacks : engineDataPacks)
+        this->_simulationDataManager->updateEnginePool(dataPacks);
+}
+
+void TFManagerHandle::preprocess(const std::vector<EngineClientInterfaceSharedPtr> &engines)
+{
+    NRP_LOGGER_TRACE("{} called", __FUNCTION__);
+
+    this->_functionManager.setSimulationTime(this->_simulationTime);
+    this->_functionManager.setSimulationIteration(this->_simulationIteration);
+
+    executePreprocessingFunctions(this->_functionManager, engines, this->_simulationDataManager->getPreprocessingDataPacksView());
 }
 
 void TFManagerHandle::compute(const std::vector<EngineClientInterfaceSharedPtr> &engines)
@@ -157,10 +184,9 @@ void TFManagerHandle::compute(const std::vector<EngineClientInterfaceSharedPtr>
     this->_functionManager.setSimulationTime(this->_simulationTime);
     this->_functionManager.setSimulationIteration(this->_simulationIteration);
 
-    executePreprocessingFunctions(this->_functionManager, engines, this->_simulationDataManager->getPreprocessingDataPacks());
-    executeTransceiverFunctions  (this->_functionManager, engines, this->_simulationDataManager->getTransceiverDataPacks());
+    executeTransceiverFunctions(this->_functionManager, engines, this->_simulationDataManager->getTransceiverDataPacksView());
 
-    auto statusTuple = this->_functionManager.executeStatusFunction(this->_simulationDataManager->getStatusDataPacks());
+    auto statusTuple = this->_functionManager.executeStatusFunction(this->_simulationDataManager->getStatusDataPacksView());
 
     // Extract the 'done' flag from the returned tuple
 
@@ -175,23 +201,41 @@ void TFManagerHandle::sendDataPacksToEngines(const std::vector<EngineClientInter
 {
     NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
+    std::vector<EngineClientInterfaceSharedPtr> receivingEngines;
+    std::vector<datapacks_set_t> engineDataPacks;
+    engineDataPacks.reserve(engines.size());
     for(const auto &engine : engines)
     {
+        if(this->_sendUpdatedDataPacksOnly)
+        {
+            // Engines keep the last datapacks they received. If none was updated there is nothing to send
+            auto dataPacks = this->_simulationDataManager->getUpdatedEngineDataPacks(engine->engineName());
+            if(dataPacks.empty())
+                continue;
+
+            engineDataPacks.push_back(std::move(dataPacks));
+        }
+        else
+            engineDataPacks.push_back(this->_simulationDataManager->getEngineDataPacks(engine->engineName()));
+
+        receivingEngines.push_back(engine);
+    }
+
+    this->forEachEngineConcurrently(receivingEngines, [&] (size_t i) {
         try
         {
-            auto dataPacks = this->_simulationDataManager->getEngineDataPacks(engine->engineName());
-            engine->sendDataPacksToEngine(dataPacks);
+            receivingEngines[i]->sendDataPacksToEngine(engineDataPacks[i]);
         }
         catch(std::exception &e)
         {
-            throw NRPException::logCreate(e, "Failed to send datapacks to engine \"" + engine->engineName() + "\"");
+            throw NRPException::logCreate(e, "Failed to send datapacks to engine \"" + receivingEngines[i]->engineName() + "\"");
         }
-    }
+    });
 }
 
 void TFManagerHandle::executePreprocessingFunctions(FunctionManager &tfManager,
                                                     const std::vector<EngineClientInterfaceSharedPtr> &engines,
-                                                    datapacks_set_t dataPacks)
+                                                    const DataPacksView &dataPacks)
 {
     NRP_LOGGER_TRACE("{} called", __FUNCTION__);
 
@@ -204,7 +248,7 @@ void TFManagerHandle::executePreprocessingFunctions(FunctionManager &tfManager,
 
 void TFManagerHandle::executeTransceiverFunctions(FunctionManager &tfManager,
                                                   const std::vector<EngineClientInterfaceSharedPtr> &engines,
-                                                  datapacks_set_t dataPacks)
+                                                  const DataPacksView &dataPacks)
 {
     for(const auto &engine : engines)
     {
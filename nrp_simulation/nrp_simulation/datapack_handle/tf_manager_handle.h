@@ -74,8 +74,31 @@ public:
 
     void updateDataPacksFromEngines(const std::vector<EngineClientInterfaceSharedPtr> &engines) override;
 
+    /*!
+     * \brief Executes the Preprocessing Functions linked to the given engines
+     *
+     * Preprocessing Functions can only access datapacks from their linked engine, hence they can be
+     * executed as soon as this engine has completed its step
+     *
+     * \param engines Engines which have completed their step
+     */
+    void preprocess(const std::vector<EngineClientInterfaceSharedPtr> &engines) override;
+
+    /*!
+     * \brief Executes the Transceiver Functions linked to the given engines and the Status Function
+     *
+     * \param engines Engines that are been synchronize in the current loop
+     */
     void compute(const std::vector<EngineClientInterfaceSharedPtr> &engines) override;
 
+    /*!
+     * \brief Sends to each engine the datapacks returned for it by the Transceiver Functions and the Master Script
+     *
+     * If the "DataPackSendingPolicy" parameter is set to "updated", only the datapacks updated since they were
+     * last sent to the engine are sent, and engines without updated datapacks are skipped.
+     *
+     * \param engines Engines that are been synchronize in the current loop
+     */
     void sendDataPacksToEngines(const std::vector<EngineClientInterfaceSharedPtr> &engines) override;
 
 private:
@@ -88,7 +111,7 @@ private:
      */
     void executePreprocessingFunctions(FunctionManager &functionManager,
                                        const std::vector<EngineClientInterfaceSharedPtr> &engines,
-                                       datapacks_set_t dataPacks);
+                                       const DataPacksView &dataPacks);
 
     /*!
      * \brief Execute TransceiverFunctions for each engine
@@ -98,7 +121,7 @@ private:
      */
     void executeTransceiverFunctions(FunctionManager &functionManager,
                                      const std::vector<EngineClientInterfaceSharedPtr> &engines,
-                                     datapacks_set_t dataPacks);
+                                     const DataPacksView &dataPacks);
 
     /*!
      * \brief Loads all DataPack Processing Functions defined in the config
@@ -117,8 +140,22 @@ private:
      */
     void postEngineActivityHelper(const std::vector<EngineClientInterfaceSharedPtr> &engines);
 
+    /*!
+     * \brief Requests the datapacks used by the DataPack Processing Functions from engines concurrently
+     *
+     * \param engines Engines from which datapacks are requested
+     * \return Datapacks returned by each engine, in the same order as engines
+     */
+    std::vector<datapacks_vector_t> getDataPacksFromEngines(const std::vector<EngineClientInterfaceSharedPtr> &engines);
+
     /*! \brief  FunctionManager handling datapack operations */
     FunctionManager _functionManager;
+
+    /*! \brief If true, only datapacks updated since they were last sent are sent to engines */
+    bool _sendUpdatedDataPacksOnly = false;
+
+    /*! \brief Names of the engines from which datapacks are requested by the loaded functions */
+    std::set<std::string> _requestedEngines;
 };
 
 #endif // TF_MANAGER_HANDLE_H
@@ -0,0 +1,200 @@
+/*
+ * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#include "nrp_simulation/datapack_handle/trajectory_store.h"
+#include "nrp_general_library/utils/nrp_exceptions.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/*! \brief Initial size of the spill file */
+static constexpr size_t SPILL_FILE_MIN_CAPACITY = 1 << 20;
+
+
+TrajectoryStore::~TrajectoryStore()
+{
+    this->closeSpillFile();
+}
+
+
+void TrajectoryStore::setMemoryBudget(size_t memoryBudget, const std::string &spillDirectory)
+{
+    this->_memoryBudget = memoryBudget;
+    this->_spillDirectory = spillDirectory;
+}
+
+
+void TrajectoryStore::setSerializer(serializer_t serializer)
+{
+    this->_serializer = std::move(serializer);
+}
+
+
+void TrajectoryStore::push(const datapacks_vector_t &dataPacks)
+{
+    this->_inMemory.insert(this->_inMemory.end(), dataPacks.begin(), dataPacks.end());
+
+    if(this->_memoryBudget > 0 && this->_serializer && this->_inMemory.size() > this->_memoryBudget)
+        this->spill();
+}
+
+
+void TrajectoryStore::clear()
+{
+    this->_inMemory.clear();
+    this->closeSpillFile();
+}
+
+
+void TrajectoryStore::moveTo(TrajectoryStore &other)
+{
+    other.clear();
+
+    other._inMemory = std::move(this->_inMemory);
+    this->_inMemory.clear();
+
+    // The spill file of 'other' is closed, so this store is left without spill file
+    std::swap(this->_spillFd, other._spillFd);
+    std::swap(this->_spillMap, other._spillMap);
+    std::swap(this->_spillCapacity, other._spillCapacity);
+    std::swap(this->_spillSize, other._spillSize);
+    std::swap(this->_numSpilled, other._numSpilled);
+}
+
+
+void TrajectoryStore::forEach(const std::function<void(std::string_view)> &onSpilled,
+                              const std::function<void(const DataPackInterfaceConstSharedPtr &)> &onInMemory) const
+{
+    size_t offset = 0;
+    while(offset < this->_spillSize)
+    {
+        uint32_t length;
+        std::memcpy(&length, this->_spillMap + offset, sizeof(length));
+        offset += sizeof(length);
+
+        onSpilled(std::string_view(this->_spillMap + offset, length));
+        offset += length;
+    }
+
+    for(const auto &dataPack : this->_inMemory)
+        onInMemory(dataPack);
+}
+
+
+void TrajectoryStore::spill()
+{
+    this->openSpillFile();
+
+    // Spill the oldest half of the budget at once, so that the DataPacks kept in memory aren't shifted on every push
+    const size_t numToSpill = this->_inMemory.size() - this->_memoryBudget / 2;
+    for(size_t i = 0; i < numToSpill; ++i)
+    {
+        const auto record = this->_serializer(*this->_inMemory[i]);
+        if(record.empty())
+            continue;
+
+        this->appendRecord(record);
+        ++this->_numSpilled;
+    }
+
+    this->_inMemory.erase(this->_inMemory.begin(), this->_inMemory.begin() + static_cast<std::ptrdiff_t>(numToSpill));
+}
+
+
+void TrajectoryStore::appendRecord(const std::string &record)
+{
+    const uint32_t length = static_cast<uint32_t>(record.size());
+    const size_t requiredSize = this->_spillSize + sizeof(length) + record.size();
+
+    if(requiredSize > this->_spillCapacity)
+    {
+        size_t newCapacity = std::max(this->_spillCapacity, SPILL_FILE_MIN_CAPACITY);
+        while(newCapacity < requiredSize)
+            newCapacity *= 2;
+
+        if(this->_spillMap != nullptr)
+            munmap(this->_spillMap, this->_spillCapacity);
+
+        if(ftruncate(this->_spillFd, static_cast<off_t>(newCapacity)) != 0)
+            throw NRPException::logCreate("Failed to grow the trajectory spill file: " + std::string(std::strerror(errno)));
+
+        void *map = mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, this->_spillFd, 0);
+        if(map == MAP_FAILED)
+        {
+            this->_spillMap = nullptr;
+            this->_spillCapacity = 0;
+            throw NRPException::logCreate("Failed to map the trajectory spill file: " + std::string(std::strerror(errno)));
+        }
+
+        this->_spillMap = static_cast<char *>(map);
+        this->_spillCapacity = newCapacity;
+    }
+
+    std::memcpy(this->_spillMap + this->_spillSize, &length, sizeof(length));
+    std::memcpy(this->_spillMap + this->_spillSize + sizeof(length), record.data(), record.size());
+    this->_spillSize = requiredSize;
+}
+
+
+void TrajectoryStore::openSpillFile()
+{
+    if(this->_spillFd >= 0)
+        return;
+
+    const std::filesystem::path directory = this->_spillDirectory.empty() ?
+            std::filesystem::temp_directory_path() : std::filesystem::path(this->_spillDirectory);
+    std::string fileName = (directory / "nrp_trajectory_XXXXXX").string();
+
+    this->_spillFd = mkstemp(fileName.data());
+    if(this->_spillFd < 0)
+        throw NRPException::logCreate("Failed to create the trajectory spill file in \"" + directory.string() + "\": " +
+                                      std::string(std::strerror(errno)));
+
+    // The file is only accessed through the descriptor, unlinking it ensures that it is removed on exit
+    unlink(fileName.c_str());
+}
+
+
+void TrajectoryStore::closeSpillFile()
+{
+    if(this->_spillMap != nullptr)
+        munmap(this->_spillMap, this->_spillCapacity);
+
+    if(this->_spillFd >= 0)
+        close(this->_spillFd);
+
+    this->_spillMap = nullptr;
+    this->_spillFd = -1;
+    this->_spillCapacity = 0;
+    this->_spillSize = 0;
+    this->_numSpilled = 0;
+}
+
+// EOF
@@ -0,0 +1,188 @@
+/*
+ * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#ifndef TRAJECTORY_STORE_H
+#define TRAJECTORY_STORE_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "nrp_general_library/datapack_interface/datapack_interface.h"
+
+
+/*!
+ * \brief Stores the trajectory, ie. the history of DataPacks produced by the Status Function
+ *
+ * By default, the whole trajectory is kept in memory. When a memory budget and a serializer are set, at most
+ * 'memoryBudget' DataPacks are kept in memory. When the budget is exceeded, the oldest half of the DataPacks
+ * kept in memory is serialized and appended to a memory-mapped spill file. The spill file is created in the
+ * spill directory and unlinked immediately, so it is removed by the OS when the store is destroyed.
+ *
+ * The order of the DataPacks is preserved: spilled DataPacks always precede the DataPacks kept in memory.
+ */
+class TrajectoryStore
+{
+    public:
+
+        /*!
+         * \brief Function serializing a DataPack before spilling it to disk.
+         *
+         * An empty result means that the DataPack can't be serialized, in which case it is dropped
+         */
+        using serializer_t = std::function<std::string(const DataPackInterface &)>;
+
+        TrajectoryStore() = default;
+        ~TrajectoryStore();
+
+        TrajectoryStore(const TrajectoryStore &) = delete;
+        TrajectoryStore &operator=(const TrajectoryStore &) = delete;
+
+        /*!
+         * \brief Sets the maximum number of DataPacks kept in memory and the directory in which the spill file is created
+         *
+         * \param memoryBudget  Maximum number of DataPacks kept in memory. Zero means that the budget is unlimited
+         * \param spillDirectory Directory of the spill file. If empty, the system temporary directory is used
+         */
+        void setMemoryBudget(size_t memoryBudget, const std::string &spillDirectory = "");
+
+        /*!
+         * \brief Sets the function used to serialize spilled DataPacks. DataPacks are not spilled until it is set
+         */
+        void setSerializer(serializer_t serializer);
+
+        /*!
+         * \brief Appends DataPacks to the trajectory, spilling older DataPacks if the memory budget is exceeded
+         */
+        void push(const datapacks_vector_t &dataPacks);
+
+        /*!
+         * \brief Removes all DataPacks from the trajectory. The spill file is closed, which releases its disk space
+         */
+        void clear();
+
+        /*!
+         * \brief Moves all DataPacks of the trajectory, including spilled ones, to 'other', leaving this one empty
+         *
+         * The DataPacks previously stored in 'other' are removed. The memory budget and serializer of both stores are
+         * left unchanged
+         */
+        void moveTo(TrajectoryStore &other);
+
+        /*!
+         * \brief Returns the number of DataPacks in the trajectory, including spilled ones
+         */
+        size_t size() const
+        { return this->_numSpilled + this->_inMemory.size(); }
+
+        /*!
+         * \brief Returns the number of DataPacks spilled to disk
+         */
+        size_t spilledSize() const
+        { return this->_numSpilled; }
+
+        /*!
+         * \brief Returns the DataPacks kept in memory, ie. the most recent part of the trajectory
+         */
+        const datapacks_vector_t &inMemory() const
+        { return this->_inMemory; }
+
+        /*!
+         * \brief Iterates over the trajectory in order
+         *
+         * \param onSpilled  Called with the serialized form of every spilled DataPack
+         * \param onInMemory Called with every DataPack kept in memory
+         */
+        void forEach(const std::function<void(std::string_view)> &onSpilled,
+                     const std::function<void(const DataPackInterfaceConstSharedPtr &)> &onInMemory) const;
+
+    private:
+
+        /*!
+         * \brief Serializes the oldest DataPacks kept in memory and appends them to the spill file
+         */
+        void spill();
+
+        /*!
+         * \brief Appends a length-prefixed record to the spill file, growing the file and its mapping if needed
+         */
+        void appendRecord(const std::string &record);
+
+        /*!
+         * \brief Creates the spill file and maps it, if it isn't open yet
+         */
+        void openSpillFile();
+
+        /*!
+         * \brief Unmaps and closes the spill file
+         */
+        void closeSpillFile();
+
+        /*!
+         * \brief DataPacks kept in memory
+         */
+        datapacks_vector_t _inMemory;
+
+        /*!
+         * \brief Maximum number of DataPacks kept in memory, zero if unlimited
+         */
+        size_t _memoryBudget = 0;
+
+        /*!
+         * \brief Directory in which the spill file is created
+         */
+        std::string _spillDirectory;
+
+        /*!
+         * \brief Function used to serialize spilled DataPacks
+         */
+        serializer_t _serializer;
+
+        /*!
+         * \brief File descriptor of the spill file, -1 if not open
+         */
+        int _spillFd = -1;
+
+        /*!
+         * \brief Mapping of the spill file
+         */
+        char *_spillMap = nullptr;
+
+        /*!
+         * \brief Size of the spill file and its mapping
+         */
+        size_t _spillCapacity = 0;
+
+        /*!
+         * \brief Number of bytes written to the spill file
+         */
+        size_t _spillSize = 0;
+
+        /*!
+         * \brief Number of DataPacks stored in the spill file
+         */
+        size_t _numSpilled = 0;
+};
+
+#endif // TRAJECTORY_STORE_H
+
+// EOF
@@ -0,0 +1,71 @@
+//
+// NRP Core - Backend infrastructure to synchronize simulations
+//
+// Copyright 2020-2023 NRP Team
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// This project has received funding from the European Union’s Horizon 2020
+// Framework Programme for Research and Innovation under the Specific Grant
+// Agreement No. 945539 (Human Brain Project SGA3).
+//
+
+#include "nrp_simulation/simulation/engine_completion_queue.h"
+
+void EngineCompletionQueue::push(const EngineClientInterface *engine)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_completedEngines.insert(engine);
+    }
+
+    this->_cv.notify_all();
+}
+
+EngineClientInterfaceSharedPtr EngineCompletionQueue::popAny(std::vector<EngineClientInterfaceSharedPtr> &engines, clock_t::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    auto completedEngine = engines.end();
+    auto findCompleted = [&] () {
+        for(completedEngine = engines.begin(); completedEngine != engines.end(); ++completedEngine)
+        {
+            if(this->_completedEngines.count(completedEngine->get()))
+                return true;
+        }
+
+        return false;
+    };
+
+    if(deadline == clock_t::time_point::max())
+        this->_cv.wait(lock, findCompleted);
+    else if(!this->_cv.wait_until(lock, deadline, findCompleted))
+        return nullptr;
+
+    auto engine = *completedEngine;
+    this->_completedEngines.erase(engine.get());
+    engines.erase(completedEngine);
+
+    return engine;
+}
+
+void EngineCompletionQueue::observe(const EngineCompletionQueue::shared_ptr &queue, const EngineClientInterfaceSharedPtr &engine)
+{
+    // Keep only a weak reference, the engines may outlive the queue
+    std::weak_ptr<EngineCompletionQueue> weakQueue(queue);
+
+    engine->setStepCompletionCallback([weakQueue] (const EngineClientInterface *completedEngine) {
+        if(auto queue = weakQueue.lock())
+            queue->push(completedEngine);
+    });
+}
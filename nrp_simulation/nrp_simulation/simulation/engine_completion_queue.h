@@ -0,0 +1,86 @@
+/* * NRP Core - Backend infrastructure to synchronize simulations
+ *
+ * Copyright 2020-2023 NRP Team
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This project has received funding from the European Union’s Horizon 2020
+ * Framework Programme for Research and Innovation under the Specific Grant
+ * Agreement No. 945539 (Human Brain Project SGA3).
+ */
+
+#ifndef ENGINE_COMPLETION_QUEUE_H
+#define ENGINE_COMPLETION_QUEUE_H
+
+#include "nrp_general_library/engine_interfaces/engine_client_interface.h"
+#include "nrp_general_library/utils/ptr_templates.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+/*!
+ * \brief Collects notifications from engines which have completed their current loop step
+ *
+ * Engines are registered as completed either from the worker threads running their loop steps, through
+ * EngineClientInterface::setStepCompletionCallback(), or directly by the simulation loop for engines which
+ * are idle without running a step. The simulation loop can then wait for the first engine of a given batch
+ * which is ready to be processed.
+ */
+class EngineCompletionQueue
+        : public PtrTemplates<EngineCompletionQueue>
+{
+    public:
+
+        using clock_t = std::chrono::steady_clock;
+
+        /*!
+         * \brief Marks an engine as completed and wakes up waiting threads
+         * \param engine Completed engine
+         */
+        void push(const EngineClientInterface *engine);
+
+        /*!
+         * \brief Blocks until one of the given engines has been marked as completed or until deadline is reached
+         *
+         * The returned engine is removed both from the queue and from the engines vector.
+         *
+         * \param engines Engines to wait for
+         * \param deadline Point in time after which the function returns without waiting further. If set to
+         *                 clock_t::time_point::max() the function waits indefinitely
+         * \return The completed engine, or nullptr if deadline was reached before any of the engines completed
+         */
+        EngineClientInterfaceSharedPtr popAny(std::vector<EngineClientInterfaceSharedPtr> &engines, clock_t::time_point deadline);
+
+        /*!
+         * \brief Registers the queue as step completion callback of the given engine
+         * \param queue Queue which will be notified
+         * \param engine Engine to be observed
+         */
+        static void observe(const EngineCompletionQueue::shared_ptr &queue, const EngineClientInterfaceSharedPtr &engine);
+
+    private:
+
+        std::mutex _mutex;
+        std::condition_variable _cv;
+
+        /*!
+         * \brief Engines which have completed their step and haven't been processed yet
+         */
+        std::set<const EngineClientInterface*> _completedEngines;
+};
+
+using EngineCompletionQueueSharedPtr = EngineCompletionQueue::shared_ptr;
+
+#endif // ENGINE_COMPLETION_QUEUE_H
@@ -25,11 +25,13 @@
 #include "nrp_general_library/datapack_interface/datapack.h"
 #include "nrp_general_library/utils/python_error_handler.h"
 #include "nrp_general_library/utils/time_utils.h"
+#include "nrp_general_library/utils/thread_pool.h"
 
 #include "nrp_simulation/datapack_handle/tf_manager_handle.h"
 #include "nrp_simulation/datapack_handle/computational_graph_handle.h"
 
 #include <iostream>
+#include <chrono>
 
 // Helper function which reads simulation config and returns the correct DataPackProcessor
 static DataPackProcessor* makeHandleFromConfig(jsonSharedPtr config, SimulationDataManager * simulationDataManager)
@@ -62,6 +64,36 @@ static void runLoopStepAsyncGet(EngineClientInterfaceSharedPtr engine)
     }
 }
 
+// Waits for the first engine in pendingEngines to complete its step, removes it from pendingEngines and returns it
+static EngineClientInterfaceSharedPtr waitForAnyEngine(EngineCompletionQueue &completionQueue,
+                                                       std::vector<EngineClientInterfaceSharedPtr> &pendingEngines,
+                                                       EngineCompletionQueue::clock_t::time_point waitStart)
+{
+    // Stop waiting when the first engine timeout is reached
+    auto deadline = EngineCompletionQueue::clock_t::time_point::max();
+    EngineClientInterfaceSharedPtr timedOutEngine;
+    for(const auto &engine : pendingEngines)
+    {
+        const SimulationTime timeout = toSimulationTimeFromSeconds(engine->engineConfig().at("EngineCommandTimeout"));
+        const auto engineDeadline = waitStart + std::chrono::duration_cast<EngineCompletionQueue::clock_t::duration>(timeout);
+
+        if(timeout > SimulationTime::zero() && engineDeadline < deadline)
+        {
+            deadline = engineDeadline;
+            timedOutEngine = engine;
+        }
+    }
+
+    auto engine = completionQueue.popAny(pendingEngines, deadline);
+    if(engine == nullptr)
+    {
+        throw NRPException::logCreate("Error while executing runLoopStep in engine \"" + timedOutEngine->engineName()
+        + "\". The Engine didn't respond before timeout. Check the engine logs for errors.");
+    }
+
+    return engine;
+}
+
 
 FTILoop::FTILoop(jsonSharedPtr config, DataPackProcessor::engine_interfaces_t engines, SimulationDataManager * simulationDataManager)
     : _config(config),
@@ -69,6 +101,11 @@ FTILoop::FTILoop(jsonSharedPtr config, DataPackProcessor::engine_interfaces_t en
       _devHandler(makeHandleFromConfig(config, simulationDataManager))
 {
     NRP_LOGGER_TRACE("{} called", __FUNCTION__);
+
+    if(config->value("FTILoopSyncMode", "barrier") == "completion")
+        this->_completionQueue.reset(new EngineCompletionQueue());
+
+    this->_runAhead = config->value("FTILoopRunAhead", false);
 }
 
 void FTILoop::initLoop()
@@ -78,18 +115,40 @@ void FTILoop::initLoop()
     // Init DataPack handle
     this->_devHandler->init(_config, _engines);
 
-    // Init Engine
-    for(const auto &engine : this->_engines)
+    // Init Engines. Engines are independent from each other at this point, they are initialized concurrently
+    const auto initStart = std::chrono::steady_clock::now();
+    auto initializeEngine = [this, &initStart] (size_t i)
     {
+        const auto &engine = this->_engines[i];
+
         try
         {
-            this->_engineQueue.emplace(0, engine);
             engine->initialize();
         }
         catch(std::exception &e)
         {
             throw NRPException::logCreate(e, "Failed to initialize engine \"" + engine->engineName() + "\"");
         }
+
+        const std::chrono::duration<double> initTime = std::chrono::steady_clock::now() - initStart;
+        NRPLogger::info("Engine \"{}\" initialized after {:.3f} s", engine->engineName(), initTime.count());
+    };
+
+    if(this->_engines.size() > 1)
+        ThreadPool(this->_engines.size() - 1).parallelFor(this->_engines.size(), initializeEngine);
+    else if(!this->_engines.empty())
+        initializeEngine(0);
+
+    for(const auto &engine : this->_engines)
+    {
+        this->_engineQueue.emplace(0, engine);
+
+        // Engines haven't started any step yet, they can be processed right away
+        if(this->_completionQueue)
+        {
+            EngineCompletionQueue::observe(this->_completionQueue, engine);
+            this->_completionQueue->push(engine.get());
+        }
     }
 
     this->_devHandler->postEngineInit(this->_engines);
@@ -196,21 +255,42 @@ void FTILoop::runLoop(SimulationTime runLoopTime)
 
         NRP_LOG_TIME("step_start");
 
-        // Wait for engines which will be processed to complete execution
-        for(const auto &engine : idleEngines)
+        this->_devHandler->setSimulationTime(this->_simTime);
+        this->_devHandler->setSimulationIteration(this->_simIteration);
+
+        if(this->_completionQueue)
         {
-            runLoopStepAsyncGet(engine);
-        }
+            // Retrieve datapacks and execute preprocessing functions of each engine as soon as it completes its step
+            std::vector<EngineClientInterfaceSharedPtr> pendingEngines(idleEngines);
+            const auto waitStart = EngineCompletionQueue::clock_t::now();
+            while(!pendingEngines.empty())
+            {
+                const auto engine = waitForAnyEngine(*this->_completionQueue, pendingEngines, waitStart);
+                runLoopStepAsyncGet(engine);
+                this->_devHandler->engineDataPackCycle({engine});
+            }
 
-        NRP_LOG_TIME("after_wait_for_engines");
+            NRP_LOG_TIME("after_wait_for_engines");
 
-        this->_devHandler->setSimulationTime(this->_simTime);
-        this->_devHandler->setSimulationIteration(this->_simIteration);
+            // Execute TFs once all engines have been processed
+            // Send tf output datapacks to corresponding engines
+            this->_devHandler->barrierDataPackCycle(idleEngines);
+        }
+        else
+        {
+            // Wait for engines which will be processed to complete execution
+            for(const auto &engine : idleEngines)
+            {
+                runLoopStepAsyncGet(engine);
+            }
+
+            NRP_LOG_TIME("after_wait_for_engines");
 
-        // Retrieve datapacks required by TFs from completed engines
-        // Execute preprocessing TFs and TFs sequentially
-        // Send tf output datapacks to corresponding engines
-        this->_devHandler->datapackCycle(idleEngines);
+            // Retrieve datapacks required by TFs from completed engines
+            // Execute preprocessing TFs and TFs sequentially
+            // Send tf output datapacks to corresponding engines
+            this->_devHandler->datapackCycle(idleEngines);
+        }
 
         // Restart engines
         for(auto &engine : idleEngines)
@@ -219,12 +299,14 @@ void FTILoop::runLoop(SimulationTime runLoopTime)
 
             if(trueRunTime >= SimulationTime::zero())
             {
+                const auto runAheadTime = this->runAheadTime(engine, loopStopTime);
+
                 try
                 {
                     // Execute run loop step in a worker thread
                     // The results will be checked before running the transceiver functions
 
-                    engine->runLoopStepAsync(trueRunTime);
+                    engine->runLoopStepAsync(trueRunTime + runAheadTime);
                 }
                 catch(std::exception &e)
                 {
@@ -232,7 +314,7 @@ void FTILoop::runLoop(SimulationTime runLoopTime)
                 }
 
                 // Reinsert engines into queue
-                this->_engineQueue.emplace(this->_simTime + engine->getEngineTimestep(), engine);
+                this->_engineQueue.emplace(this->_simTime + engine->getEngineTimestep() + runAheadTime, engine);
             }
             else
             {
@@ -243,6 +325,10 @@ void FTILoop::runLoop(SimulationTime runLoopTime)
 
                 // Wait for rest of simulation to catch up to engine
                 this->_engineQueue.emplace(engine->getEngineTime(), engine);
+
+                // The engine is not running a step, it can be processed right away next time
+                if(this->_completionQueue)
+                    this->_completionQueue->push(engine.get());
             }
 
             engine = nullptr;
@@ -256,6 +342,22 @@ void FTILoop::runLoop(SimulationTime runLoopTime)
     this->_simTime = loopStopTime;
 }
 
+SimulationTime FTILoop::runAheadTime(const EngineClientInterfaceSharedPtr &engine, SimulationTime loopStopTime) const
+{
+    const auto timestep = engine->getEngineTimestep();
+    const auto nextSyncTime = this->_simTime + timestep;
+
+    if(!this->_runAhead || timestep <= SimulationTime::zero() || nextSyncTime >= loopStopTime ||
+       !this->_devHandler->isEngineDecoupled(engine))
+        return SimulationTime::zero();
+
+    // Skip the steps which would complete before loopStopTime, the engine is synchronized again at the first
+    // step completing at or after loopStopTime, as it would be without skipping any step
+    const auto skippedSteps = (loopStopTime - nextSyncTime + timestep - SimulationTime(1)) / timestep;
+
+    return skippedSteps * timestep;
+}
+
 void FTILoop::waitForEngines()
 {
     // Wait for all engines to finish their last loop step
@@ -27,6 +27,7 @@
 #include "nrp_general_library/utils/json_schema_utils.h"
 
 #include "nrp_simulation/datapack_handle/datapack_handle.h"
+#include "nrp_simulation/simulation/engine_completion_queue.h"
 
 /*!
  * \brief Manages simulation loop. Runs physics and brain interface, and synchronizes them via Transfer Functions
@@ -73,6 +74,18 @@ class FTILoop
         {   return this->_simTime;  }
 
     private:
+        /*!
+         * \brief Returns the time an engine can run past its next step without being synchronized
+         *
+         * Only decoupled engines can run ahead, and only if run-ahead mode is enabled. They are synchronized
+         * again at the first step completing at or after loopStopTime.
+         *
+         * \param engine Engine which is being restarted
+         * \param loopStopTime Time at which the current runLoop call stops
+         * \return Multiple of the engine timestep to be added to its next step
+         */
+        SimulationTime runAheadTime(const EngineClientInterfaceSharedPtr &engine, SimulationTime loopStopTime) const;
+
         /*!
          * \brief Configuration of simulation
          */
@@ -102,6 +115,16 @@ class FTILoop
          */
         std::unique_ptr<DataPackProcessor> _devHandler;
 
+        /*!
+         * \brief Collects engines as they complete their steps. Only set if engines are processed in completion order
+         */
+        EngineCompletionQueueSharedPtr _completionQueue;
+
+        /*!
+         * \brief If true, decoupled engines run until the end of each runLoop call in a single step
+         */
+        bool _runAhead = false;
+
 
         friend class FTILoopTest_InitTFManager_Test;
 };
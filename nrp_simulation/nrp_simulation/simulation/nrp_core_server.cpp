@@ -27,6 +27,7 @@
 
 NrpCoreServer::NrpCoreServer(const std::string & address, std::shared_ptr<SimulationManager> && manager)
     : _lock(_mutex, std::defer_lock_t()),
+    _trajectoryService(this),
     _manager(std::move(manager))
 {
 
@@ -59,9 +60,23 @@ NrpCoreServer::NrpCoreServer(const std::string & address, std::shared_ptr<Simula
     }
 
 
+    // Set up the trajectory store. DataPacks exceeding the memory budget are spilled as serialized trajectory messages
+
+    const auto & simConfig = this->_manager->getSimulationConfig();
+    this->_streamTrajectory = simConfig->value("TrajectoryStreaming", false);
+
+    auto & trajectory = this->_manager->getSimulationDataManager().getTrajectory();
+    trajectory.setMemoryBudget(simConfig->value("TrajectoryMemoryBudget", 0u),
+                               simConfig->value("TrajectorySpillDirectory", std::string()));
+    trajectory.setSerializer([this] (const DataPackInterface & dataPack) {
+        NrpCore::TrajectoryMessage trajectoryMessage;
+        return this->setTrajectoryMessage(dataPack, &trajectoryMessage) ? trajectoryMessage.SerializeAsString() : std::string();
+    });
+
     grpc::ServerBuilder builder;
     builder.AddListeningPort(address, grpc::InsecureServerCredentials());
     builder.RegisterService(this);
+    builder.RegisterService(&this->_trajectoryService);
 
     this->_server = builder.BuildAndStart();
 }
@@ -215,49 +230,118 @@ grpc::Status NrpCoreServer::initialize(grpc::ServerContext * , const NrpCore::Em
 
 void NrpCoreServer::prepareTrajectory(NrpCore::Trajectory * trajectory)
 {
-    auto & trajectoryVector = this->_manager->getSimulationDataManager().getTrajectory();
+    auto & episodeTrajectory = this->_manager->getSimulationDataManager().getTrajectory();
+
+    // The trajectory will be requested by the client with the streaming call. It is set aside, so that the next
+    // episode starts with an empty trajectory. The trajectory of the previous episode is dropped if it wasn't requested
+    if(this->_streamTrajectory)
+    {
+        episodeTrajectory.moveTo(this->_finishedTrajectory);
+        return;
+    }
 
     unsigned trajectoryIndex = 0;
-    for(auto trajectoryElement = trajectoryVector.begin(); trajectoryElement != trajectoryVector.end(); trajectoryElement++)
+    this->forEachTrajectoryMessage(episodeTrajectory, [&] (NrpCore::TrajectoryMessage && trajectoryMessage) {
+        addTrajectoryMessage(trajectory, std::move(trajectoryMessage), trajectoryIndex++);
+    });
+
+    episodeTrajectory.clear();
+}
+
+
+bool NrpCoreServer::setTrajectoryMessage(const DataPackInterface & dataPack, NrpCore::TrajectoryMessage * trajectoryMessage)
+{
+    if(dataPack.type() == JsonDataPack::getType())
     {
-        if((**trajectoryElement).type() == JsonDataPack::getType())
-        {
-            NrpCore::TrajectoryMessage * trajectoryMessage = trajectory->add_jsontrajectorymessages();
-            const nlohmann::json & data = (dynamic_cast<const JsonDataPack *>((*trajectoryElement).get()))->getData();
-            NrpCore::JsonMessage strdata;
-            strdata.set_data(data.dump());
-
-            trajectoryMessage->set_dataindex(trajectoryIndex);
-            trajectoryMessage->mutable_data()->PackFrom(strdata);
-            trajectoryIndex++;
-        }
-        else
-        {
-            // We assume that it's a proto DataPack
-            NrpCore::TrajectoryMessage trajectoryMessage = NrpCore::TrajectoryMessage();
-            std::atomic<bool> isSet(false);
-            for(auto& mod : _protoOps) {
-                try {
-                    mod->setTrajectoryMessageFromInterface(*((*trajectoryElement).get()), &trajectoryMessage);
-                    isSet = true;
-                }
-                catch (NRPException &) {
-                    // this just means that the module couldn't process the request, try with the next one
-                }
-            }
+        const nlohmann::json & data = (dynamic_cast<const JsonDataPack &>(dataPack)).getData();
+        NrpCore::JsonMessage strdata;
+        strdata.set_data(data.dump());
 
-            if(isSet)
-            {
-                trajectoryMessage.set_dataindex(trajectoryIndex);
-                trajectory->add_prototrajectorymessages();
-                trajectory->mutable_prototrajectorymessages(trajectory->prototrajectorymessages_size() - 1)->CopyFrom(trajectoryMessage);
+        trajectoryMessage->mutable_data()->PackFrom(strdata);
+        return true;
+    }
+
+    // We assume that it's a proto DataPack
+    for(auto& mod : _protoOps) {
+        if(mod->trySetTrajectoryMessageFromInterface(dataPack, trajectoryMessage))
+            return true;
+    }
+
+    return false;
+}
+
+
+void NrpCoreServer::addTrajectoryMessage(NrpCore::Trajectory * trajectory, NrpCore::TrajectoryMessage && trajectoryMessage, unsigned index)
+{
+    trajectoryMessage.set_dataindex(index);
 
-                trajectoryIndex++;
+    if(trajectoryMessage.data().Is<NrpCore::JsonMessage>())
+        *trajectory->add_jsontrajectorymessages() = std::move(trajectoryMessage);
+    else
+        *trajectory->add_prototrajectorymessages() = std::move(trajectoryMessage);
+}
+
+
+void NrpCoreServer::forEachTrajectoryMessage(const TrajectoryStore & trajectory,
+                                             const std::function<void(NrpCore::TrajectoryMessage &&)> & fn)
+{
+    trajectory.forEach(
+        [&] (std::string_view serialized) {
+            NrpCore::TrajectoryMessage trajectoryMessage;
+            if(!trajectoryMessage.ParseFromArray(serialized.data(), static_cast<int>(serialized.size())))
+                throw NRPException::logCreate("Failed to read a trajectory message from the spill file");
+
+            fn(std::move(trajectoryMessage));
+        },
+        [&] (const DataPackInterfaceConstSharedPtr & dataPack) {
+            NrpCore::TrajectoryMessage trajectoryMessage;
+            if(this->setTrajectoryMessage(*dataPack, &trajectoryMessage))
+                fn(std::move(trajectoryMessage));
+        });
+}
+
+
+grpc::Status NrpCoreServer::getTrajectory(grpc::ServerContext * , const NrpCore::TrajectoryStreamRequest * request,
+                                          grpc::ServerWriter<NrpCore::Trajectory> * writer)
+{
+    // Holding the mutex ensures that the main thread isn't processing a request, and thus modifying the trajectory
+    std::unique_lock<std::mutex> lock(this->_mutex);
+
+    const unsigned chunkSize = request->chunksize() > 0 ? request->chunksize() : 1000;
+
+    NrpCore::Trajectory chunk;
+    unsigned trajectoryIndex = 0;
+    bool isWriterOpen = true;
+
+    try
+    {
+        this->forEachTrajectoryMessage(this->_finishedTrajectory, [&] (NrpCore::TrajectoryMessage && trajectoryMessage) {
+            if(!isWriterOpen)
+                return;
+
+            addTrajectoryMessage(&chunk, std::move(trajectoryMessage), trajectoryIndex++);
+
+            if(trajectoryIndex % chunkSize == 0)
+            {
+                isWriterOpen = writer->Write(chunk);
+                chunk.Clear();
             }
-        }
+        });
     }
+    catch(std::exception &e)
+    {
+        return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+    }
+
+    if(!isWriterOpen)
+        return grpc::Status(grpc::StatusCode::CANCELLED, "Client closed the trajectory stream");
+
+    if(trajectoryIndex % chunkSize != 0)
+        writer->Write(chunk);
+
+    this->_finishedTrajectory.clear();
 
-    this->_manager->getSimulationDataManager().clearTrajectory();
+    return grpc::Status::OK;
 }
 
 
@@ -25,9 +25,11 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 #include <grpcpp/grpcpp.h>
 
 #include "nrp_protobuf/nrp_server.grpc.pb.h"
+#include "nrp_protobuf/nrp_server_trajectory.grpc.pb.h"
 #include "nrp_simulation/simulation/simulation_manager.h"
 #include "nrp_protobuf/proto_ops/protobuf_ops.h"
 
@@ -134,10 +136,63 @@ private:
      * These lists will be assembled back into a single trajectory by the client, based on the
      * message indices assigned to each of the observations.
      *
+     * If "TrajectoryStreaming" is enabled in the simulation configuration, the trajectory is instead moved out of the
+     * SimulationDataManager, to be retrieved by the client with the getTrajectory streaming call. In both cases, the
+     * trajectory stored in the SimulationDataManager is empty afterwards.
+     *
      * \param trajectory Message that should be populated with the trajectory data
      */
     void prepareTrajectory(NrpCore::Trajectory * trajectory);
 
+    /*!
+     * \brief Converts a DataPack into a trajectory message
+     *
+     * \return False if the DataPack type isn't supported by any of the loaded protobuf libraries
+     */
+    bool setTrajectoryMessage(const DataPackInterface & dataPack, NrpCore::TrajectoryMessage * trajectoryMessage);
+
+    /*!
+     * \brief Appends a trajectory message to the JSON or proto list of the trajectory, depending on its content
+     */
+    static void addTrajectoryMessage(NrpCore::Trajectory * trajectory, NrpCore::TrajectoryMessage && trajectoryMessage, unsigned index);
+
+    /*!
+     * \brief Iterates over a trajectory, calling fn with the trajectory message of every element
+     */
+    void forEachTrajectoryMessage(const TrajectoryStore & trajectory,
+                                  const std::function<void(NrpCore::TrajectoryMessage &&)> & fn);
+
+    /*!
+     * \brief Streams the trajectory of the last finished episode to the client in chunks and clears it
+     */
+    grpc::Status getTrajectory(grpc::ServerContext * , const NrpCore::TrajectoryStreamRequest * request,
+                               grpc::ServerWriter<NrpCore::Trajectory> * writer);
+
+    /*!
+     * \brief Implementation of the optional NrpCoreTrajectoryService
+     *
+     * gRPC services can't be combined in a single class, so the trajectory service is registered as a separate
+     * object forwarding its calls to the owning NrpCoreServer
+     */
+    class TrajectoryService : public NrpCore::NrpCoreTrajectoryService::Service
+    {
+        public:
+
+            explicit TrajectoryService(NrpCoreServer * server)
+                : _server(server)
+            {}
+
+            grpc::Status getTrajectory(grpc::ServerContext * context, const NrpCore::TrajectoryStreamRequest * request,
+                                       grpc::ServerWriter<NrpCore::Trajectory> * writer) override
+            {
+                return this->_server->getTrajectory(context, request, writer);
+            }
+
+        private:
+
+            NrpCoreServer * _server;
+    };
+
     /*!
      * \brief Set content in rpc return message from SimulationManager RequestResult
      */
@@ -194,6 +249,15 @@ private:
     /*! \brief Pointer to the gRPC server class */
     std::unique_ptr<grpc::Server> _server;
 
+    /*! \brief Trajectory streaming service, registered together with this server */
+    TrajectoryService _trajectoryService;
+
+    /*! \brief Whether the trajectory is retrieved by the client with the getTrajectory streaming call */
+    bool _streamTrajectory = false;
+
+    /*! \brief Trajectory of the last finished episode, until it is retrieved with getTrajectory */
+    TrajectoryStore _finishedTrajectory;
+
     /*! \brief Type of the pending request */
     RequestType _requestType = RequestType::None;
 
@@ -181,6 +181,11 @@ SimulationDataManager & SimulationManager::getSimulationDataManager()
     return this->_simulationDataManager;
 }
 
+const jsonSharedPtr & SimulationManager::getSimulationConfig() const
+{
+    return this->_simConfig;
+}
+
 
 void SimulationManager::checkTransitionConstraints(std::vector<SimState> validSourceStates, std::string actionStr)
 {
@@ -132,6 +132,11 @@ public:
 
     SimulationDataManager & getSimulationDataManager();
 
+    /*!
+     * \brief returns the simulation configuration
+     */
+    const jsonSharedPtr & getSimulationConfig() const;
+
 protected:
 
     // Callback functions for the different simulation control requests.
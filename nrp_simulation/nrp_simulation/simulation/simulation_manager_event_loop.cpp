@@ -60,6 +60,7 @@ void EventLoopSimManager::initializeCB()
 
         auto execMode = ELoopConf.at("ExecutionMode") == "OutputDriven"
                 ? ComputationalGraph::ExecMode::OUTPUT_DRIVEN : ComputationalGraph::ExecMode::ALL_NODES;
+        auto numThreads = ELoopConf.at("ParallelThreads").get<size_t>();
 
         std::stringstream info_msg;
         info_msg << "Creating Event Loop with configuration: timestep=" << _timestep.count() << "(ms), timeout=" << _timeout.count() << "(ms)";
@@ -67,7 +68,7 @@ void EventLoopSimManager::initializeCB()
 
         // Create and initialize EventLoop
         this->_loop.reset(new EventLoop(this->_simConfig->at("ComputationalGraph"), _timestep, timestepWarn, execMode,
-                                        false, this->_simConfig->contains("ROSNode")));
+                                        false, this->_simConfig->contains("ROSNode"), numThreads));
 
         // If there are engines in the configuration, an FTILoop has to be run as well
         if(this->_simConfig->at("EngineConfigs").size() > 0) {
@@ -26,12 +26,14 @@
 #include "nrp_general_library/utils/nrp_exceptions.h"
 #include "nrp_simulation/config/cmake_conf.h"
 #include "nrp_general_library/utils/nrp_logger.h"
+#include "nrp_general_library/utils/thread_pool.h"
 
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <future>
 #include <filesystem>
+#include <chrono>
 
 
 FTILoopSimManager::FTILoopSimManager(const jsonSharedPtr &simulationConfig, const EngineLauncherManagerConstSharedPtr& engineLauncherManager,
@@ -178,10 +180,11 @@ FTILoop FTILoopSimManager::createSimLoop()
             throw std::invalid_argument(errMsg);
         }
 
-        // Create and launch engine
+        // Create engine and launch its process. Processes are forked sequentially, waiting for engines to be ready
+        // is done concurrently afterwards
         try
         {
-            engines.push_back(engineLauncher->launchEngine(engineConfig, _processLauncherManager->createProcessLauncher(this->_simConfig->at("ProcessLauncherType"))));
+            engines.push_back(engineLauncher->launchEngineProcess(engineConfig, _processLauncherManager->createProcessLauncher(this->_simConfig->at("ProcessLauncherType"))));
         }
         catch(std::exception &e)
         {
@@ -193,6 +196,29 @@ FTILoop FTILoopSimManager::createSimLoop()
             this->_timeStep = toSimulationTimeFromSeconds(engineConfig.at("EngineTimestep").get<double>());
         }
     }
+
+    // Wait for all engines to be ready
+    const auto launchStart = std::chrono::steady_clock::now();
+    auto connectToEngine = [&engines, &launchStart] (size_t i)
+    {
+        try
+        {
+            engines[i]->connectToEngine();
+        }
+        catch(std::exception &e)
+        {
+            throw NRPException::logCreate(e, "Failed to launch engine:  \"" + engines[i]->engineName() + "\"");
+        }
+
+        const std::chrono::duration<double> readyTime = std::chrono::steady_clock::now() - launchStart;
+        NRPLogger::info("Engine \"{}\" ready after {:.3f} s", engines[i]->engineName(), readyTime.count());
+    };
+
+    if(engines.size() > 1)
+        ThreadPool(engines.size() - 1).parallelFor(engines.size(), connectToEngine);
+    else if(!engines.empty())
+        connectToEngine(0);
+
     NRPLogger::debug("Simulation Timestep is: "+ std::to_string(fromSimulationTime<double, std::ratio<1>>(this->_timeStep)));
     return FTILoop(this->_simConfig, engines, &this->_simulationDataManager);
 }
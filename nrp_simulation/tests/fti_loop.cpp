@@ -22,6 +22,7 @@
 
 #include <gtest/gtest.h>
 #include <fstream>
+#include <mutex>
 
 #include "nrp_general_library/process_launchers/process_launcher_basic.h"
 #include "nrp_general_library/utils/python_interpreter_state.h"
@@ -37,6 +38,69 @@
 
 using namespace testing;
 
+namespace
+{
+    struct DelayedTestEngineConfigConst
+    {
+        static constexpr char EngineType[] = "delayed_test_engine";
+        static constexpr char EngineSchema[] = "json://nrp-core/engines/engine_base.json#EngineBase";
+    };
+
+    /*!
+     * \brief Engine whose steps take a fixed wall-clock time. It records the order in which datapacks are requested
+     *        from the engines sharing the same record
+     */
+    class DelayedTestEngine
+            : public EngineClient<DelayedTestEngine, DelayedTestEngineConfigConst::EngineSchema>
+    {
+    public:
+        struct Record
+        {
+            std::mutex lock;
+            std::vector<std::string> engineNames;
+        };
+
+        DelayedTestEngine(nlohmann::json &configHolder, std::chrono::milliseconds stepDelay, Record &record)
+                : EngineClient(configHolder, nullptr),
+                  _stepDelay(stepDelay),
+                  _record(record)
+        {}
+
+        void initialize() override
+        {}
+
+        void reset() override
+        {}
+
+        void shutdown() override
+        {}
+
+        const std::vector<std::string> engineProcStartParams() const override
+        { return std::vector<std::string>(); }
+
+        void sendDataPacksToEngine(const datapacks_set_t &) override
+        {}
+
+        SimulationTime runLoopStepCallback(SimulationTime timeStep) override
+        {
+            std::this_thread::sleep_for(this->_stepDelay);
+            return this->getEngineTime() + timeStep;
+        }
+
+        datapacks_vector_t getDataPacksFromEngine(const datapack_identifiers_set_t &) override
+        {
+            std::lock_guard<std::mutex> lock(this->_record.lock);
+            this->_record.engineNames.push_back(this->engineName());
+
+            return datapacks_vector_t();
+        }
+
+    private:
+        std::chrono::milliseconds _stepDelay;
+        Record &_record;
+    };
+}
+
 TEST(FTILoopTest, Constructor)
 {
     auto simConfigFile = std::fstream(TEST_SIM_CONFIG_FILE, std::ios::in);
@@ -101,6 +165,130 @@ TEST(FTILoopTest, RunLoop)
     ASSERT_EQ(simLoop.getSimTime(), timestep+timestep);
 }
 
+TEST(FTILoopTest, RunLoopCompletionOrder)
+{
+    using namespace std::chrono_literals;
+
+    auto simConfigFile = std::fstream(TEST_SIM_CONFIG_FILE, std::ios::in);
+    jsonSharedPtr config(new nlohmann::json(nlohmann::json::parse(simConfigFile)));
+    (*config)["FTILoopSyncMode"] = "completion";
+    json_utils::validateJson(*config, "json://nrp-core/simulation.json#Simulation");
+
+    const char *procName = "test";
+    PythonInterpreterState pyState(1, const_cast<char**>(&procName));
+    SimulationDataManager simulationDataManager;
+
+    const SimulationTime timestep = std::chrono::duration_cast<SimulationTime>(std::chrono::milliseconds (500));
+
+    {
+        // Engines with different timesteps complete their steps at different times
+        nlohmann::json nestCfg(config->at("EngineConfigs").at(1));
+        nestCfg["NestInitFileName"] = TEST_NEST_SIM_FILE;
+        nestCfg["EngineTimestep"] = 0.02f;
+
+        nlohmann::json gazeboCfg(config->at("EngineConfigs").at(0));
+        gazeboCfg["GazeboWorldFile"] = TEST_GAZEBO_WORLD_FILE;
+        gazeboCfg["EngineTimestep"] = 0.01f;
+
+        config->at("EngineConfigs").at(1) = nestCfg;
+        config->at("EngineConfigs").at(0) = gazeboCfg;
+    }
+
+    EngineClientInterfaceSharedPtr brain(NestEngineJSONLauncher().launchEngine(config->at("EngineConfigs").at(1), ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic())));
+    EngineClientInterfaceSharedPtr physics(GazeboEngineGrpcLauncher().launchEngine(config->at("EngineConfigs").at(0), ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic())));
+
+    // TODO Without the sleeps between calls, gRPC seems to fail in weird ways...
+    std::this_thread::sleep_for(100ms);
+
+    FTILoop simLoop(config, {brain, physics}, &simulationDataManager);
+
+    ASSERT_NO_THROW(simLoop.initLoop());
+
+    ASSERT_EQ(simLoop.getSimTime(), SimulationTime::zero());
+    ASSERT_NO_THROW(simLoop.runLoop(timestep));
+    ASSERT_EQ(simLoop.getSimTime(), timestep);
+    ASSERT_NO_THROW(simLoop.runLoop(timestep));
+    ASSERT_EQ(simLoop.getSimTime(), timestep+timestep);
+
+    ASSERT_NO_THROW(simLoop.waitForEngines());
+
+    // Engines synchronized in the same step are processed in the order in which they complete it, regardless of
+    // their order in the simulation
+
+    DelayedTestEngine::Record record;
+    nlohmann::json slowCfg({{"EngineName", "slow"}, {"EngineType", "delayed_test_engine"}});
+    nlohmann::json fastCfg({{"EngineName", "fast"}, {"EngineType", "delayed_test_engine"}});
+
+    EngineClientInterfaceSharedPtr slow(new DelayedTestEngine(slowCfg, 200ms, record));
+    EngineClientInterfaceSharedPtr fast(new DelayedTestEngine(fastCfg, 0ms, record));
+
+    FTILoop delayedLoop(config, {slow, fast}, &simulationDataManager);
+    ASSERT_NO_THROW(delayedLoop.initLoop());
+
+    // The first loop step processes the engines before they run any step, the second one after their first step
+    ASSERT_NO_THROW(delayedLoop.runLoop(slow->getEngineTimestep() + slow->getEngineTimestep()));
+    ASSERT_EQ(record.engineNames.size(), 4u);
+    ASSERT_EQ(std::vector<std::string>(record.engineNames.begin() + 2, record.engineNames.end()),
+              std::vector<std::string>({"fast", "slow"}));
+
+    ASSERT_NO_THROW(delayedLoop.waitForEngines());
+}
+
+TEST(FTILoopTest, RunLoopRunAhead)
+{
+    using namespace std::chrono_literals;
+
+    auto simConfigFile = std::fstream(TEST_SIM_CONFIG_FILE, std::ios::in);
+    jsonSharedPtr config(new nlohmann::json(nlohmann::json::parse(simConfigFile)));
+    (*config)["FTILoopRunAhead"] = true;
+    json_utils::validateJson(*config, "json://nrp-core/simulation.json#Simulation");
+
+    const char *procName = "test";
+    PythonInterpreterState pyState(1, const_cast<char**>(&procName));
+    SimulationDataManager simulationDataManager;
+
+    const SimulationTime timestep = std::chrono::duration_cast<SimulationTime>(std::chrono::milliseconds (500));
+
+    {
+        nlohmann::json nestCfg(config->at("EngineConfigs").at(1));
+        nestCfg["NestInitFileName"] = TEST_NEST_SIM_FILE;
+        nestCfg["EngineTimestep"] = 0.02f;
+        // Without functions no datapacks are exchanged with the engines, only engines marked as decoupled run ahead
+        nestCfg["EngineDecoupled"] = true;
+
+        nlohmann::json gazeboCfg(config->at("EngineConfigs").at(0));
+        gazeboCfg["GazeboWorldFile"] = TEST_GAZEBO_WORLD_FILE;
+        gazeboCfg["EngineTimestep"] = 0.01f;
+
+        config->at("EngineConfigs").at(1) = nestCfg;
+        config->at("EngineConfigs").at(0) = gazeboCfg;
+    }
+
+    EngineClientInterfaceSharedPtr brain(NestEngineJSONLauncher().launchEngine(config->at("EngineConfigs").at(1), ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic())));
+    EngineClientInterfaceSharedPtr physics(GazeboEngineGrpcLauncher().launchEngine(config->at("EngineConfigs").at(0), ProcessLauncherInterface::unique_ptr(new ProcessLauncherBasic())));
+
+    // TODO Without the sleeps between calls, gRPC seems to fail in weird ways...
+    std::this_thread::sleep_for(100ms);
+
+    FTILoop simLoop(config, {brain, physics}, &simulationDataManager);
+
+    ASSERT_NO_THROW(simLoop.initLoop());
+
+    ASSERT_EQ(simLoop.getSimTime(), SimulationTime::zero());
+    ASSERT_NO_THROW(simLoop.runLoop(timestep));
+    ASSERT_EQ(simLoop.getSimTime(), timestep);
+    ASSERT_NO_THROW(simLoop.runLoop(timestep));
+    ASSERT_EQ(simLoop.getSimTime(), timestep+timestep);
+
+    // Engines are synchronized again at their first step completing after the end of the loop
+    ASSERT_NO_THROW(simLoop.waitForEngines());
+    for(const auto &engine : {brain, physics})
+    {
+        ASSERT_GE(engine->getEngineTime(), timestep+timestep);
+        ASSERT_LT(engine->getEngineTime(), timestep+timestep+engine->getEngineTimestep());
+    }
+}
+
 TEST(FTILoopTest, TimeNodes)
 {
     auto simConfigFile = std::fstream(TEST_SIM_CONFIG_FILE, std::ios::in);
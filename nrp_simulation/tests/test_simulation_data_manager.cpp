@@ -211,6 +211,76 @@ TEST(SimulationDataManager, GetStatusDataPacks)
 }
 
 
+TEST(SimulationDataManager, GetDataPacksViews)
+{
+    SimulationDataManager dataManager;
+    populateDataManager(dataManager);
+
+    // Views contain the same DataPacks as the corresponding sets
+
+    const auto statusView = dataManager.getStatusDataPacksView();
+    const auto statusDataPacks = dataManager.getStatusDataPacks();
+    for(const auto &dataPack : statusDataPacks)
+    {
+        ASSERT_NE(statusView.find(dataPack->id()), nullptr);
+        ASSERT_EQ(*statusView.find(dataPack->id()), dataPack);
+    }
+    ASSERT_EQ(statusView.toSet().size(), statusDataPacks.size());
+
+    const auto transceiverView = dataManager.getTransceiverDataPacksView();
+    ASSERT_NE(transceiverView.find(DataPackIdentifier("pf_datapack1", "engine_name1", "")), nullptr);
+    ASSERT_EQ(transceiverView.find(DataPackIdentifier("tf_datapack1", "engine_name1", "")), nullptr);
+
+    const auto preprocessingView = dataManager.getPreprocessingDataPacksView();
+    ASSERT_NE(preprocessingView.find(DataPackIdentifier("engine_datapack2", "engine_name2", "")), nullptr);
+    ASSERT_EQ(preprocessingView.find(DataPackIdentifier("pf_datapack2", "engine_name2", "")), nullptr);
+
+    // DataPacks from the Engine pool take precedence over DataPacks with the same ID from other pools
+
+    dataManager.updatePreprocessingPool({generateDataPack("engine_datapack1", "engine_name1")});
+    const auto engineDataPack = *dataManager.getPreprocessingDataPacks().find(DataPackIdentifier("engine_datapack1", "engine_name1", ""));
+    ASSERT_EQ(*dataManager.getStatusDataPacksView().find(engineDataPack->id()), engineDataPack);
+}
+
+
+TEST(SimulationDataManager, GetUpdatedEngineDataPacks)
+{
+    SimulationDataManager dataManager;
+    populateDataManager(dataManager);
+
+    // The first call returns all DataPacks of the Engine
+
+    auto dataPacks = dataManager.getUpdatedEngineDataPacks("engine_name1");
+    ASSERT_EQ(dataPacks.size(), 2);
+    ASSERT_EQ(dataPacks.count(DataPackIdentifier("tf_datapack1",  "engine_name1", "")), 1);
+    ASSERT_EQ(dataPacks.count(DataPackIdentifier("ext_datapack1", "engine_name1", "")), 1);
+
+    // Nothing has been updated since
+
+    dataManager.startNewIteration();
+    ASSERT_TRUE(dataManager.getUpdatedEngineDataPacks("engine_name1").empty());
+
+    // Updates are tracked per Engine, even if the same DataPack object is inserted again
+
+    const auto tfDataPack = *dataManager.getEngineDataPacks("engine_name1").find(DataPackIdentifier("tf_datapack1", "engine_name1", ""));
+    dataManager.updateTransceiverPool({tfDataPack});
+
+    dataPacks = dataManager.getUpdatedEngineDataPacks("engine_name1");
+    ASSERT_EQ(dataPacks.size(), 1);
+    ASSERT_EQ(*dataPacks.begin(), tfDataPack);
+    ASSERT_TRUE(dataManager.getUpdatedEngineDataPacks("engine_name1").empty());
+
+    ASSERT_EQ(dataManager.getUpdatedEngineDataPacks("engine_name2").size(), 2);
+
+    // DataPacks from the Transceiver pool take precedence over DataPacks from the External pool
+
+    dataManager.updateExternalPool({generateDataPack("tf_datapack1", "engine_name1")});
+    dataPacks = dataManager.getUpdatedEngineDataPacks("engine_name1");
+    ASSERT_EQ(dataPacks.size(), 1);
+    ASSERT_EQ(*dataPacks.begin(), tfDataPack);
+}
+
+
 static void checkIsUpdatedFlags(const datapacks_set_t dataPacks, bool flagValue)
 {
     for(auto & dataPack: dataPacks)
@@ -244,4 +314,108 @@ TEST(SimulationDataManager, NewIteration)
     checkIsUpdatedFlags(dataManager.getStatusDataPacks(),        false);
 }
 
+
+TEST(SimulationDataManager, TrajectorySpilling)
+{
+    SimulationDataManager dataManager;
+    auto & trajectory = dataManager.getTrajectory();
+
+    // The DataPack name is used as its serialized form. DataPacks of engine "skip" can't be serialized
+
+    trajectory.setMemoryBudget(4);
+    trajectory.setSerializer([] (const DataPackInterface & dataPack) {
+        return dataPack.engineName() == "skip" ? std::string() : dataPack.name();
+    });
+
+    for(int i = 0; i < 10; ++i)
+        dataManager.pushToTrajectory({ generateDataPack(std::to_string(i), i == 1 ? "skip" : "engine") });
+
+    // Spilling keeps half of the budget in memory, the DataPack which can't be serialized is dropped
+
+    ASSERT_LE(trajectory.inMemory().size(), 4);
+    ASSERT_EQ(trajectory.size(), 9);
+    ASSERT_EQ(trajectory.spilledSize(), 9 - trajectory.inMemory().size());
+
+    // The order of the DataPacks is preserved
+
+    std::vector<std::string> names;
+    trajectory.forEach([&] (std::string_view serialized) { names.emplace_back(serialized); },
+                       [&] (const DataPackInterfaceConstSharedPtr & dataPack) { names.push_back(dataPack->name()); });
+
+    ASSERT_EQ(names, std::vector<std::string>({"0", "2", "3", "4", "5", "6", "7", "8", "9"}));
+
+    // Clearing the trajectory removes the spilled DataPacks too
+
+    dataManager.clearTrajectory();
+    ASSERT_EQ(trajectory.size(), 0);
+
+    dataManager.pushToTrajectory({ generateDataPack("10", "engine") });
+    names.clear();
+    trajectory.forEach([&] (std::string_view serialized) { names.emplace_back(serialized); },
+                       [&] (const DataPackInterfaceConstSharedPtr & dataPack) { names.push_back(dataPack->name()); });
+
+    ASSERT_EQ(names, std::vector<std::string>({"10"}));
+}
+
+
+TEST(SimulationDataManager, TrajectoryMoveTo)
+{
+    SimulationDataManager dataManager;
+    auto & trajectory = dataManager.getTrajectory();
+
+    trajectory.setMemoryBudget(4);
+    trajectory.setSerializer([] (const DataPackInterface & dataPack) { return dataPack.name(); });
+
+    for(int i = 0; i < 10; ++i)
+        dataManager.pushToTrajectory({ generateDataPack(std::to_string(i), "engine") });
+
+    ASSERT_GT(trajectory.spilledSize(), 0);
+
+    // Moving the trajectory leaves it empty, spilled DataPacks included
+
+    TrajectoryStore finished;
+    finished.setSerializer([] (const DataPackInterface & dataPack) { return dataPack.name(); });
+    dataManager.pushToTrajectory({ generateDataPack("old", "engine") });
+    finished.push({ generateDataPack("dropped", "engine") });
+
+    trajectory.moveTo(finished);
+    ASSERT_EQ(trajectory.size(), 0);
+    ASSERT_EQ(trajectory.spilledSize(), 0);
+    ASSERT_EQ(finished.size(), 11);
+
+    std::vector<std::string> names;
+    finished.forEach([&] (std::string_view serialized) { names.emplace_back(serialized); },
+                     [&] (const DataPackInterfaceConstSharedPtr & dataPack) { names.push_back(dataPack->name()); });
+
+    ASSERT_EQ(names, std::vector<std::string>({"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "old"}));
+
+    // The moved trajectory keeps its memory budget and spills to a new file
+
+    for(int i = 0; i < 10; ++i)
+        dataManager.pushToTrajectory({ generateDataPack(std::to_string(i), "engine") });
+
+    ASSERT_EQ(trajectory.size(), 10);
+    ASSERT_GT(trajectory.spilledSize(), 0);
+    ASSERT_EQ(finished.size(), 11);
+
+    finished.clear();
+    ASSERT_EQ(finished.size(), 0);
+}
+
+
+TEST(SimulationDataManager, TrajectoryUnlimited)
+{
+    SimulationDataManager dataManager;
+
+    // Without memory budget, no DataPack is spilled even if a serializer is set
+
+    dataManager.getTrajectory().setSerializer([] (const DataPackInterface & dataPack) { return dataPack.name(); });
+
+    for(int i = 0; i < 10; ++i)
+        dataManager.pushToTrajectory({ generateDataPack(std::to_string(i), "engine") });
+
+    ASSERT_EQ(dataManager.getTrajectory().spilledSize(), 0);
+    ASSERT_EQ(dataManager.getTrajectory().inMemory().size(), 10);
+}
+
 // EOF